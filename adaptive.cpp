@@ -0,0 +1,217 @@
+#include <stdio.h>
+#include <float.h>
+#include <math.h>
+#include <immintrin.h>
+
+#include "common.h"
+#include "core.h"
+#include "adaptive.h"
+
+namespace quadratic {
+    /// Number of equations which are converted to double columns at once.
+    static const size_t ADAPTIVE_BLOCK = 64;
+
+    /// num_roots written by kernels for equations which must be solved in long double.
+    static const int ADAPTIVE_ESCALATE = -2;
+
+    /// Bound of rounding error of discriminant relative to b ^ 2 + |4 * a * c|: rounding of coefficients to double, of products, of difference.
+    static const double ERROR_BOUND = 4 * DBL_EPSILON;
+
+    /// Coefficients closer to EPS than this may be on the other side of EPS in long double.
+    static const double EPS_BAND = EPS * 4 * DBL_EPSILON;
+
+    /**
+     * @brief Checks that a coefficient can be solved in double: it is finite, not too large or too small and not near EPS.
+     */
+    static int is_safe(double abs);
+
+    /**
+     * @brief Solves one equation in double.
+     * @return number of roots (look ROOT_NUMBER) or ADAPTIVE_ESCALATE
+     */
+    static int adaptive_scalar(double a, double b, double c, double *x1, double *x2);
+
+    /**
+     * @brief Makes roots found in double as accurate as long double ones for the original coefficients of equation.
+     * @details One root is computed again by the formula of solve_core (a single division), each of two roots is refined by one
+     * Newton step x - f(x) / f'(x) in long double: the double root is within ADAPTIVE_TOLERANCE, so the step leaves only the rounding
+     * error of f(x) in long double.
+     * @return roots in long double
+     */
+    static CoreRoots<long double> refine_roots(const Equation *equation, int num_roots, double x1, double x2);
+
+    static void adaptive_scalar_columns(const double *a, const double *b, const double *c, double *x1, double *x2, int *num_roots, size_t n);
+    static void adaptive_avx2_columns  (const double *a, const double *b, const double *c, double *x1, double *x2, int *num_roots, size_t n);
+
+    static int is_safe(double abs) {
+        return abs <= ADAPTIVE_MAX && (abs >= ADAPTIVE_MIN || !(abs > 0)) && fabs(abs - EPS) > EPS_BAND;
+    }
+
+    static int adaptive_scalar(double a, double b, double c, double *x1, double *x2) {
+        *x1 = *x2 = 0;
+        if (!is_safe(fabs(a)) || !is_safe(fabs(b)) || !is_safe(fabs(c)))
+            return ADAPTIVE_ESCALATE;
+
+        if (fabs(a) < EPS) {
+            if (fabs(b) < EPS) {
+                return (fabs(c) < EPS) ? RN_INF : RN_ZERO;
+            }
+            *x1 = -c / b;
+            return RN_ONE;
+        }
+
+        double discriminant = b * b - 4 * a * c, error = ERROR_BOUND * (b * b + fabs(4 * a * c));
+        if (fabs(discriminant) <= error || fabs(discriminant - EPS) <= error)
+            return ADAPTIVE_ESCALATE;
+
+        if (discriminant < 0)
+            return RN_ZERO;
+
+        if (discriminant < EPS) {
+            *x1 = -b / (2 * a);
+            return RN_ONE;
+        }
+
+        if (error > discriminant * ADAPTIVE_TOLERANCE)
+            return ADAPTIVE_ESCALATE;
+
+        // q and -b - sign(b) sqrt(D) don't cancel; + 0.0 makes the root of c = 0 +0 like (-b + sqrt(D)) / (2 * a).
+        double q = -0.5 * (b + copysign(sqrt(discriminant), b));
+        double big = q / a, small = c / q + 0.0;
+        *x1 = signbit(b) ? big : small;
+        *x2 = signbit(b) ? small : big;
+        return RN_TWO;
+    }
+
+    static CoreRoots<long double> refine_roots(const Equation *equation, int num_roots, double x1, double x2) {
+        const long double a = equation->a, b = equation->b, c = equation->c;
+        switch (num_roots) {
+        case RN_ONE:
+            return {RN_ONE, core_is_zero(a) ? -c / b : -b / (2 * a), 0};
+        case RN_TWO: {
+            long double roots[2] = {x1, x2};
+            for (int i = 0; i < 2; ++i) {
+                long double x = roots[i], slope = 2 * a * x + b;
+                // The root of c = 0 stays +0 like in solve_core.
+                roots[i] = (slope < 0 || slope > 0) ? x - ((a * x + b) * x + c) / slope + 0.0L : x;
+            }
+            return {RN_TWO, roots[0], roots[1]};
+        }
+        default:
+            return {num_roots, 0, 0};
+        }
+    }
+
+    static void adaptive_scalar_columns(const double *a, const double *b, const double *c, double *x1, double *x2, int *num_roots, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            num_roots[i] = adaptive_scalar(a[i], b[i], c[i], &x1[i], &x2[i]);
+        }
+    }
+
+    // Same as solve_avx2_columns of batch.cpp: every branch is evaluated for all lanes and blended by masks.
+
+    __attribute__((target("avx2")))
+    static void adaptive_avx2_columns(const double *a, const double *b, const double *c, double *x1, double *x2, int *num_roots, size_t n) {
+        const __m256d sign = _mm256_set1_pd(-0.0), zero = _mm256_setzero_pd(), all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+        const __m256d eps = _mm256_set1_pd(EPS), band = _mm256_set1_pd(EPS_BAND), min = _mm256_set1_pd(ADAPTIVE_MIN), max = _mm256_set1_pd(ADAPTIVE_MAX);
+        const __m256d half = _mm256_set1_pd(-0.5), two = _mm256_set1_pd(2), four = _mm256_set1_pd(4);
+        const __m256d bound = _mm256_set1_pd(ERROR_BOUND), tolerance = _mm256_set1_pd(ADAPTIVE_TOLERANCE);
+        const __m256d rn_zero = _mm256_set1_pd(RN_ZERO), rn_one = _mm256_set1_pd(RN_ONE), rn_two = _mm256_set1_pd(RN_TWO);
+        const __m256d rn_inf  = _mm256_set1_pd(RN_INF),  escalate_count = _mm256_set1_pd(ADAPTIVE_ESCALATE);
+
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m256d va = _mm256_loadu_pd(a + i), vb = _mm256_loadu_pd(b + i), vc = _mm256_loadu_pd(c + i);
+            __m256d abs[3] = {_mm256_andnot_pd(sign, va), _mm256_andnot_pd(sign, vb), _mm256_andnot_pd(sign, vc)};
+
+            __m256d safe = all;
+            for (int k = 0; k < 3; ++k) {
+                __m256d in_range = _mm256_and_pd(_mm256_cmp_pd(abs[k], max, _CMP_LE_OQ),
+                                                 _mm256_or_pd(_mm256_cmp_pd(abs[k], min, _CMP_GE_OQ), _mm256_cmp_pd(abs[k], zero, _CMP_EQ_OQ)));
+                __m256d far = _mm256_cmp_pd(_mm256_andnot_pd(sign, _mm256_sub_pd(abs[k], eps)), band, _CMP_GT_OQ);
+                safe = _mm256_and_pd(safe, _mm256_and_pd(in_range, far));
+            }
+            __m256d zero_a = _mm256_cmp_pd(abs[0], eps, _CMP_LT_OQ);
+            __m256d zero_b = _mm256_cmp_pd(abs[1], eps, _CMP_LT_OQ);
+            __m256d zero_c = _mm256_cmp_pd(abs[2], eps, _CMP_LT_OQ);
+
+            __m256d square = _mm256_mul_pd(vb, vb), product = _mm256_mul_pd(_mm256_mul_pd(four, va), vc);
+            __m256d discriminant = _mm256_sub_pd(square, product);
+            __m256d error = _mm256_mul_pd(bound, _mm256_add_pd(square, _mm256_andnot_pd(sign, product)));
+            __m256d negative_d = _mm256_cmp_pd(discriminant, zero, _CMP_LT_OQ);
+            __m256d zero_d = _mm256_cmp_pd(discriminant, eps, _CMP_LT_OQ);
+
+            __m256d unsure = _mm256_or_pd(_mm256_cmp_pd(_mm256_andnot_pd(sign, discriminant), error, _CMP_LE_OQ),
+                                          _mm256_cmp_pd(_mm256_andnot_pd(sign, _mm256_sub_pd(discriminant, eps)), error, _CMP_LE_OQ));
+            unsure = _mm256_or_pd(unsure, _mm256_andnot_pd(zero_d, _mm256_cmp_pd(error, _mm256_mul_pd(discriminant, tolerance), _CMP_GT_OQ)));
+
+            __m256d neg_b = _mm256_xor_pd(vb, sign), two_a = _mm256_mul_pd(two, va);
+            __m256d root  = _mm256_sqrt_pd(_mm256_max_pd(discriminant, zero));
+            __m256d q     = _mm256_mul_pd(half, _mm256_add_pd(vb, _mm256_or_pd(root, _mm256_and_pd(vb, sign))));
+            __m256d big   = _mm256_div_pd(q, va), small = _mm256_add_pd(_mm256_div_pd(vc, q), zero);
+            __m256d plus  = _mm256_blendv_pd(small, big, vb);
+            __m256d minus = _mm256_blendv_pd(big, small, vb);
+            __m256d one   = _mm256_div_pd(neg_b, two_a);
+            __m256d line  = _mm256_div_pd(_mm256_xor_pd(vc, sign), vb);
+
+            __m256d count = _mm256_blendv_pd(_mm256_blendv_pd(rn_two, rn_one, zero_d), rn_zero, negative_d);
+            __m256d r1 = _mm256_blendv_pd(_mm256_blendv_pd(plus, one, zero_d), zero, negative_d);
+            __m256d r2 = _mm256_blendv_pd(_mm256_blendv_pd(minus, zero, zero_d), zero, negative_d);
+
+            __m256d linear_count = _mm256_blendv_pd(rn_one, _mm256_blendv_pd(rn_zero, rn_inf, zero_c), zero_b);
+            count = _mm256_blendv_pd(count, linear_count, zero_a);
+            r1 = _mm256_blendv_pd(r1, _mm256_blendv_pd(line, zero, zero_b), zero_a);
+            r2 = _mm256_blendv_pd(r2, zero, zero_a);
+
+            __m256d escalate = _mm256_or_pd(_mm256_xor_pd(safe, all), _mm256_andnot_pd(zero_a, unsure));
+            count = _mm256_blendv_pd(count, escalate_count, escalate);
+            _mm256_storeu_pd(x1 + i, _mm256_andnot_pd(escalate, r1));
+            _mm256_storeu_pd(x2 + i, _mm256_andnot_pd(escalate, r2));
+            _mm_storeu_si128((__m128i *)(num_roots + i), _mm256_cvtpd_epi32(count));
+        }
+
+        adaptive_scalar_columns(a + i, b + i, c + i, x1 + i, x2 + i, num_roots + i, n - i);
+    }
+
+    size_t solve_adaptive(Equation *equations, size_t size, size_t *escalated, BATCH_KERNEL kernel) {
+        ASSERTIF(equations != NULL || size == 0, "nullptr in equations", 0);
+
+        double a[ADAPTIVE_BLOCK] = {}, b[ADAPTIVE_BLOCK] = {}, c[ADAPTIVE_BLOCK] = {}, x1[ADAPTIVE_BLOCK] = {}, x2[ADAPTIVE_BLOCK] = {};
+        int num_roots[ADAPTIVE_BLOCK] = {};
+        if (kernel > batch_kernel())
+            kernel = batch_kernel();
+
+        size_t solved = 0, slow = 0;
+        for (size_t first = 0; first < size; first += ADAPTIVE_BLOCK) {
+            size_t n = (size - first < ADAPTIVE_BLOCK) ? size - first : ADAPTIVE_BLOCK;
+            Equation *block = equations + first;
+            for (size_t i = 0; i < n; ++i) {
+                a[i] = (double)block[i].a;
+                b[i] = (double)block[i].b;
+                c[i] = (double)block[i].c;
+            }
+
+            if (kernel == BK_SCALAR) {
+                adaptive_scalar_columns(a, b, c, x1, x2, num_roots, n);
+            } else {
+                adaptive_avx2_columns(a, b, c, x1, x2, num_roots, n);
+            }
+
+            for (size_t i = 0; i < n; ++i) {
+                Equation *equation = block + i;
+                if (num_roots[i] == ADAPTIVE_ESCALATE) {
+                    equation->num_roots = store_roots(equation, solve_core_checked(equation->a, equation->b, equation->c));
+                    slow++;
+                } else {
+                    equation->num_roots = store_roots(equation, refine_roots(equation, num_roots[i], x1[i], x2[i]));
+                }
+                solved += equation->num_roots != QE_QUAD_ERROR;
+            }
+        }
+
+        if (escalated != NULL) {
+            *escalated += slow;
+        }
+        return solved;
+    }
+}
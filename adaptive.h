@@ -0,0 +1,42 @@
+#ifndef ADAPTIVE_DEF
+#define ADAPTIVE_DEF
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "quadratic.h"
+#include "batch.h"
+
+/**
+ * @brief   Adaptive precision (--type adaptive): double first, long double only where double is not sure.
+ * @details Equations are solved in blocks by a vector kernel in double with the cancellation-free formula q = -(b + sign(b) sqrt(D)) / 2,
+ * x = q / a and x = c / q. The kernel bounds the rounding error of the discriminant, including rounding of long double coefficients
+ * to double. An equation is escalated, that is solved again by solve_core in long double like solve_equation, if its class is not
+ * sure (|a|, |b|, |c| or discriminant is within the error bound of EPS or of 0), if relative error bound of its roots exceeds
+ * ADAPTIVE_TOLERANCE (discriminant is small relative to b ^ 2), or if a coefficient is out of ADAPTIVE_MIN..ADAPTIVE_MAX where
+ * products could overflow or underflow in double. Roots of equations which are not escalated are refined in long double from the original
+ * coefficients: a single root is computed again like solve_core does and each of two roots takes a Newton step from its double value,
+ * which squares its relative error. So every class is the same as solve_equation gives and roots are as accurate as its roots.
+ */
+namespace quadratic {
+    /// Maximal relative error bound of roots which are not escalated.
+    const double ADAPTIVE_TOLERANCE = 1e-12;
+
+    /// Coefficients which are not zero must be in [ADAPTIVE_MIN, ADAPTIVE_MAX] by absolute value to be solved in double.
+    const double ADAPTIVE_MIN = 1e-140;
+    const double ADAPTIVE_MAX = 1e140;
+
+    /**
+     * @brief Solves equations by adaptive precision.
+     * @details Writes num_roots and roots like solve_range_as: roots which don't exist are not changed, QE_QUAD_ERROR for non-finite
+     * coefficients.
+     * @param [in, out] *equations - Array of equations
+     * @param [in]      size       - Number of equations
+     * @param [out]     *escalated - Number of equations solved in long double is added to it (may be NULL)
+     * @param [in]      kernel     - Kernel of the double pass (BK_AVX512 uses the AVX2 kernel)
+     * @return number of equations which were solved without QE_QUAD_ERROR
+     */
+    size_t solve_adaptive(Equation *equations, size_t size, size_t *escalated = NULL, BATCH_KERNEL kernel = batch_kernel());
+}
+
+#endif
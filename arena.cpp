@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "common.h"
+#include "arena.h"
+
+namespace quadratic {
+    /// Size of a transparent huge page on x86-64.
+    static const size_t HUGE_PAGE = 2 << 20;
+
+    /// Number of records reserved by make_arena by default.
+    static const size_t DEFAULT_CAPACITY = 1024;
+
+    /**
+     * @brief Maps or remaps records so that at least capacity records fit.
+     * @param [in, out] *arena   - Arena
+     * @param [in]      capacity - Required number of records
+     * @return 1 if succeeded and 0 otherwise
+     */
+    static int arena_reserve(EquationArena *arena, size_t capacity);
+
+    static int arena_reserve(EquationArena *arena, size_t capacity) {
+        size_t page  = (arena->flags & AF_HUGE_PAGES) ? HUGE_PAGE : (size_t)sysconf(_SC_PAGESIZE);
+        size_t bytes = (capacity * sizeof(Equation) + page - 1) / page * page;
+
+        void *records = (arena->records == NULL) ? mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)
+                                                 : mremap(arena->records, arena->bytes, bytes, MREMAP_MAYMOVE);
+        if (records == MAP_FAILED)
+            return 0;
+
+        if (arena->flags & AF_HUGE_PAGES) {
+            madvise(records, bytes, MADV_HUGEPAGE);
+        }
+
+        arena->records  = (Equation *)records;
+        arena->bytes    = bytes;
+        arena->capacity = bytes / sizeof(Equation);
+        return 1;
+    }
+
+    int make_arena(EquationArena *arena, size_t capacity, int flags) {
+        ASSERTIF(arena != NULL, "nullptr in arena", 0);
+
+        *arena = {};
+        arena->flags = flags;
+        return arena_reserve(arena, capacity == 0 ? DEFAULT_CAPACITY : capacity);
+    }
+
+    Equation *arena_push(EquationArena *arena, const Equation *equation) {
+        ASSERTIF(arena    != NULL, "nullptr in arena",    NULL);
+        ASSERTIF(equation != NULL, "nullptr in equation", NULL);
+
+        if (arena->size == arena->capacity && !arena_reserve(arena, (arena->capacity == 0) ? DEFAULT_CAPACITY : arena->capacity * 2))
+            return NULL;
+
+        Equation *record = arena->records + arena->size++;
+        *record = *equation;
+        return record;
+    }
+
+    int arena_append(EquationArena *arena, const EquationArena *other) {
+        ASSERTIF(arena != NULL, "nullptr in arena", 0);
+        ASSERTIF(other != NULL, "nullptr in other", 0);
+
+        size_t size = arena->size + other->size;
+        if (size > arena->capacity && !arena_reserve(arena, (size > arena->capacity * 2) ? size : arena->capacity * 2))
+            return 0;
+
+        if (other->size != 0) {
+            memcpy(arena->records + arena->size, other->records, other->size * sizeof(Equation));
+        }
+        arena->size = size;
+        return 1;
+    }
+
+    Equation **arena_view(EquationArena *arena) {
+        ASSERTIF(arena != NULL, "nullptr in arena", NULL);
+
+        Equation **view = (Equation **)realloc(arena->view, (arena->size + 1) * sizeof(Equation *));
+        ASSERTIF(view != NULL, "unable to alloc", NULL);
+
+        for (size_t i = 0; i < arena->size; ++i) {
+            view[i] = arena->records + i;
+        }
+        view[arena->size] = NULL;
+        return arena->view = view;
+    }
+
+    void free_arena(EquationArena *arena) {
+        if (arena == NULL)
+            return;
+
+        if (arena->records != NULL) {
+            munmap(arena->records, arena->bytes);
+        }
+        free(arena->view);
+        *arena = {};
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef ARENA_DEF
+#define ARENA_DEF
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "quadratic.h"
+
+namespace quadratic {
+    /// Flags of make_arena.
+    typedef enum {
+        AF_DEFAULT    = 0, ///< Regular pages
+        AF_HUGE_PAGES = 1  ///< Ask kernel to back records with transparent huge pages
+    } ARENA_FLAGS;
+
+    /**
+     * @brief   Contiguous storage of Equation records.
+     * @details Records live in one anonymous mapping which is page aligned (so cache-line aligned) and grows by mremap, so growing
+     * doesn't copy records and freeing is a single munmap. Pointers to records become invalid when arena grows.
+     * @param records  - Array of records
+     * @param view     - Array of pointers to records made by arena_view
+     * @param size     - Number of records
+     * @param capacity - Number of records which fit into mapping
+     * @param bytes    - Size of mapping in bytes
+     * @param flags    - ARENA_FLAGS given to make_arena
+     */
+    typedef struct EquationArena {
+        Equation *records;
+        Equation **view;
+        size_t size, capacity;
+        size_t bytes;
+        int flags;
+    } EquationArena;
+
+    /**
+     * @brief Makes an empty arena.
+     * @param [out] *arena   - Arena to initialize
+     * @param [in]  capacity - How much records to reserve at once (0 for default)
+     * @param [in]  flags    - ARENA_FLAGS
+     * @return 1 if memory was mapped and 0 otherwise
+     */
+    int make_arena(EquationArena *arena, size_t capacity = 0, int flags = AF_DEFAULT);
+
+    /**
+     * @brief Appends a copy of equation to the arena.
+     * @param [in, out] *arena    - Arena
+     * @param [in]      *equation - Equation to copy
+     * @return A pointer to new record or NULL if arena can't grow
+     */
+    Equation *arena_push(EquationArena *arena, const Equation *equation);
+
+    /**
+     * @brief Appends copies of all records of other arena to the arena.
+     * @param [in, out] *arena - Arena
+     * @param [in]      *other - Arena to copy records from
+     * @return 1 if records were copied and 0 if arena can't grow
+     */
+    int arena_append(EquationArena *arena, const EquationArena *other);
+
+    /**
+     * @brief Compatibility view of arena for functions which take Equation **.
+     * @details Builds an array of size + 1 pointers to records (last is NULL). Array is owned by arena and is valid until next call
+     * of arena_view, arena_push or free_arena. It must not be given to free_equations.
+     * @param [in] *arena - Arena
+     * @return An array of pointers to records or NULL
+     */
+    Equation **arena_view(EquationArena *arena);
+
+    /**
+     * @brief Frees all records of the arena at once.
+     * @param [in] *arena - Arena to free
+     * @return void
+     */
+    void free_arena(EquationArena *arena);
+}
+
+#endif
@@ -0,0 +1,358 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <float.h>
+#include <math.h>
+#include <immintrin.h>
+
+#include "common.h"
+#include "batch.h"
+#include "core.h"
+
+namespace quadratic {
+    /**
+     * @brief Allocates a column aligned to BATCH_ALIGN.
+     * @param [in] bytes - Size of column in bytes
+     * @return A pointer to column or NULL
+     */
+    static void *alloc_column(size_t bytes);
+
+    /**
+     * @brief Solves one equation in double with the same branches as solve_equation.
+     * @return number of roots (look ROOT_NUMBER) or QE_QUAD_ERROR
+     */
+    static int solve_scalar(double a, double b, double c, double *x1, double *x2);
+
+    /**
+     * @brief Checks if discriminant in double may be on the other side of 0 or EPS than discriminant of solve_equation.
+     * @details Rounding errors of b * b - 4 * a * c in double are below 2 ^ -51 * (b * b + |4 * a * c|), in long double they are 2048
+     * times smaller, so only discriminants closer than this to 0 or EPS can be classified in another way. An overflowed discriminant
+     * makes margin infinite, so it is near too.
+     * @return 1 if equation must be solved by solve_near and 0 otherwise
+     */
+    static int is_near(double a, double b, double c, double discriminant);
+
+    /**
+     * @brief Solves one equation by solve_core in long double, like solve_equation does, and rounds roots to double.
+     * @return number of roots (look ROOT_NUMBER)
+     */
+    static int solve_near(double a, double b, double c, double *x1, double *x2);
+
+    /**
+     * @brief Solves equations first + k by solve_near for every bit k of lanes.
+     * @return void
+     */
+    static void solve_near_lanes(const double *a, const double *b, const double *c, double *x1, double *x2, int *num_roots, size_t first,
+                                 unsigned lanes);
+
+    /**
+     * @brief Vector forms of is_near: square is b * b, product is 4 * a * c and discriminant is their difference.
+     * @return Mask of lanes which are near
+     */
+    static unsigned near_avx2  (__m256d square, __m256d product, __m256d discriminant);
+    static unsigned near_avx512(__m512d square, __m512d product, __m512d discriminant);
+
+    static void solve_scalar_columns(const double *a, const double *b, const double *c, double *x1, double *x2, int *num_roots, size_t n);
+    static void solve_avx2_columns  (const double *a, const double *b, const double *c, double *x1, double *x2, int *num_roots, size_t n);
+    static void solve_avx512_columns(const double *a, const double *b, const double *c, double *x1, double *x2, int *num_roots, size_t n);
+
+    static void *alloc_column(size_t bytes) {
+        bytes = (bytes + BATCH_ALIGN - 1) / BATCH_ALIGN * BATCH_ALIGN;
+        return aligned_alloc(BATCH_ALIGN, bytes == 0 ? BATCH_ALIGN : bytes);
+    }
+
+    int make_batch(EquationBatch *batch, size_t capacity) {
+        ASSERTIF(batch != NULL, "nullptr in batch", 0);
+
+        batch->a         = (double *)alloc_column(capacity * sizeof(double));
+        batch->b         = (double *)alloc_column(capacity * sizeof(double));
+        batch->c         = (double *)alloc_column(capacity * sizeof(double));
+        batch->x1        = (double *)alloc_column(capacity * sizeof(double));
+        batch->x2        = (double *)alloc_column(capacity * sizeof(double));
+        batch->num_roots = (int *)   alloc_column(capacity * sizeof(int));
+        batch->size      = 0;
+        batch->capacity  = capacity;
+
+        if (batch->a == NULL || batch->b == NULL || batch->c == NULL || batch->x1 == NULL || batch->x2 == NULL || batch->num_roots == NULL) {
+            free_batch(batch);
+            return 0;
+        }
+        return 1;
+    }
+
+    void free_batch(EquationBatch *batch) {
+        if (batch == NULL)
+            return;
+
+        free(batch->a);
+        free(batch->b);
+        free(batch->c);
+        free(batch->x1);
+        free(batch->x2);
+        free(batch->num_roots);
+        *batch = {};
+    }
+
+    int batch_push(EquationBatch *batch, const Equation *equation) {
+        ASSERTIF(batch    != NULL, "nullptr in batch",    0);
+        ASSERTIF(equation != NULL, "nullptr in equation", 0);
+
+        if (batch->size == batch->capacity)
+            return 0;
+
+        batch->a[batch->size] = (double)equation->a;
+        batch->b[batch->size] = (double)equation->b;
+        batch->c[batch->size] = (double)equation->c;
+        batch->x1[batch->size] = batch->x2[batch->size] = 0;
+        batch->num_roots[batch->size] = RN_DEFAULT;
+        ++batch->size;
+        return 1;
+    }
+
+    BATCH_KERNEL batch_kernel() {
+        static int kernel = -1;
+        if (kernel == -1) {
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f"))
+                kernel = BK_AVX512;
+            else if (__builtin_cpu_supports("avx2"))
+                kernel = BK_AVX2;
+            else
+                kernel = BK_SCALAR;
+        }
+        return (BATCH_KERNEL)kernel;
+    }
+
+    const char *batch_kernel_name(BATCH_KERNEL kernel) {
+        switch (kernel) {
+        case BK_SCALAR:
+            return "scalar";
+        case BK_AVX2:
+            return "avx2";
+        case BK_AVX512:
+            return "avx512";
+        default:
+            return "unknown";
+        }
+    }
+
+    void solve_columns(const double *a, const double *b, const double *c, double *x1, double *x2, int *num_roots, size_t n, BATCH_KERNEL kernel) {
+        if (kernel > batch_kernel())
+            kernel = batch_kernel();
+
+        switch (kernel) {
+        case BK_AVX512:
+            solve_avx512_columns(a, b, c, x1, x2, num_roots, n);
+            break;
+        case BK_AVX2:
+            solve_avx2_columns(a, b, c, x1, x2, num_roots, n);
+            break;
+        case BK_SCALAR:
+            solve_scalar_columns(a, b, c, x1, x2, num_roots, n);
+            break;
+        default:
+            solve_scalar_columns(a, b, c, x1, x2, num_roots, n);
+            break;
+        }
+    }
+
+    size_t solve_batch(EquationBatch *batch, BATCH_KERNEL kernel) {
+        ASSERTIF(batch != NULL, "nullptr in batch", 0);
+
+        solve_columns(batch->a, batch->b, batch->c, batch->x1, batch->x2, batch->num_roots, batch->size, kernel);
+
+        size_t solved = 0;
+        for (size_t i = 0; i < batch->size; ++i) {
+            solved += batch->num_roots[i] != QE_QUAD_ERROR;
+        }
+        return solved;
+    }
+
+    static int solve_scalar(double a, double b, double c, double *x1, double *x2) {
+        *x1 = *x2 = 0;
+        if (!isfinite(a) || !isfinite(b) || !isfinite(c))
+            return QE_QUAD_ERROR;
+
+        if (fabs(a) < EPS) {
+            if (fabs(b) < EPS) {
+                return (fabs(c) < EPS) ? RN_INF : RN_ZERO;
+            }
+            *x1 = -c / b;
+            return RN_ONE;
+        }
+
+        double discriminant = b * b - 4 * a * c;
+        if (is_near(a, b, c, discriminant))
+            return solve_near(a, b, c, x1, x2);
+
+        if (discriminant < 0)
+            return RN_ZERO;
+
+        if (fabs(discriminant) < EPS) {
+            *x1 = -b / (2 * a);
+            return RN_ONE;
+        }
+
+        discriminant = sqrt(discriminant);
+        *x1 = (-b + discriminant) / (2 * a);
+        *x2 = (-b - discriminant) / (2 * a);
+        return RN_TWO;
+    }
+
+    static int is_near(double a, double b, double c, double discriminant) {
+        double margin = 4 * DBL_EPSILON * (b * b + fabs(4 * a * c));
+        return !(fabs(discriminant) > margin) || !(fabs(discriminant - EPS) > margin);
+    }
+
+    static int solve_near(double a, double b, double c, double *x1, double *x2) {
+        CoreRoots<long double> roots = solve_core<long double>(a, b, c);
+        *x1 = (double)roots.x1;
+        *x2 = (double)roots.x2;
+        return roots.num_roots;
+    }
+
+    static void solve_near_lanes(const double *a, const double *b, const double *c, double *x1, double *x2, int *num_roots, size_t first,
+                                 unsigned lanes) {
+        for (; lanes != 0; lanes &= lanes - 1) {
+            size_t i = first + (size_t)__builtin_ctz(lanes);
+            num_roots[i] = solve_near(a[i], b[i], c[i], x1 + i, x2 + i);
+        }
+    }
+
+    static void solve_scalar_columns(const double *a, const double *b, const double *c, double *x1, double *x2, int *num_roots, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            num_roots[i] = solve_scalar(a[i], b[i], c[i], &x1[i], &x2[i]);
+        }
+    }
+
+    // Vector kernels evaluate every branch of solve_scalar for all lanes and blend the results by masks of the branch conditions.
+    // Lanes of branches which are not taken may divide by zero, their values are thrown away. Lanes with a discriminant which is_near
+    // 0 or EPS are solved again by solve_near after the stores.
+
+    __attribute__((target("avx2")))
+    static unsigned near_avx2(__m256d square, __m256d product, __m256d discriminant) {
+        const __m256d sign = _mm256_set1_pd(-0.0), eps = _mm256_set1_pd(EPS), margin = _mm256_set1_pd(4 * DBL_EPSILON);
+
+        __m256d limit = _mm256_mul_pd(margin, _mm256_add_pd(square, _mm256_andnot_pd(sign, product)));
+        __m256d near  = _mm256_or_pd(_mm256_cmp_pd(_mm256_andnot_pd(sign, discriminant), limit, _CMP_NGT_UQ),
+                                     _mm256_cmp_pd(_mm256_andnot_pd(sign, _mm256_sub_pd(discriminant, eps)), limit, _CMP_NGT_UQ));
+        return (unsigned)_mm256_movemask_pd(near);
+    }
+
+    __attribute__((target("avx512f")))
+    static unsigned near_avx512(__m512d square, __m512d product, __m512d discriminant) {
+        const __m512d eps = _mm512_set1_pd(EPS), margin = _mm512_set1_pd(4 * DBL_EPSILON);
+
+        __m512d limit = _mm512_mul_pd(margin, _mm512_add_pd(square, _mm512_abs_pd(product)));
+        return _mm512_cmp_pd_mask(_mm512_abs_pd(discriminant), limit, _CMP_NGT_UQ) |
+               _mm512_cmp_pd_mask(_mm512_abs_pd(_mm512_sub_pd(discriminant, eps)), limit, _CMP_NGT_UQ);
+    }
+
+    __attribute__((target("avx2")))
+    static void solve_avx2_columns(const double *a, const double *b, const double *c, double *x1, double *x2, int *num_roots, size_t n) {
+        const __m256d sign = _mm256_set1_pd(-0.0), zero = _mm256_setzero_pd(), eps = _mm256_set1_pd(EPS), max = _mm256_set1_pd(DBL_MAX);
+        const __m256d two = _mm256_set1_pd(2), four = _mm256_set1_pd(4);
+        const __m256d rn_zero = _mm256_set1_pd(RN_ZERO), rn_one = _mm256_set1_pd(RN_ONE), rn_two = _mm256_set1_pd(RN_TWO);
+        const __m256d rn_inf  = _mm256_set1_pd(RN_INF),  error  = _mm256_set1_pd(QE_QUAD_ERROR);
+
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m256d va = _mm256_loadu_pd(a + i), vb = _mm256_loadu_pd(b + i), vc = _mm256_loadu_pd(c + i);
+            __m256d abs_a = _mm256_andnot_pd(sign, va), abs_b = _mm256_andnot_pd(sign, vb), abs_c = _mm256_andnot_pd(sign, vc);
+
+            __m256d finite = _mm256_and_pd(_mm256_and_pd(_mm256_cmp_pd(abs_a, max, _CMP_LE_OQ), _mm256_cmp_pd(abs_b, max, _CMP_LE_OQ)),
+                                           _mm256_cmp_pd(abs_c, max, _CMP_LE_OQ));
+            __m256d zero_a = _mm256_cmp_pd(abs_a, eps, _CMP_LT_OQ);
+            __m256d zero_b = _mm256_cmp_pd(abs_b, eps, _CMP_LT_OQ);
+            __m256d zero_c = _mm256_cmp_pd(abs_c, eps, _CMP_LT_OQ);
+
+            __m256d square = _mm256_mul_pd(vb, vb), product = _mm256_mul_pd(_mm256_mul_pd(four, va), vc);
+            __m256d discriminant = _mm256_sub_pd(square, product);
+            __m256d negative_d = _mm256_cmp_pd(discriminant, zero, _CMP_LT_OQ);
+            __m256d zero_d = _mm256_cmp_pd(_mm256_andnot_pd(sign, discriminant), eps, _CMP_LT_OQ);
+
+            __m256d neg_b = _mm256_xor_pd(vb, sign), two_a = _mm256_mul_pd(two, va);
+            __m256d root  = _mm256_sqrt_pd(discriminant);
+            __m256d plus  = _mm256_div_pd(_mm256_add_pd(neg_b, root), two_a);
+            __m256d minus = _mm256_div_pd(_mm256_sub_pd(neg_b, root), two_a);
+            __m256d one   = _mm256_div_pd(neg_b, two_a);
+            __m256d line  = _mm256_div_pd(_mm256_xor_pd(vc, sign), vb);
+
+            // Quadratic branch: RN_TWO, then RN_ONE if discriminant is zero, then RN_ZERO if it is negative.
+            __m256d count = _mm256_blendv_pd(_mm256_blendv_pd(rn_two, rn_one, zero_d), rn_zero, negative_d);
+            __m256d r1 = _mm256_blendv_pd(_mm256_blendv_pd(plus, one, zero_d), zero, negative_d);
+            __m256d r2 = _mm256_blendv_pd(_mm256_blendv_pd(minus, zero, zero_d), zero, negative_d);
+
+            // Linear branch.
+            __m256d linear_count = _mm256_blendv_pd(rn_one, _mm256_blendv_pd(rn_zero, rn_inf, zero_c), zero_b);
+            count = _mm256_blendv_pd(count, linear_count, zero_a);
+            r1 = _mm256_blendv_pd(r1, _mm256_blendv_pd(line, zero, zero_b), zero_a);
+            r2 = _mm256_blendv_pd(r2, zero, zero_a);
+
+            count = _mm256_blendv_pd(error, count, finite);
+            _mm256_storeu_pd(x1 + i, _mm256_and_pd(r1, finite));
+            _mm256_storeu_pd(x2 + i, _mm256_and_pd(r2, finite));
+            _mm_storeu_si128((__m128i *)(num_roots + i), _mm256_cvtpd_epi32(count));
+            unsigned quadratic = (unsigned)_mm256_movemask_pd(_mm256_andnot_pd(zero_a, finite));
+            solve_near_lanes(a, b, c, x1, x2, num_roots, i, near_avx2(square, product, discriminant) & quadratic);
+        }
+
+        solve_scalar_columns(a + i, b + i, c + i, x1 + i, x2 + i, num_roots + i, n - i);
+    }
+
+    // _mm512_sqrt_pd and _mm512_extractf64x4_pd pass _mm512_undefined_* as the merge operand, which GCC reports as uninitialized with -O2.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+    __attribute__((target("avx512f")))
+    static void solve_avx512_columns(const double *a, const double *b, const double *c, double *x1, double *x2, int *num_roots, size_t n) {
+        const __m512d zero = _mm512_setzero_pd(), eps = _mm512_set1_pd(EPS), max = _mm512_set1_pd(DBL_MAX);
+        const __m512d two = _mm512_set1_pd(2), four = _mm512_set1_pd(4);
+        const __m512i sign = _mm512_set1_epi64((long long)0x8000000000000000ULL);
+        const __m512i rn_zero = _mm512_set1_epi32(RN_ZERO), rn_one = _mm512_set1_epi32(RN_ONE), rn_two = _mm512_set1_epi32(RN_TWO);
+        const __m512i rn_inf  = _mm512_set1_epi32(RN_INF),  error  = _mm512_set1_epi32(QE_QUAD_ERROR);
+
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m512d va = _mm512_loadu_pd(a + i), vb = _mm512_loadu_pd(b + i), vc = _mm512_loadu_pd(c + i);
+            __m512d abs_a = _mm512_abs_pd(va), abs_b = _mm512_abs_pd(vb), abs_c = _mm512_abs_pd(vc);
+
+            __mmask8 finite = _mm512_cmp_pd_mask(abs_a, max, _CMP_LE_OQ) & _mm512_cmp_pd_mask(abs_b, max, _CMP_LE_OQ) &
+                              _mm512_cmp_pd_mask(abs_c, max, _CMP_LE_OQ);
+            __mmask8 zero_a = _mm512_cmp_pd_mask(abs_a, eps, _CMP_LT_OQ);
+            __mmask8 zero_b = _mm512_cmp_pd_mask(abs_b, eps, _CMP_LT_OQ);
+            __mmask8 zero_c = _mm512_cmp_pd_mask(abs_c, eps, _CMP_LT_OQ);
+
+            __m512d square = _mm512_mul_pd(vb, vb), product = _mm512_mul_pd(_mm512_mul_pd(four, va), vc);
+            __m512d discriminant = _mm512_sub_pd(square, product);
+            __mmask8 negative_d = _mm512_cmp_pd_mask(discriminant, zero, _CMP_LT_OQ);
+            __mmask8 zero_d = _mm512_cmp_pd_mask(_mm512_abs_pd(discriminant), eps, _CMP_LT_OQ);
+
+            __m512d neg_b = _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(vb), sign)), two_a = _mm512_mul_pd(two, va);
+            __m512d neg_c = _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(vc), sign));
+            __m512d root  = _mm512_sqrt_pd(discriminant);
+            __m512d plus  = _mm512_div_pd(_mm512_add_pd(neg_b, root), two_a);
+            __m512d minus = _mm512_div_pd(_mm512_sub_pd(neg_b, root), two_a);
+            __m512d one   = _mm512_div_pd(neg_b, two_a);
+            __m512d line  = _mm512_div_pd(neg_c, vb);
+
+            // Quadratic branch: RN_TWO, then RN_ONE if discriminant is zero, then RN_ZERO if it is negative. Counts use low 8 of 16 lanes.
+            __m512i count = _mm512_mask_blend_epi32(negative_d, _mm512_mask_blend_epi32(zero_d, rn_two, rn_one), rn_zero);
+            __m512d r1 = _mm512_mask_blend_pd(negative_d, _mm512_mask_blend_pd(zero_d, plus, one), zero);
+            __m512d r2 = _mm512_mask_blend_pd((__mmask8)(negative_d | zero_d), minus, zero);
+
+            // Linear branch.
+            __m512i linear_count = _mm512_mask_blend_epi32(zero_b, rn_one, _mm512_mask_blend_epi32(zero_c, rn_zero, rn_inf));
+            count = _mm512_mask_blend_epi32(zero_a, count, linear_count);
+            r1 = _mm512_mask_blend_pd(zero_a, r1, _mm512_mask_blend_pd(zero_b, line, zero));
+            r2 = _mm512_mask_blend_pd(zero_a, r2, zero);
+
+            count = _mm512_mask_blend_epi32(finite, error, count);
+            _mm512_storeu_pd(x1 + i, _mm512_maskz_mov_pd(finite, r1));
+            _mm512_storeu_pd(x2 + i, _mm512_maskz_mov_pd(finite, r2));
+            _mm256_storeu_si256((__m256i *)(num_roots + i), _mm512_castsi512_si256(count));
+            solve_near_lanes(a, b, c, x1, x2, num_roots, i, near_avx512(square, product, discriminant) & finite & (unsigned)~zero_a);
+        }
+
+        solve_scalar_columns(a + i, b + i, c + i, x1 + i, x2 + i, num_roots + i, n - i);
+    }
+#pragma GCC diagnostic pop
+}
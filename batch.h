@@ -0,0 +1,105 @@
+#ifndef BATCH_DEF
+#define BATCH_DEF
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "quadratic.h"
+
+namespace quadratic {
+    /// Alignment of every EquationBatch column in bytes (one AVX-512 register and one cache line).
+    const size_t BATCH_ALIGN = 64;
+
+    /**
+     * @brief   A structure-of-arrays batch of quadratic equations.
+     * @details Each field is a separate contiguous column aligned to BATCH_ALIGN, so solve_batch can load several equations into one
+     * vector register. Coefficients and roots are stored in double. Roots which don't exist are written as 0, like in make_equation.
+     * @param a         - Column of coefficients of x ^ 2
+     * @param b         - Column of coefficients of x
+     * @param c         - Column of free coefficients
+     * @param x1        - Column of first roots
+     * @param x2        - Column of second roots
+     * @param num_roots - Column of numbers of roots (look ROOT_NUMBER) or QE_QUAD_ERROR
+     * @param size      - Number of equations in the batch
+     * @param capacity  - Number of elements allocated in each column
+     */
+    typedef struct {
+        double *a, *b, *c;
+        double *x1, *x2;
+        int *num_roots;
+        size_t size, capacity;
+    } EquationBatch;
+
+    /// Enumerated type of data with kernels of solve_batch.
+    typedef enum {
+        BK_SCALAR, ///< One equation per iteration, any CPU
+        BK_AVX2,   ///< 4 equations per instruction
+        BK_AVX512  ///< 8 equations per instruction
+    } BATCH_KERNEL;
+
+    /**
+     * @brief Allocates columns of an empty batch.
+     * @param [out] *batch   - Batch to initialize
+     * @param [in]  capacity - How much equations the batch can hold
+     * @return 1 if memory was allocated and 0 otherwise
+     */
+    int make_batch(EquationBatch *batch, size_t capacity);
+
+    /**
+     * @brief Frees columns of the batch and makes it empty.
+     * @param [in] *batch - Batch to free
+     * @return void
+     */
+    void free_batch(EquationBatch *batch);
+
+    /**
+     * @brief Appends coefficients of an Equation to the batch.
+     * @param [out] *batch    - Batch with free space
+     * @param [in]  *equation - Equation to append
+     * @return 1 if equation was appended and 0 if batch is full
+     */
+    int batch_push(EquationBatch *batch, const Equation *equation);
+
+    /**
+     * @brief Returns the fastest kernel supported by this CPU.
+     * @details Checks CPU features once and remembers result.
+     * @return BK_AVX512, BK_AVX2 or BK_SCALAR
+     */
+    BATCH_KERNEL batch_kernel();
+
+    /**
+     * @brief Returns printable name of kernel.
+     * @param [in] kernel - Kernel of solve_batch
+     * @return "scalar", "avx2" or "avx512"
+     */
+    const char *batch_kernel_name(BATCH_KERNEL kernel);
+
+    /**
+     * @brief Solves n equations given as separate columns.
+     * @details Gives the same classification as solve_equation of the same double coefficients: is_zero checks on a, b, c and the
+     * discriminant, RN_INF, RN_ZERO, RN_ONE, RN_TWO, and QE_QUAD_ERROR for non-finite coefficients. The discriminant is computed in double,
+     * equations whose discriminant is within its rounding error of 0 or EPS are solved again in long double, their roots are rounded to
+     * double. Coefficients which were rounded to double (by batch_push) are other numbers, so an equation with a discriminant near 0
+     * may get another class than solve_equation of the original long double coefficients gives (0.0087890625 -0.537653034087270498276
+     * 8.22245788624348877827 has one root in long double and zero roots in double). Columns may be unaligned. If kernel is not
+     * supported by CPU, a slower one is used.
+     * @param [in]  *a, *b, *c - Columns of coefficients
+     * @param [out] *x1, *x2   - Columns of roots
+     * @param [out] *num_roots - Column of numbers of roots
+     * @param [in]  n          - Number of equations
+     * @param [in]  kernel     - Kernel to use
+     * @return void
+     */
+    void solve_columns(const double *a, const double *b, const double *c, double *x1, double *x2, int *num_roots, size_t n,
+                       BATCH_KERNEL kernel = batch_kernel());
+
+    /**
+     * @brief Solves every equation of the batch.
+     * @param [in, out] *batch - Batch to solve
+     * @param [in]      kernel - Kernel to use
+     * @return number of equations which were solved without QE_QUAD_ERROR
+     */
+    size_t solve_batch(EquationBatch *batch, BATCH_KERNEL kernel = batch_kernel());
+}
+
+#endif
@@ -0,0 +1,486 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "quadratic.h"
+#include "core.h"
+#include "adaptive.h"
+#include "common.h"
+#include "arena.h"
+#include "parser.h"
+#include "output.h"
+#include "format.h"
+
+/// Number of equations in one sample: latency of a sample divided by SAMPLE_SIZE is one value of p50/p99.
+static const size_t SAMPLE_SIZE = 1024;
+
+/// Maximal length of name of stage.
+static const size_t NAME_LENGTH = 64;
+
+/// Numbers of one equation in a line of plain output: a, b, c, x1 and x2.
+static const size_t LINE_NUMBERS = 5;
+
+/// Maximal number of stages.
+static const int MAX_RESULTS = 32;
+
+/**
+ * @brief Result of one stage.
+ * @param name      - Name of stage
+ * @param ns_per_eq - Mean time of one equation in ns
+ * @param eq_per_sec - Equations per second
+ * @param p50       - Median of sample time per equation in ns
+ * @param p99       - 99th percentile of sample time per equation in ns
+ * @param bytes_per_sec - Written bytes per second for formatting stages, 0 for others
+ */
+typedef struct {
+	char name[NAME_LENGTH];
+	double ns_per_eq, eq_per_sec;
+	double p50, p99;
+	double bytes_per_sec;
+} BenchResult;
+
+/**
+ * @brief Mixes of equations given to solve_equation.
+ */
+typedef enum {
+	BM_TWO_ROOTS, ///< Positive discriminant
+	BM_LINEAR,    ///< a = 0, b != 0
+	BM_ONE_ROOT,  ///< Zero discriminant
+	BM_INF,       ///< a = b = c = 0
+	BM_MIXED      ///< All classes above in turn
+} BENCH_MIX;
+
+/// Buffer of sample times shared by stages and a sink which keeps results of measured calls alive.
+typedef struct {
+	size_t samples;
+	double *times;
+	volatile long long sink;
+} BenchState;
+
+/**
+ * @brief Returns monotonic time in ns.
+ */
+static double now_ns();
+
+/**
+ * @brief Returns pseudorandom number in [-range, range], same sequence for every run.
+ */
+static long double random_number(unsigned long long *seed, int range);
+
+/**
+ * @brief Makes SAMPLE_SIZE equations of given mix. Every coefficient and root is exactly representable, so classes don't depend on EPS.
+ */
+static void make_mix(quadratic::Equation *equations, BENCH_MIX mix);
+
+/**
+ * @brief Compares two doubles for qsort.
+ */
+static int compare_times(const void *first, const void *second);
+
+/**
+ * @brief Computes ns/eq, eq/s and percentiles of state->times and writes them to result.
+ */
+static void summarize(BenchResult *result, const char *name, const BenchState *state);
+
+/**
+ * @brief Benchmarks stream_input (fscanf) and parser::parse_stream on the same file.
+ * @return number of results written
+ */
+static int bench_parse(BenchResult *results, BenchState *state);
+
+/**
+ * @brief Benchmarks make_equation (allocation of one equation, free is not measured).
+ */
+static void bench_make(BenchResult *result, BenchState *state);
+
+/**
+ * @brief Benchmarks solve_equation on equations of given mix.
+ */
+static void bench_solve(BenchResult *result, BenchState *state, BENCH_MIX mix, const char *name);
+
+/**
+ * @brief Benchmarks solve_core inlined into the loop on mixed equations (look solve_equation).
+ */
+static void bench_core(BenchResult *result, BenchState *state);
+
+/**
+ * @brief Benchmarks solve_adaptive (--type adaptive) on mixed equations.
+ */
+static void bench_adaptive(BenchResult *result, BenchState *state);
+
+/**
+ * @brief Benchmarks print_roots with stdout redirected to /dev/null. Every sample ends with fflush.
+ */
+static void bench_print(BenchResult *result, BenchState *state);
+
+/**
+ * @brief Makes LINE_NUMBERS numbers of every one of SAMPLE_SIZE equations with irrational roots, missing roots are 0.
+ */
+static void make_numbers(long double *numbers);
+
+/**
+ * @brief Benchmarks formatting of coefficients and roots into OutputBuffer in memory: output_number in given format of numbers,
+ * or output_printf("%+-10.5Lg") like plain output did before format_number if name is "format_printf".
+ */
+static void bench_format(BenchResult *result, BenchState *state, format::NUMBER_FORMAT numbers, const char *name);
+
+/**
+ * @brief Writes results to a JSON file, one result in a line.
+ * @return 1 if file was written and 0 otherwise
+ */
+static int write_json(const char *name, const BenchResult *results, int count, const BenchState *state);
+
+/**
+ * @brief Compares results with a JSON file written by write_json before.
+ * @details A stage regressed if its ns/eq is greater than baseline's one by more than tolerance percent.
+ * @return number of regressed stages or -1 if baseline can't be read
+ */
+static int compare_baseline(const char *name, const BenchResult *results, int count, double tolerance);
+
+static double now_ns() {
+	struct timespec time = {};
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (double)time.tv_sec * 1e9 + (double)time.tv_nsec;
+}
+
+static long double random_number(unsigned long long *seed, int range) {
+	*seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+	return (long double)((int)(*seed >> 33) % (2 * range + 1) - range);
+}
+
+static void make_mix(quadratic::Equation *equations, BENCH_MIX mix) {
+	unsigned long long seed = 2022;
+	for (size_t i = 0; i < SAMPLE_SIZE; ++i) {
+		BENCH_MIX cur = (mix == BM_MIXED) ? (BENCH_MIX)(i % BM_MIXED) : mix;
+		long double x1 = random_number(&seed, 100), x2 = random_number(&seed, 100) + 0.5L, k = random_number(&seed, 9);
+		k += (k >= 0) ? 1 : 0;
+
+		switch (cur) {
+		case BM_TWO_ROOTS:
+			equations[i] = {k, -k * (x1 + x2), k * x1 * x2, 0, 0, quadratic::RN_DEFAULT};
+			break;
+		case BM_LINEAR:
+			equations[i] = {0, k, -k * x1, 0, 0, quadratic::RN_DEFAULT};
+			break;
+		case BM_ONE_ROOT:
+			equations[i] = {k, -2 * k * x1, k * x1 * x1, 0, 0, quadratic::RN_DEFAULT};
+			break;
+		case BM_INF:
+			equations[i] = {0, 0, 0, 0, 0, quadratic::RN_DEFAULT};
+			break;
+		case BM_MIXED:
+		default:
+			ASSERTIF(0, "default case", );
+		}
+	}
+}
+
+static int compare_times(const void *first, const void *second) {
+	double a = *(const double *)first, b = *(const double *)second;
+	return (a > b) - (a < b);
+}
+
+static void summarize(BenchResult *result, const char *name, const BenchState *state) {
+	double total = 0;
+	for (size_t i = 0; i < state->samples; ++i) {
+		total += state->times[i];
+	}
+	qsort(state->times, state->samples, sizeof(double), compare_times);
+
+	*result = {};
+	snprintf(result->name, NAME_LENGTH, "%s", name);
+	result->ns_per_eq  = total / (double)(state->samples * SAMPLE_SIZE);
+	result->eq_per_sec = (result->ns_per_eq > 0) ? 1e9 / result->ns_per_eq : 0;
+	result->p50 = state->times[state->samples / 2]        / (double)SAMPLE_SIZE;
+	result->p99 = state->times[state->samples * 99 / 100] / (double)SAMPLE_SIZE;
+}
+
+static int bench_parse(BenchResult *results, BenchState *state) {
+	FILE *stream = tmpfile();
+	ASSERTIF(stream != NULL, "unable to create temporary file", 0);
+
+	static quadratic::Equation equations[SAMPLE_SIZE] = {};
+	make_mix(equations, BM_MIXED);
+	for (size_t i = 0; i < SAMPLE_SIZE; ++i) {
+		fprintf(stream, "%.17Lg %.17Lg %.17Lg\n", equations[i].a, equations[i].b, equations[i].c);
+	}
+	fflush(stream);
+
+	quadratic::EquationArena arena = {};
+	quadratic::make_arena(&arena, SAMPLE_SIZE);
+
+	for (int parser = 0; parser < 2; ++parser) {
+		for (size_t sample = 0; sample < state->samples; ++sample) {
+			fseek(stream, 0, SEEK_SET);
+			arena.size = 0;
+
+			double start = now_ns();
+			int read = parser ? parser::parse_stream(&arena, stream, quadratic::QD_NDEBUG)
+			                  : quadratic::stream_input(&arena, stream);
+			state->times[sample] = now_ns() - start;
+			state->sink += read;
+		}
+		summarize(results + parser, parser ? "parse_stream" : "stream_input", state);
+	}
+
+	quadratic::free_arena(&arena);
+	fclose(stream);
+	return 2;
+}
+
+static void bench_make(BenchResult *result, BenchState *state) {
+	static quadratic::Equation *equations[SAMPLE_SIZE] = {};
+
+	for (size_t sample = 0; sample < state->samples; ++sample) {
+		double start = now_ns();
+		for (size_t i = 0; i < SAMPLE_SIZE; ++i) {
+			equations[i] = quadratic::make_equation((long double)i, 1, 1);
+		}
+		state->times[sample] = now_ns() - start;
+
+		for (size_t i = 0; i < SAMPLE_SIZE; ++i) {
+			state->sink += equations[i] != NULL;
+			free(equations[i]);
+		}
+	}
+	summarize(result, "make_equation", state);
+}
+
+static void bench_solve(BenchResult *result, BenchState *state, BENCH_MIX mix, const char *name) {
+	static quadratic::Equation equations[SAMPLE_SIZE] = {};
+	make_mix(equations, mix);
+
+	for (size_t sample = 0; sample < state->samples; ++sample) {
+		long long roots = 0;
+		double start = now_ns();
+		for (size_t i = 0; i < SAMPLE_SIZE; ++i) {
+			roots += equations[i].num_roots = quadratic::solve_equation(&equations[i]);
+		}
+		state->times[sample] = now_ns() - start;
+		state->sink += roots;
+	}
+	summarize(result, name, state);
+}
+
+static void bench_core(BenchResult *result, BenchState *state) {
+	static quadratic::Equation equations[SAMPLE_SIZE] = {};
+	make_mix(equations, BM_MIXED);
+
+	for (size_t sample = 0; sample < state->samples; ++sample) {
+		long long roots = 0;
+		double start = now_ns();
+		for (size_t i = 0; i < SAMPLE_SIZE; ++i) {
+			quadratic::Equation *equation = equations + i;
+			roots += equation->num_roots = quadratic::store_roots(equation, quadratic::solve_core(equation->a, equation->b, equation->c));
+		}
+		state->times[sample] = now_ns() - start;
+		state->sink += roots;
+	}
+	summarize(result, "solve_core_mixed", state);
+}
+
+static void bench_adaptive(BenchResult *result, BenchState *state) {
+	static quadratic::Equation equations[SAMPLE_SIZE] = {};
+	make_mix(equations, BM_MIXED);
+
+	size_t escalated = 0;
+	for (size_t sample = 0; sample < state->samples; ++sample) {
+		double start = now_ns();
+		size_t solved = quadratic::solve_adaptive(equations, SAMPLE_SIZE, &escalated);
+		state->times[sample] = now_ns() - start;
+		state->sink += (long long)solved;
+	}
+	state->sink += (long long)escalated;
+	summarize(result, "solve_adaptive", state);
+}
+
+static void bench_print(BenchResult *result, BenchState *state) {
+	static quadratic::Equation equations[SAMPLE_SIZE] = {};
+	make_mix(equations, BM_MIXED);
+	for (size_t i = 0; i < SAMPLE_SIZE; ++i) {
+		equations[i].num_roots = quadratic::solve_equation(&equations[i]);
+	}
+
+	fflush(stdout);
+	int saved = dup(STDOUT_FILENO), null = open("/dev/null", O_WRONLY);
+	ASSERTIF(saved >= 0 && null >= 0, "unable to redirect stdout", );
+	dup2(null, STDOUT_FILENO);
+	close(null);
+
+	for (size_t sample = 0; sample < state->samples; ++sample) {
+		double start = now_ns();
+		for (size_t i = 0; i < SAMPLE_SIZE; ++i) {
+			quadratic::print_roots(&equations[i]);
+		}
+		fflush(stdout);
+		state->times[sample] = now_ns() - start;
+	}
+
+	dup2(saved, STDOUT_FILENO);
+	close(saved);
+	summarize(result, "print_roots", state);
+}
+
+static void make_numbers(long double *numbers) {
+	static quadratic::Equation equations[SAMPLE_SIZE] = {};
+	make_mix(equations, BM_MIXED);
+	for (size_t i = 0; i < SAMPLE_SIZE; ++i) {
+		quadratic::Equation *equation = equations + i;
+		equation->c += 1;
+		equation->num_roots = quadratic::solve_equation(equation);
+
+		long double *line = numbers + i * LINE_NUMBERS;
+		line[0] = equation->a;
+		line[1] = equation->b;
+		line[2] = equation->c;
+		line[3] = (equation->num_roots == quadratic::RN_ONE || equation->num_roots == quadratic::RN_TWO) ? equation->x1 : 0;
+		line[4] = (equation->num_roots == quadratic::RN_TWO) ? equation->x2 : 0;
+	}
+}
+
+static void bench_format(BenchResult *result, BenchState *state, format::NUMBER_FORMAT numbers, const char *name) {
+	static long double values[SAMPLE_SIZE * LINE_NUMBERS] = {};
+	make_numbers(values);
+	int use_printf = strcmp(name, "format_printf") == 0;
+
+	output::OutputBuffer out = {};
+	if (!output::make_output(&out, output::OUTPUT_MEMORY)) {
+		printf("Unable to alloc output buffer\n");
+		return;
+	}
+	out.numbers = numbers;
+
+	size_t bytes = 0;
+	for (size_t sample = 0; sample < state->samples; ++sample) {
+		out.size = 0;
+		double start = now_ns();
+		for (size_t i = 0; i < SAMPLE_SIZE * LINE_NUMBERS; ++i) {
+			if (use_printf) {
+				output::output_printf(&out, "%+-10.5Lg", values[i]);
+			} else {
+				output::output_number(&out, values[i]);
+			}
+		}
+		state->times[sample] = now_ns() - start;
+		state->sink += out.data[out.size / 2];
+		bytes += out.size;
+	}
+	output::free_output(&out);
+
+	summarize(result, name, state);
+	double total = result->ns_per_eq * (double)(state->samples * SAMPLE_SIZE);
+	result->bytes_per_sec = (total > 0) ? (double)bytes / total * 1e9 : 0;
+}
+
+static int write_json(const char *name, const BenchResult *results, int count, const BenchState *state) {
+	FILE *json = fopen(name, "w");
+	if (json == NULL) {
+		printf("Unable to create %s\n", name);
+		return 0;
+	}
+
+	fprintf(json, "{\n  \"sample_size\": %zu,\n  \"samples\": %zu,\n  \"results\": [\n", SAMPLE_SIZE, state->samples);
+	for (int i = 0; i < count; ++i) {
+		fprintf(json, "    {\"name\": \"%s\", \"ns_per_eq\": %.3f, \"eq_per_sec\": %.0f, \"p50_ns\": %.3f, \"p99_ns\": %.3f, \"bytes_per_sec\": %.0f}%s\n",
+		        results[i].name, results[i].ns_per_eq, results[i].eq_per_sec, results[i].p50, results[i].p99, results[i].bytes_per_sec,
+		        (i + 1 < count) ? "," : "");
+	}
+	fprintf(json, "  ]\n}\n");
+	return fclose(json) == 0;
+}
+
+static int compare_baseline(const char *name, const BenchResult *results, int count, double tolerance) {
+	FILE *json = fopen(name, "r");
+	if (json == NULL) {
+		printf("Unable to open baseline %s\n", name);
+		return -1;
+	}
+
+	printf("\nComparison with %s (tolerance %.1f%%):\n", name, tolerance);
+	int regressed = 0, compared = 0;
+	char line[256] = "";
+	while (fgets(line, sizeof(line), json) != NULL) {
+		char stage[NAME_LENGTH] = "";
+		double base = 0;
+		if (sscanf(line, " {\"name\": \"%63[^\"]\", \"ns_per_eq\": %lf", stage, &base) != 2)
+			continue;
+
+		for (int i = 0; i < count; ++i) {
+			if (strcmp(results[i].name, stage) != 0)
+				continue;
+
+			double change = (base > 0) ? (results[i].ns_per_eq / base - 1) * 100 : 0;
+			int slower = change > tolerance;
+			printf("%-18s %10.3f -> %10.3f ns/eq %+7.1f%% %s\n", stage, base, results[i].ns_per_eq, change, slower ? "REGRESSION" : "ok");
+			regressed += slower;
+			compared++;
+		}
+	}
+	fclose(json);
+
+	if (compared == 0) {
+		printf("No stages of %s match this benchmark\n", name);
+		return -1;
+	}
+	return regressed;
+}
+
+int main(int argc, const char *argv[]) {
+	const char *json = NULL, *baseline = NULL;
+	double tolerance = 10;
+	long samples = 200;
+
+	for (int arg = 1; arg < argc; ++arg) {
+		if (strcmp(argv[arg], "--json") == 0 && arg + 1 < argc) {
+			json = argv[++arg];
+		} else if (strcmp(argv[arg], "--baseline") == 0 && arg + 1 < argc) {
+			baseline = argv[++arg];
+		} else if (strcmp(argv[arg], "--tolerance") == 0 && arg + 1 < argc) {
+			tolerance = atof(argv[++arg]);
+		} else if (strcmp(argv[arg], "-n") == 0 && arg + 1 < argc) {
+			samples = atol(argv[++arg]);
+		} else {
+			samples = 0;
+			break;
+		}
+	}
+	if (samples <= 0) {
+		printf("Usage: %s [-n samples] [--json result.json] [--baseline baseline.json] [--tolerance percent]\n", argv[0]);
+		return 1;
+	}
+
+	BenchState state = {(size_t)samples, (double *)calloc((size_t)samples, sizeof(double)), 0};
+	ASSERTIF(state.times != NULL, "unable to alloc", 1);
+
+	BenchResult results[MAX_RESULTS] = {};
+	int count = bench_parse(results, &state);
+	bench_make (results + count++, &state);
+	bench_solve(results + count++, &state, BM_TWO_ROOTS, "solve_two_roots");
+	bench_solve(results + count++, &state, BM_LINEAR,    "solve_linear");
+	bench_solve(results + count++, &state, BM_ONE_ROOT,  "solve_one_root");
+	bench_solve(results + count++, &state, BM_INF,       "solve_inf");
+	bench_solve(results + count++, &state, BM_MIXED,     "solve_mixed");
+	bench_core (results + count++, &state);
+	bench_adaptive(results + count++, &state);
+	bench_print(results + count++, &state);
+	bench_format(results + count++, &state, format::NF_FIXED,    "format_printf");
+	bench_format(results + count++, &state, format::NF_FIXED,    "format_fixed");
+	bench_format(results + count++, &state, format::NF_SHORTEST, "format_shortest");
+	bench_format(results + count++, &state, format::NF_HEX,      "format_hex");
+	free(state.times);
+
+	printf("%-18s %12s %14s %10s %10s %14s\n", "stage", "ns/eq", "eq/s", "p50 ns", "p99 ns", "bytes/s");
+	for (int i = 0; i < count; ++i) {
+		printf("%-18s %12.3f %14.0f %10.3f %10.3f %14.0f\n", results[i].name, results[i].ns_per_eq, results[i].eq_per_sec, results[i].p50,
+		       results[i].p99, results[i].bytes_per_sec);
+	}
+
+	if (json != NULL && !write_json(json, results, count, &state))
+		return 1;
+	if (baseline != NULL)
+		return (compare_baseline(baseline, results, count, tolerance) != 0) ? 1 : 0;
+	return 0;
+}
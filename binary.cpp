@@ -0,0 +1,287 @@
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "common.h"
+#include "arena.h"
+#include "pool.h"
+#include "binary.h"
+
+namespace binary {
+    static_assert(sizeof(BinaryHeader) == 128, "BinaryHeader must have fixed size");
+    static_assert(sizeof(long double) == BP_LONG_DOUBLE, "long double must take 16 bytes");
+
+    /// Magic string at the start of file.
+    static const char MAGIC[8] = "QUADBIN";
+
+    /// Number of equations in one chunk of thread pool's job.
+    static const size_t BINARY_CHUNK = 1 << 16;
+
+    /**
+     * @brief Context of solve_chunk.
+     * @param input     - Mapped input file
+     * @param columns   - Columns of output file
+     * @param precision - Precision of output file
+     * @param solved    - Number of equations solved without QE_QUAD_ERROR by each worker
+     */
+    typedef struct {
+        const BinaryFile *input;
+        void **columns;
+        uint32_t precision;
+        size_t *solved;
+    } SolveContext;
+
+    /**
+     * @brief Creates file of given size and maps it for writing.
+     * @param [in] *name - Name of file
+     * @param [in] bytes - Size of file
+     * @return Mapping or NULL in case of errors
+     */
+    static void *map_output(const char *name, size_t bytes);
+
+    /**
+     * @brief Reads number of column like long double.
+     */
+    static long double read_number(const void *column, uint32_t precision, size_t index);
+
+    /**
+     * @brief Writes number to column.
+     */
+    static void write_number(void *column, uint32_t precision, size_t index, long double value);
+
+    /**
+     * @brief Solves equations [begin, end) of SolveContext (look parallel::TASK).
+     */
+    static void solve_chunk(void *context, size_t begin, size_t end, int worker);
+
+    size_t column_size(uint32_t precision, int column, size_t count) {
+        return count * ((column == BC_NUM_ROOTS) ? sizeof(int32_t) : precision);
+    }
+
+    size_t make_header(BinaryHeader *header, BINARY_PRECISION precision, size_t count, int with_roots) {
+        ASSERTIF(header != NULL, "nullptr in header", 0);
+
+        *header = {};
+        memcpy(header->magic, MAGIC, sizeof(MAGIC));
+        header->version   = BINARY_VERSION;
+        header->precision = precision;
+        header->count     = count;
+        header->flags     = with_roots ? BF_ROOTS : 0;
+
+        size_t offset = sizeof(BinaryHeader);
+        for (int column = 0; column < (with_roots ? BC_COUNT : BC_X1); ++column) {
+            offset = (offset + BINARY_ALIGN - 1) / BINARY_ALIGN * BINARY_ALIGN;
+            header->offsets[column] = offset;
+            offset += column_size(precision, column, count);
+        }
+        return offset;
+    }
+
+    static void *map_output(const char *name, size_t bytes) {
+        int fd = open(name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            printf("Unable to create %s\n", name);
+            return NULL;
+        }
+
+        void *map = MAP_FAILED;
+        if (ftruncate(fd, (off_t)bytes) == 0) {
+            map = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+
+        if (map == MAP_FAILED) {
+            printf("Unable to map %s\n", name);
+            return NULL;
+        }
+        return map;
+    }
+
+    static long double read_number(const void *column, uint32_t precision, size_t index) {
+        return (precision == BP_DOUBLE) ? ((const double *)column)[index] : ((const long double *)column)[index];
+    }
+
+    static void write_number(void *column, uint32_t precision, size_t index, long double value) {
+        if (precision == BP_DOUBLE) {
+            ((double *)column)[index] = (double)value;
+        } else {
+            ((long double *)column)[index] = value;
+        }
+    }
+
+    int open_binary(BinaryFile *file, const char *name) {
+        ASSERTIF(file != NULL, "nullptr in file", 0);
+        ASSERTIF(name != NULL, "nullptr in name", 0);
+
+        *file = {};
+        int fd = open(name, O_RDONLY);
+        if (fd < 0) {
+            printf("Wrong name filename %s\n", name);
+            return 0;
+        }
+
+        struct stat info = {};
+        if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(BinaryHeader)) {
+            printf("%s is not a binary file of equations\n", name);
+            close(fd);
+            return 0;
+        }
+
+        file->bytes = (size_t)info.st_size;
+        file->map = mmap(NULL, file->bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (file->map == MAP_FAILED) {
+            *file = {};
+            printf("Unable to map %s\n", name);
+            return 0;
+        }
+
+        const BinaryHeader *header = file->header = (const BinaryHeader *)file->map;
+        int valid = memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0 && header->version == BINARY_VERSION &&
+                    (header->precision == BP_DOUBLE || header->precision == BP_LONG_DOUBLE);
+
+        int columns = (header->flags & BF_ROOTS) ? BC_COUNT : BC_X1;
+        for (int column = 0; valid && column < columns; ++column) {
+            uint64_t offset = header->offsets[column];
+            valid = offset % BINARY_ALIGN == 0 && offset >= sizeof(BinaryHeader) && offset <= file->bytes &&
+                    header->count <= (file->bytes - offset) / (column_size(header->precision, column, 1));
+            file->columns[column] = (const char *)file->map + offset;
+        }
+
+        if (!valid) {
+            printf("%s is not a binary file of equations\n", name);
+            close_binary(file);
+            return 0;
+        }
+        return 1;
+    }
+
+    void close_binary(BinaryFile *file) {
+        if (file == NULL)
+            return;
+
+        if (file->map != NULL) {
+            munmap(file->map, file->bytes);
+        }
+        *file = {};
+    }
+
+    int binary_input(quadratic::EquationArena *equations, const BinaryFile *file) {
+        ASSERTIF(equations != NULL, "nullptr in equations", 0);
+        ASSERTIF(file      != NULL, "nullptr in file",      0);
+
+        const BinaryHeader *header = file->header;
+        const void *const *columns = file->columns;
+        for (size_t i = 0; i < header->count; ++i) {
+            quadratic::Equation equation = {read_number(columns[BC_A], header->precision, i), read_number(columns[BC_B], header->precision, i),
+                                            read_number(columns[BC_C], header->precision, i), 0, 0, quadratic::RN_DEFAULT};
+            if (header->flags & BF_ROOTS) {
+                equation.x1 = read_number(columns[BC_X1], header->precision, i);
+                equation.x2 = read_number(columns[BC_X2], header->precision, i);
+                equation.num_roots = ((const int32_t *)columns[BC_NUM_ROOTS])[i];
+            }
+
+            if (quadratic::arena_push(equations, &equation) == NULL)
+                return (int)i;
+        }
+        return (int)header->count;
+    }
+
+    int write_binary(const char *name, const quadratic::Equation *equations, size_t count, BINARY_PRECISION precision, int with_roots) {
+        ASSERTIF(name      != NULL,              "nullptr in name",      0);
+        ASSERTIF(equations != NULL || count == 0, "nullptr in equations", 0);
+
+        BinaryHeader header = {};
+        size_t bytes = make_header(&header, precision, count, with_roots);
+
+        char *map = (char *)map_output(name, bytes);
+        if (map == NULL)
+            return 0;
+
+        memcpy(map, &header, sizeof(header));
+        void *columns[BC_COUNT] = {};
+        for (int column = 0; column < BC_COUNT; ++column) {
+            columns[column] = (header.offsets[column] != 0) ? map + header.offsets[column] : NULL;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            write_number(columns[BC_A], precision, i, equations[i].a);
+            write_number(columns[BC_B], precision, i, equations[i].b);
+            write_number(columns[BC_C], precision, i, equations[i].c);
+            if (with_roots) {
+                write_number(columns[BC_X1], precision, i, equations[i].x1);
+                write_number(columns[BC_X2], precision, i, equations[i].x2);
+                ((int32_t *)columns[BC_NUM_ROOTS])[i] = equations[i].num_roots;
+            }
+        }
+
+        munmap(map, bytes);
+        return 1;
+    }
+
+    static void solve_chunk(void *context, size_t begin, size_t end, int worker) {
+        SolveContext *solve = (SolveContext *)context;
+        const BinaryFile *input = solve->input;
+        void **columns = solve->columns;
+        const uint32_t from = input->header->precision, to = solve->precision;
+
+        // Equations are solved in long double whatever precision of files is, like run_batch solves them with --type long.
+        for (size_t i = begin; i < end; ++i) {
+            quadratic::Equation equation = {read_number(input->columns[BC_A], from, i), read_number(input->columns[BC_B], from, i),
+                                            read_number(input->columns[BC_C], from, i), 0, 0, quadratic::RN_DEFAULT};
+            int num_roots = quadratic::solve_equation(&equation);
+
+            write_number(columns[BC_A],  to, i, equation.a);
+            write_number(columns[BC_B],  to, i, equation.b);
+            write_number(columns[BC_C],  to, i, equation.c);
+            write_number(columns[BC_X1], to, i, equation.x1);
+            write_number(columns[BC_X2], to, i, equation.x2);
+            ((int32_t *)columns[BC_NUM_ROOTS])[i] = num_roots;
+            solve->solved[worker] += num_roots != quadratic::QE_QUAD_ERROR;
+        }
+    }
+
+    int solve_binary(const BinaryFile *input, const char *name, BINARY_PRECISION precision, int threads, size_t *solved) {
+        ASSERTIF(input != NULL, "nullptr in input", 0);
+        ASSERTIF(name  != NULL, "nullptr in name",  0);
+
+        const BinaryHeader *header = input->header;
+        BinaryHeader output = {};
+        size_t bytes = make_header(&output, precision, header->count, 1);
+
+        char *map = (char *)map_output(name, bytes);
+        if (map == NULL)
+            return 0;
+
+        memcpy(map, &output, sizeof(output));
+        void *columns[BC_COUNT] = {};
+        for (int column = 0; column < BC_COUNT; ++column) {
+            columns[column] = map + output.offsets[column];
+        }
+
+        parallel::ThreadPool *pool = parallel::make_pool(threads < 1 ? 1 : threads);
+        if (pool == NULL) {
+            munmap(map, bytes);
+            return 0;
+        }
+        size_t *counts = new size_t[(size_t)parallel::pool_size(pool)]();
+
+        SolveContext context = {input, columns, precision, counts};
+        parallel::pool_for(pool, header->count, BINARY_CHUNK, solve_chunk, &context);
+
+        size_t total = 0;
+        for (int worker = 0; worker < parallel::pool_size(pool); ++worker) {
+            total += counts[worker];
+        }
+        if (solved != NULL) {
+            *solved = total;
+        }
+
+        delete[] counts;
+        parallel::free_pool(pool);
+        return munmap(map, bytes) == 0;
+    }
+}
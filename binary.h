@@ -0,0 +1,136 @@
+#ifndef BINARY_DEF
+#define BINARY_DEF
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "quadratic.h"
+
+/**
+ * @brief   This namespace includes a binary columnar format of equations.
+ * @details A file starts with BinaryHeader, then columns follow: a, b, c and, if BF_ROOTS is set, x1, x2 and num_roots. Every column
+ * starts at an offset aligned to BINARY_ALIGN, numbers are stored in native byte order in double or long double (precision tag),
+ * num_roots in int32_t with ROOT_NUMBER values. Files with roots are results of solving or tests (like test.txt), files without roots
+ * are equations (like input.txt). Files are read by mmap, so a file is solved without parsing and without copying it (solve_binary).
+ */
+namespace binary {
+    /// Alignment of columns in file.
+    const size_t BINARY_ALIGN = 64;
+
+    /// Version of format written by this program.
+    const uint32_t BINARY_VERSION = 1;
+
+    /// Enumerated type of data with precision tags (size of number in bytes).
+    typedef enum {
+        BP_DOUBLE      = 8,  ///< double
+        BP_LONG_DOUBLE = 16  ///< x87 long double in 16 bytes
+    } BINARY_PRECISION;
+
+    /// Flags of BinaryHeader.
+    typedef enum {
+        BF_ROOTS = 1 ///< File has x1, x2 and num_roots columns
+    } BINARY_FLAGS;
+
+    /// Enumerated type of data with columns of file.
+    typedef enum {
+        BC_A, BC_B, BC_C, BC_X1, BC_X2, BC_NUM_ROOTS,
+        BC_COUNT ///< Number of columns
+    } BINARY_COLUMN;
+
+    /**
+     * @brief Header of binary file.
+     * @param magic     - "QUADBIN" with '\0'
+     * @param version   - BINARY_VERSION
+     * @param precision - BINARY_PRECISION
+     * @param count     - Number of equations
+     * @param flags     - BINARY_FLAGS
+     * @param offsets   - Offsets of columns from the start of file (0 if there is no column)
+     */
+    typedef struct {
+        char magic[8];
+        uint32_t version, precision;
+        uint64_t count;
+        uint32_t flags, reserved;
+        uint64_t offsets[BC_COUNT];
+        uint8_t padding[128 - 32 - 8 * BC_COUNT];
+    } BinaryHeader;
+
+    /**
+     * @brief A binary file mapped into memory.
+     * @param map    - Mapping of the whole file
+     * @param bytes  - Size of mapping
+     * @param header - Header of file
+     * @param columns - Pointers to columns (NULL if there is no column)
+     */
+    typedef struct {
+        void *map;
+        size_t bytes;
+        const BinaryHeader *header;
+        const void *columns[BC_COUNT];
+    } BinaryFile;
+
+    /**
+     * @brief Fills header and offsets of columns of a file of count equations.
+     * @param [out] *header    - Header to fill
+     * @param [in]  precision  - Precision of numbers
+     * @param [in]  count      - Number of equations
+     * @param [in]  with_roots - Are there x1, x2 and num_roots columns
+     * @return Size of file in bytes
+     */
+    size_t make_header(BinaryHeader *header, BINARY_PRECISION precision, size_t count, int with_roots);
+
+    /**
+     * @brief Returns size of count numbers of column in bytes.
+     */
+    size_t column_size(uint32_t precision, int column, size_t count);
+
+    /**
+     * @brief Maps file and checks its header and size.
+     * @param [out] *file - Mapped file
+     * @param [in]  *name - Name of file
+     * @return 1 if file is a valid binary file and 0 otherwise
+     */
+    int open_binary(BinaryFile *file, const char *name);
+
+    /**
+     * @brief Unmaps file.
+     * @return void
+     */
+    void close_binary(BinaryFile *file);
+
+    /**
+     * @brief Appends equations of mapped file to arena (converting numbers to long double).
+     * @param [out] *equations - Arena to append equations
+     * @param [in]  *file      - Mapped file
+     * @return number of appended equations
+     */
+    int binary_input(quadratic::EquationArena *equations, const BinaryFile *file);
+
+    /**
+     * @brief Writes equations to a binary file.
+     * @param [in] *name       - Name of file
+     * @param [in] *equations  - Array of equations
+     * @param [in] count       - Number of equations
+     * @param [in] precision   - Precision of numbers in file
+     * @param [in] with_roots  - Write x1, x2 and num_roots columns
+     * @return 1 if file was written and 0 otherwise
+     */
+    int write_binary(const char *name, const quadratic::Equation *equations, size_t count, BINARY_PRECISION precision, int with_roots);
+
+    /**
+     * @brief Solves equations of mapped file and writes results to a binary file of given precision.
+     * @details Output file is mapped too: coefficients and roots are written straight into its columns. Equations are solved by
+     * solve_equation in long double whatever precision of files is, so results are the same as binary_input, solve_equations with
+     * --type long and write_binary give.
+     * @param [in]  *input    - Mapped file
+     * @param [in]  *name     - Name of output file
+     * @param [in]  precision - Precision of output file
+     * @param [in]  threads   - Number of threads (0 or 1 for one)
+     * @param [out] *solved  - Number of equations solved without QE_QUAD_ERROR (may be NULL)
+     * @return 1 if output file was written and 0 if it can't be created or threads can't be started
+     */
+    int solve_binary(const BinaryFile *input, const char *name, BINARY_PRECISION precision, int threads, size_t *solved = NULL);
+}
+
+#endif
@@ -0,0 +1,163 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "common.h"
+#include "cache.h"
+
+namespace quadratic {
+    /// Number of significant bytes of x87 long double, others are padding.
+    static const size_t NUMBER_BYTES = 10;
+
+    /// Coefficients with exponents out of [-CACHE_EXPONENT, CACHE_EXPONENT] bypass cache: products of normalized ones must not underflow.
+    static const int CACHE_EXPONENT = 4000;
+
+    /// Flags of CacheEntry.
+    typedef enum {
+        CF_ZERO_A        = 1,  ///< common::is_zero(a)
+        CF_ZERO_B        = 2,  ///< common::is_zero(b)
+        CF_ZERO_C        = 4,  ///< common::is_zero(c)
+        CF_ZERO_D        = 8,  ///< common::is_zero(discriminant)
+        CF_NEGATIVE_D    = 16  ///< discriminant < 0
+    } CACHE_FLAGS;
+
+    /**
+     * @brief Normalizes coefficients (look SolveCache) and computes flags.
+     * @param [in]  *equation - Equation
+     * @param [out] *key      - Entry with normalized coefficients and flags
+     * @return 1 if equation can be cached and 0 otherwise
+     */
+    static int make_key(const Equation *equation, CacheEntry *key);
+
+    /**
+     * @brief Returns hash of normalized coefficients and flags.
+     */
+    static uint64_t hash_key(const CacheEntry *key);
+
+    /**
+     * @brief Returns 1 if entry has the same key.
+     */
+    static int same_key(const CacheEntry *entry, const CacheEntry *key);
+
+    /**
+     * @brief Writes result of entry to equation like solve_equation.
+     * @return number of roots
+     */
+    static int write_result(const CacheEntry *entry, Equation *equation);
+
+    int make_cache(SolveCache *cache, size_t capacity) {
+        ASSERTIF(cache != NULL, "nullptr in cache", 0);
+
+        size_t size = 1;
+        for (; size < capacity; size <<= 1);
+
+        *cache = {(CacheEntry *)calloc(size, sizeof(CacheEntry)), size, 0, 0, 0};
+        return cache->entries != NULL;
+    }
+
+    void free_cache(SolveCache *cache) {
+        if (cache == NULL)
+            return;
+
+        free(cache->entries);
+        *cache = {};
+    }
+
+    static int make_key(const Equation *equation, CacheEntry *key) {
+        long double a = equation->a, b = equation->b, c = equation->c;
+        if (!isfinite(a) || !isfinite(b) || !isfinite(c) || !isfinite(equation->x1) || !isfinite(equation->x2))
+            return 0;
+
+        long double coefficients[3] = {a, b, c};
+        int scale = -CACHE_EXPONENT - 1;
+        for (int i = 0; i < 3; ++i) {
+            if (fpclassify(coefficients[i]) == FP_ZERO)
+                continue;
+
+            int exponent = ilogbl(coefficients[i]);
+            if (exponent < -CACHE_EXPONENT || exponent > CACHE_EXPONENT)
+                return 0;
+            scale = (exponent > scale) ? exponent : scale;
+        }
+
+        long double discriminant = b * b - 4 * a * c;
+        *key = {};
+        key->flags = (uint8_t)((common::is_zero(a) ? CF_ZERO_A : 0) | (common::is_zero(b) ? CF_ZERO_B : 0) | (common::is_zero(c) ? CF_ZERO_C : 0) |
+                               (common::is_zero(discriminant) ? CF_ZERO_D : 0) | ((discriminant < 0) ? CF_NEGATIVE_D : 0));
+
+        // Signs are kept, zeros too: signs of zero roots depend on them, so equations of opposite signs have different keys.
+        key->a = scalbnl(a, -scale);
+        key->b = scalbnl(b, -scale);
+        key->c = scalbnl(c, -scale);
+        return 1;
+    }
+
+    static uint64_t hash_key(const CacheEntry *key) {
+        uint64_t hash = 14695981039346656037ULL ^ key->flags;
+        const long double *numbers[3] = {&key->a, &key->b, &key->c};
+        for (int i = 0; i < 3; ++i) {
+            unsigned char bytes[NUMBER_BYTES] = {};
+            memcpy(bytes, numbers[i], NUMBER_BYTES);
+            for (size_t byte = 0; byte < NUMBER_BYTES; ++byte) {
+                hash = (hash ^ bytes[byte]) * 1099511628211ULL;
+            }
+        }
+        return hash ^ (hash >> 29);
+    }
+
+    static int same_key(const CacheEntry *entry, const CacheEntry *key) {
+        return entry->used && entry->flags == key->flags && memcmp(&entry->a, &key->a, NUMBER_BYTES) == 0 &&
+               memcmp(&entry->b, &key->b, NUMBER_BYTES) == 0 && memcmp(&entry->c, &key->c, NUMBER_BYTES) == 0;
+    }
+
+    static int write_result(const CacheEntry *entry, Equation *equation) {
+        switch (entry->num_roots) {
+        case RN_TWO:
+            equation->x1 = entry->x1;
+            equation->x2 = entry->x2;
+            break;
+        case RN_ONE:
+            equation->x1 = entry->x1;
+            break;
+        default:
+            break;
+        }
+        return entry->num_roots;
+    }
+
+    int cached_solve(SolveCache *cache, Equation *equation) {
+        ASSERTIF(cache    != NULL, "nullptr in cache",    QE_QUAD_ERROR);
+        ASSERTIF(equation != NULL, "nullptr in equation", QE_QUAD_ERROR);
+
+        CacheEntry key = {};
+        if (!make_key(equation, &key)) {
+            cache->bypasses++;
+            return solve_equation(equation);
+        }
+
+        size_t mask = cache->capacity - 1, home = hash_key(&key) & mask, slot = home;
+        for (size_t probe = 0; probe < CACHE_PROBES; ++probe, slot = (slot + 1) & mask) {
+            CacheEntry *entry = cache->entries + slot;
+            if (same_key(entry, &key)) {
+                cache->hits++;
+                return write_result(entry, equation);
+            }
+            if (!entry->used) {
+                home = slot;
+                break;
+            }
+        }
+
+        // Roots don't change when equation is scaled exactly, so roots of the original equation are stored as roots of normalized one.
+        int num_roots = solve_equation(equation);
+        key.num_roots = num_roots;
+        key.x1 = equation->x1;
+        key.x2 = equation->x2;
+        key.used = 1;
+
+        cache->entries[home] = key;
+        cache->misses++;
+        return num_roots;
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef CACHE_DEF
+#define CACHE_DEF
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "quadratic.h"
+
+namespace quadratic {
+    /// Default number of entries of SolveCache (power of 2).
+    const size_t CACHE_CAPACITY = 1 << 16;
+
+    /// Maximal number of entries checked by one lookup.
+    const size_t CACHE_PROBES = 8;
+
+    /**
+     * @brief   An entry of SolveCache.
+     * @param a, b, c   - Normalized coefficients
+     * @param flags     - Flags of original equation which choose the branch of solve_equation (look cached_solve)
+     * @param used      - Entry has a result
+     * @param num_roots - Number of roots of normalized equation
+     * @param x1, x2    - Roots of normalized equation
+     */
+    typedef struct {
+        long double a, b, c;
+        long double x1, x2;
+        int num_roots;
+        uint8_t flags, used;
+    } CacheEntry;
+
+    /**
+     * @brief   Fixed-size open-addressing table of solved equations (--cache).
+     * @details Equations are normalized before lookup: coefficients are multiplied by a power of 2, so the largest of them is in [1, 2).
+     * It is exact, so every step of solve_equation is scaled exactly and roots of an equation and its normalized form are equal bit by
+     * bit. Signs are not normalized: a change of sign may change signs of zero roots (2x^2 + 3x has root +0, -2x^2 - 3x - 0 has -0),
+     * so equations of opposite signs are different entries. Key also has results of all
+     * common::is_zero tests and sign of discriminant of original equation, so scaled copies which solve_equation treats differently
+     * (because EPS is absolute) have different keys. Results are identical to solve_equation.
+     * @param entries   - Table
+     * @param capacity  - Number of entries (power of 2)
+     * @param hits      - Number of equations found in table
+     * @param misses    - Number of equations solved and stored
+     * @param bypasses  - Number of equations solved without table (not finite or too large or small exponents)
+     */
+    typedef struct {
+        CacheEntry *entries;
+        size_t capacity;
+        size_t hits, misses, bypasses;
+    } SolveCache;
+
+    /**
+     * @brief Allocates table.
+     * @param [out] *cache    - Cache to make
+     * @param [in]  capacity  - Number of entries, rounded up to a power of 2
+     * @return 1 if memory was allocated and 0 otherwise
+     */
+    int make_cache(SolveCache *cache, size_t capacity = CACHE_CAPACITY);
+
+    /**
+     * @brief Frees table.
+     * @return void
+     */
+    void free_cache(SolveCache *cache);
+
+    /**
+     * @brief Solves equation like solve_equation using cache.
+     * @details Writes the same roots as solve_equation would write and leaves the same members unchanged.
+     * @param [in, out] *cache    - Cache
+     * @param [in, out] *equation - Equation to solve
+     * @return number of roots (look ROOT_NUMBER) or QE_QUAD_ERROR, you must make equation->num_roots equal to this value
+     */
+    int cached_solve(SolveCache *cache, Equation *equation);
+}
+
+#endif
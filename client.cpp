@@ -0,0 +1,277 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "quadratic.h"
+#include "common.h"
+#include "arena.h"
+#include "parser.h"
+#include "output.h"
+#include "stats.h"
+#include "server.h"
+
+/// Default number of equations in one request.
+static const size_t FRAME_EQUATIONS = 4096;
+
+/// Size of one recv(2).
+static const size_t READ_CHUNK = 1 << 16;
+
+/**
+ * @brief State of client.
+ * @param kind      - Kind of requests
+ * @param equations - Equations to solve
+ * @param frame     - Number of equations in one request
+ * @param requests  - Requests to send (in memory)
+ * @param ends      - Offset of the end of every request in requests
+ * @param sent_at   - Time when every request was sent
+ * @param count     - Number of requests
+ * @param sent      - Number of sent bytes of requests
+ * @param answers   - Received bytes which are not taken as answers yet
+ * @param answered  - Number of received answers
+ * @param latency, latency_max - Total and maximal time from sending request to receiving its answer in ns
+ */
+typedef struct {
+	server::SERVE_KIND kind;
+	quadratic::EquationArena equations;
+	size_t frame;
+	output::OutputBuffer requests;
+	size_t *ends;
+	uint64_t *sent_at;
+	size_t count, sent;
+	output::OutputBuffer answers;
+	size_t answered;
+	uint64_t latency, latency_max;
+} Client;
+
+/**
+ * @brief Writes all equations into requests of client->frame equations.
+ * @return 1 if requests were made and 0 otherwise
+ */
+static int make_requests(Client *client) {
+	size_t total = client->equations.size, count = (total + client->frame - 1) / client->frame;
+	client->ends = (size_t *)calloc(count + 1, sizeof(size_t));
+	client->sent_at = (uint64_t *)calloc(count + 1, sizeof(uint64_t));
+	if (client->ends == NULL || client->sent_at == NULL || !output::make_output(&client->requests, output::OUTPUT_MEMORY)) {
+		return 0;
+	}
+
+	output::OutputBuffer *out = &client->requests;
+	for (size_t request = 0; request < count; request++) {
+		size_t first = request * client->frame, last = (first + client->frame < total) ? first + client->frame : total;
+		size_t header_at = out->size;
+		server::FrameHeader header = {server::SERVE_MAGIC, client->kind, request, 0};
+		output::output_write(out, (const char *)&header, sizeof(header));
+
+		for (size_t i = first; i < last; i++) {
+			const quadratic::Equation *equation = client->equations.records + i;
+			if (client->kind == server::SK_TEXT) {
+				output::output_printf(out, "%.21Lg %.21Lg %.21Lg\n", equation->a, equation->b, equation->c);
+			} else if (client->kind == server::SK_DOUBLE) {
+				double coefficients[3] = {(double)equation->a, (double)equation->b, (double)equation->c};
+				output::output_write(out, (const char *)coefficients, sizeof(coefficients));
+			} else {
+				long double coefficients[3] = {equation->a, equation->b, equation->c};
+				output::output_write(out, (const char *)coefficients, sizeof(coefficients));
+			}
+		}
+		if (out->failed) {
+			return 0;
+		}
+
+		header.size = out->size - header_at - sizeof(header);
+		memcpy(out->data + header_at, &header, sizeof(header));
+		client->ends[request] = out->size;
+	}
+
+	client->count = count;
+	return 1;
+}
+
+/**
+ * @brief Takes all complete answers: writes text answers as they are, results of binary answers like --batch does.
+ * @return 1 if answers are right and 0 otherwise
+ */
+static int take_answers(Client *client, output::OutputBuffer *out) {
+	output::OutputBuffer *answers = &client->answers;
+	size_t pos = 0;
+
+	while (answers->size - pos >= sizeof(server::FrameHeader)) {
+		server::FrameHeader header = {};
+		memcpy(&header, answers->data + pos, sizeof(header));
+		if (answers->size - pos - sizeof(header) < header.size)
+			break;
+
+		const char *payload = answers->data + pos + sizeof(header);
+		if (header.magic != server::SERVE_MAGIC || header.kind == server::SK_ERROR || header.id != client->answered) {
+			fprintf(stderr, "Wrong answer to request %llu: %.*s\n", (unsigned long long)header.id,
+			        (header.kind == server::SK_ERROR) ? (int)header.size : 0, payload);
+			return 0;
+		}
+
+		size_t first = client->answered * client->frame;
+		if (header.kind == server::SK_TEXT) {
+			output::output_write(out, payload, header.size);
+		} else {
+			size_t record = (header.kind == server::SK_DOUBLE) ? sizeof(server::AnswerDouble) : sizeof(server::AnswerLong);
+			for (size_t offset = 0; offset + record <= header.size; offset += record) {
+				quadratic::Equation equation = client->equations.records[first + offset / record];
+				if (header.kind == server::SK_DOUBLE) {
+					server::AnswerDouble answer = {};
+					memcpy(&answer, payload + offset, sizeof(answer));
+					equation.num_roots = answer.num_roots;
+					equation.x1 = answer.x1;
+					equation.x2 = answer.x2;
+				} else {
+					server::AnswerLong answer = {};
+					memcpy(&answer, payload + offset, sizeof(answer));
+					equation.num_roots = answer.num_roots;
+					equation.x1 = answer.x1;
+					equation.x2 = answer.x2;
+				}
+				output::write_equation(out, first + offset / record + 1, &equation, output::OF_PLAIN);
+			}
+		}
+
+		uint64_t latency = stats::stats_now() - client->sent_at[client->answered];
+		client->latency += latency;
+		client->latency_max = (latency > client->latency_max) ? latency : client->latency_max;
+		client->answered++;
+		pos += sizeof(header) + header.size;
+	}
+
+	memmove(answers->data, answers->data + pos, answers->size - pos);
+	answers->size -= pos;
+	return 1;
+}
+
+/**
+ * @brief Sends all requests and receives all answers at the same time.
+ * @return 1 if every request was answered and 0 otherwise
+ */
+static int exchange(Client *client, int fd, output::OutputBuffer *out) {
+	char *chunk = (char *)malloc(READ_CHUNK);
+	size_t request = 0;
+	if (chunk == NULL)
+		return 0;
+
+	int alive = 1;
+	while (alive && client->answered < client->count) {
+		struct pollfd polled = {fd, (short)(POLLIN | ((client->sent < client->requests.size) ? POLLOUT : 0)), 0};
+		if (poll(&polled, 1, -1) < 0) {
+			alive = errno == EINTR;
+			continue;
+		}
+
+		if (polled.revents & POLLOUT) {
+			ssize_t result = send(fd, client->requests.data + client->sent, client->requests.size - client->sent, MSG_NOSIGNAL);
+			alive = result >= 0 || errno == EAGAIN || errno == EINTR;
+			client->sent += (result > 0) ? (size_t)result : 0;
+			for (; request < client->count && client->ends[request] <= client->sent; request++) {
+				client->sent_at[request] = stats::stats_now();
+			}
+		}
+
+		if (alive && (polled.revents & (POLLIN | POLLHUP | POLLERR))) {
+			ssize_t got = recv(fd, chunk, READ_CHUNK, 0);
+			if (got > 0) {
+				output::output_write(&client->answers, chunk, (size_t)got);
+				alive = !client->answers.failed && take_answers(client, out);
+			} else {
+				alive = got < 0 && (errno == EAGAIN || errno == EINTR);
+			}
+		}
+	}
+
+	free(chunk);
+	return alive;
+}
+
+/**
+ * @brief Solves equations of a text file (or stdin) by daemon, writes results to stdout and counters to stderr.
+ * @param [in] *path  - Path of socket
+ * @param [in] *input - Name of text file or NULL for stdin
+ * @param [in] kind   - Kind of requests
+ * @param [in] frame  - Number of equations in one request
+ * @return Exit code of the program
+ */
+static int run_client(const char *path, const char *input, server::SERVE_KIND kind, size_t frame) {
+	int input_fd = (input != NULL) ? open(input, O_RDONLY) : STDIN_FILENO;
+	if (input_fd < 0) {
+		printf("Wrong name filename %s\n", input);
+		return 1;
+	}
+
+	Client client = {};
+	client.kind = kind;
+	client.frame = frame;
+	parser::parse_fd(&client.equations, input_fd, quadratic::QD_NDEBUG);
+	if (input != NULL) {
+		close(input_fd);
+	}
+
+	struct sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	output::OutputBuffer out = {};
+	int exit_code = 1;
+	if (fd < 0 || connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0) {
+		fprintf(stderr, "Unable to connect to %s: %s\n", path, strerror(errno));
+	} else if (!make_requests(&client) || !output::make_output(&client.answers, output::OUTPUT_MEMORY) ||
+	           !output::make_output(&out, STDOUT_FILENO)) {
+		fprintf(stderr, "Unable to alloc memory for requests\n");
+	} else {
+		fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+		uint64_t start = stats::stats_now();
+		int answered = exchange(&client, fd, &out);
+		double seconds = (double)(stats::stats_now() - start) * 1e-9;
+
+		exit_code = (output::free_output(&out) && answered) ? 0 : 1;
+		fprintf(stderr, "%zu requests, %zu equations, %.3f s, %.0f equations/s, latency mean %.3f ms max %.3f ms\n", client.answered,
+		        client.equations.size, seconds, (seconds > 0) ? (double)client.equations.size / seconds : 0.0,
+		        (client.answered != 0) ? (double)client.latency * 1e-6 / (double)client.answered : 0.0, (double)client.latency_max * 1e-6);
+	}
+
+	if (fd >= 0) {
+		close(fd);
+	}
+	output::free_output(&out);
+	output::free_output(&client.requests);
+	output::free_output(&client.answers);
+	free(client.ends);
+	free(client.sent_at);
+	quadratic::free_arena(&client.equations);
+	return exit_code;
+}
+
+int main(int argc, const char *argv[]) {
+	server::SERVE_KIND kind = server::SK_TEXT;
+	size_t frame = FRAME_EQUATIONS;
+
+	int arg = 1;
+	for (; arg < argc; arg++) {
+		if (strcmp(argv[arg], "--double") == 0) {
+			kind = server::SK_DOUBLE;
+		} else if (strcmp(argv[arg], "--long") == 0) {
+			kind = server::SK_LONG_DOUBLE;
+		} else if (strcmp(argv[arg], "--frame") == 0 && arg + 1 < argc) {
+			frame = strtoul(argv[++arg], NULL, 10);
+		} else {
+			break;
+		}
+	}
+
+	if (frame != 0 && (arg == argc - 1 || arg == argc - 2)) {
+		return run_client(argv[arg], (arg == argc - 2) ? argv[arg + 1] : NULL, kind, frame);
+	}
+
+	printf("Usage: %s [--double | --long] [--frame equations] socket [input.txt]\n", argv[0]);
+	return 1;
+}
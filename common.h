@@ -17,7 +17,7 @@
 #define ASSERTIF(cond, desc, val)
 #endif
 
-const double EPS  = 1e-7;
+constexpr double EPS = 1e-7;
 
 /**
  * @brief  Used colors (obvious).
@@ -0,0 +1,292 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <thread>
+#include <new>
+#include <zlib.h>
+#ifdef QE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "common.h"
+#include "compressed.h"
+
+namespace compressed {
+    /// Magic bytes of gzip member and zstd frame.
+    static const unsigned char GZIP_MAGIC[] = {0x1f, 0x8b};
+    static const unsigned char ZSTD_MAGIC[] = {0x28, 0xb5, 0x2f, 0xfd};
+
+    /// Size of send buffer of decompressor's socket: a few chunks are ready while parser works.
+    static const int SOCKET_BUFFER = 4 * (int)DECOMPRESS_CHUNK;
+
+    /// Number of first bytes of file read to detect compression.
+    static const size_t MAGIC_LENGTH = 8;
+
+    /// gzip header and maximal window of zlib (look inflateInit2).
+    static const int GZIP_WINDOW = 15 + 16;
+
+    /**
+     * @brief Thread which decompresses file into socket.
+     * @param thread      - Thread of decompress
+     * @param file        - Compressed file, closed by thread
+     * @param socket      - End of socket pair to write text, closed by thread, so reader gets end of file
+     * @param compression - Compression of file
+     * @param failed      - 1 if data is damaged or truncated (read after join)
+     */
+    struct Decompressor {
+        std::thread thread = std::thread();
+        int file = -1, socket = -1;
+        COMPRESSION compression = CF_NONE;
+        int failed = 0;
+    };
+
+    /**
+     * @brief Reads up to size bytes, repeating read(2) if it was interrupted.
+     * @return number of read bytes, 0 at end of file or -1 on error
+     */
+    static ssize_t read_chunk(int fd, unsigned char *data, size_t size);
+
+    /**
+     * @brief Sends all size bytes of data to socket without SIGPIPE.
+     * @return 1 if everything was sent and 0 if reader has closed its end
+     */
+    static int send_all(int socket, const unsigned char *data, size_t size);
+
+    /**
+     * @brief Decompresses gzip members from file into socket by zlib.
+     * @return 1 if file ended right after a whole member or reader stopped reading, 0 otherwise
+     */
+    static int inflate_gzip(int file, int socket, unsigned char *in, unsigned char *out);
+
+#ifdef QE_ZSTD
+    /**
+     * @brief Decompresses zstd frames from file into socket by libzstd.
+     * @return 1 if file ended right after a whole frame or reader stopped reading, 0 otherwise
+     */
+    static int decompress_zstd(int file, int socket, unsigned char *in, unsigned char *out);
+#endif
+
+    /**
+     * @brief Body of decompressor thread.
+     */
+    static void decompress(Decompressor *decompressor);
+
+    static ssize_t read_chunk(int fd, unsigned char *data, size_t size) {
+        ssize_t result = 0;
+        do {
+            result = read(fd, data, size);
+        } while (result < 0 && errno == EINTR);
+        return result;
+    }
+
+    static int send_all(int socket, const unsigned char *data, size_t size) {
+        size_t sent = 0;
+        while (sent < size) {
+            ssize_t result = send(socket, data + sent, size - sent, MSG_NOSIGNAL);
+            if (result < 0 && errno == EINTR)
+                continue;
+            if (result <= 0)
+                return 0;
+            sent += (size_t)result;
+        }
+        return 1;
+    }
+
+    static int inflate_gzip(int file, int socket, unsigned char *in, unsigned char *out) {
+        z_stream stream = {};
+        if (inflateInit2(&stream, GZIP_WINDOW) != Z_OK)
+            return 0;
+
+        // A member is complete when inflate returns Z_STREAM_END, the next member starts after inflateReset.
+        int complete = 0, result = Z_OK;
+        ssize_t got = 1;
+        for (;;) {
+            // More input is read only when previous output wasn't cut by the end of out.
+            if (stream.avail_in == 0 && stream.avail_out != 0) {
+                got = read_chunk(file, in, DECOMPRESS_CHUNK);
+                if (got <= 0)
+                    break;
+                stream.next_in = in;
+                stream.avail_in = (uInt)got;
+            }
+
+            stream.next_out = out;
+            stream.avail_out = (uInt)DECOMPRESS_CHUNK;
+            result = inflate(&stream, Z_NO_FLUSH);
+            if (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR)
+                break;
+
+            complete = result == Z_STREAM_END || (complete && stream.total_in == 0);
+            if (!send_all(socket, out, DECOMPRESS_CHUNK - stream.avail_out)) {
+                inflateEnd(&stream);
+                return 1;
+            }
+            if (result == Z_STREAM_END && inflateReset(&stream) != Z_OK)
+                break;
+        }
+
+        inflateEnd(&stream);
+        return got == 0 && complete;
+    }
+
+#ifdef QE_ZSTD
+    static int decompress_zstd(int file, int socket, unsigned char *in, unsigned char *out) {
+        ZSTD_DStream *stream = ZSTD_createDStream();
+        if (stream == NULL || ZSTD_isError(ZSTD_initDStream(stream))) {
+            ZSTD_freeDStream(stream);
+            return 0;
+        }
+
+        // ZSTD_decompressStream returns 0 when a frame is complete and flushed, the next frame continues in the same stream.
+        ZSTD_inBuffer input = {in, 0, 0};
+        ZSTD_outBuffer output = {out, DECOMPRESS_CHUNK, 0};
+        size_t result = 0;
+        ssize_t got = 1;
+        for (;;) {
+            if (input.pos == input.size && output.pos != output.size) {
+                got = read_chunk(file, in, DECOMPRESS_CHUNK);
+                if (got <= 0)
+                    break;
+                input = {in, (size_t)got, 0};
+            }
+
+            output.pos = 0;
+            result = ZSTD_decompressStream(stream, &output, &input);
+            if (ZSTD_isError(result))
+                break;
+            if (!send_all(socket, out, output.pos)) {
+                ZSTD_freeDStream(stream);
+                return 1;
+            }
+        }
+
+        ZSTD_freeDStream(stream);
+        return got == 0 && result == 0;
+    }
+#endif
+
+    static void decompress(Decompressor *decompressor) {
+        unsigned char *in = (unsigned char *)malloc(DECOMPRESS_CHUNK), *out = (unsigned char *)malloc(DECOMPRESS_CHUNK);
+        int complete = 0;
+        if (in != NULL && out != NULL) {
+            switch (decompressor->compression) {
+            case CF_GZIP:
+                complete = inflate_gzip(decompressor->file, decompressor->socket, in, out);
+                break;
+            case CF_ZSTD:
+#ifdef QE_ZSTD
+                complete = decompress_zstd(decompressor->file, decompressor->socket, in, out);
+#endif
+                break;
+            case CF_NONE:
+            default:
+                break;
+            }
+        }
+        free(in);
+        free(out);
+
+        decompressor->failed = !complete;
+        close(decompressor->file);
+        close(decompressor->socket);
+    }
+
+    COMPRESSION detect_compression(int fd) {
+        unsigned char magic[MAGIC_LENGTH] = {};
+        ssize_t got = pread(fd, magic, sizeof(magic), 0);
+        if (got >= (ssize_t)sizeof(GZIP_MAGIC) && memcmp(magic, GZIP_MAGIC, sizeof(GZIP_MAGIC)) == 0)
+            return CF_GZIP;
+        if (got >= (ssize_t)sizeof(ZSTD_MAGIC) && memcmp(magic, ZSTD_MAGIC, sizeof(ZSTD_MAGIC)) == 0)
+            return CF_ZSTD;
+        return CF_NONE;
+    }
+
+    int open_input(Input *input, const char *name) {
+        ASSERTIF(input != NULL, "nullptr in input", 0);
+        ASSERTIF(name  != NULL, "nullptr in name",  0);
+
+        *input = {-1, CF_NONE, NULL, NULL};
+        int file = open(name, O_RDONLY | O_CLOEXEC);
+        if (file < 0)
+            return 0;
+
+        input->compression = detect_compression(file);
+        if (input->compression == CF_NONE) {
+            input->fd = file;
+            return 1;
+        }
+#ifndef QE_ZSTD
+        if (input->compression == CF_ZSTD) {
+            close(file);
+            input->error = "compressed by zstd, but the program is built without libzstd";
+            return 0;
+        }
+#endif
+
+        int sockets[2] = {-1, -1};
+        Decompressor *decompressor = NULL;
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) != 0 ||
+            (decompressor = new (std::nothrow) Decompressor()) == NULL) {
+            close(file);
+            if (sockets[0] >= 0) {
+                close(sockets[0]);
+                close(sockets[1]);
+            }
+            input->error = "unable to start decompressor";
+            return 0;
+        }
+        setsockopt(sockets[1], SOL_SOCKET, SO_SNDBUF, &SOCKET_BUFFER, sizeof(SOCKET_BUFFER));
+
+        decompressor->file = file;
+        decompressor->socket = sockets[1];
+        decompressor->compression = input->compression;
+        decompressor->thread = std::thread(decompress, decompressor);
+
+        input->fd = sockets[0];
+        input->decompressor = decompressor;
+        return 1;
+    }
+
+    FILE *input_stream(Input *input) {
+        ASSERTIF(input != NULL, "nullptr in input", NULL);
+
+        return (input->fd >= 0) ? fdopen(input->fd, "r") : NULL;
+    }
+
+    int close_input(Input *input, FILE *stream) {
+        ASSERTIF(input != NULL, "nullptr in input", 0);
+
+        if (stream != NULL) {
+            fclose(stream);
+        } else if (input->fd >= 0) {
+            close(input->fd);
+        }
+        input->fd = -1;
+
+        int complete = 1;
+        if (input->decompressor != NULL) {
+            input->decompressor->thread.join();
+            complete = !input->decompressor->failed;
+            delete input->decompressor;
+            input->decompressor = NULL;
+        }
+        return complete;
+    }
+
+    const char *compression_name(COMPRESSION compression) {
+        switch (compression) {
+        case CF_NONE:
+            return "text";
+        case CF_GZIP:
+            return "gzip";
+        case CF_ZSTD:
+            return "zstd";
+        default:
+            return "unknown";
+        }
+    }
+}
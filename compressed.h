@@ -0,0 +1,75 @@
+#ifndef COMPRESSED_DEF
+#define COMPRESSED_DEF
+
+#include <stdio.h>
+
+/**
+ * @brief   This namespace includes reading of compressed text files given by -f and -t flags.
+ * @details Compression is detected by magic bytes at the beginning of file, so names don't matter. A compressed file is
+ * decompressed by its own thread into one end of a socket pair, and the parser reads text from the other end by read(2) like from
+ * a pipe: decompression, parsing and solving (in --stream mode) overlap, and nothing is written to disk. gzip is read by zlib
+ * (concatenated members too), zstd by libzstd if the program is built with it (QE_ZSTD, look Makefile). Only regular files are
+ * checked for magic bytes, pipes are read as text.
+ */
+namespace compressed {
+    /// Size of chunks of compressed and decompressed data of decompressor.
+    const size_t DECOMPRESS_CHUNK = 1 << 18;
+
+    /// Enumerated type of data with detected compressions.
+    typedef enum {
+        CF_NONE, ///< Text
+        CF_GZIP, ///< gzip (1f 8b)
+        CF_ZSTD  ///< zstd frame (28 b5 2f fd)
+    } COMPRESSION;
+
+    struct Decompressor;
+
+    /**
+     * @brief An opened input file.
+     * @param fd           - Descriptor to read text from: the file itself or the socket of decompressor
+     * @param compression  - Compression of file
+     * @param decompressor - Thread which decompresses file (NULL for text)
+     * @param error        - Reason why file can't be read (NULL if it was opened)
+     */
+    typedef struct {
+        int fd;
+        COMPRESSION compression;
+        Decompressor *decompressor;
+        const char *error;
+    } Input;
+
+    /**
+     * @brief Returns compression of file by its first bytes, CF_NONE if they can't be read by pread(2).
+     */
+    COMPRESSION detect_compression(int fd);
+
+    /**
+     * @brief Opens file for reading text and starts its decompressor if it is compressed.
+     * @param [out] *input - Opened input
+     * @param [in]  *name  - Name of file
+     * @return 1 if file was opened and 0 otherwise (input->error is set if file exists but can't be read)
+     */
+    int open_input(Input *input, const char *name);
+
+    /**
+     * @brief Makes FILE of input->fd, it is closed by close_input.
+     * @return FILE or NULL if it can't be made
+     */
+    FILE *input_stream(Input *input);
+
+    /**
+     * @brief Closes input (and its FILE if stream is not NULL) and waits for decompressor.
+     * @details Descriptor is closed before waiting, so decompressor which wasn't read to the end stops at once.
+     * @param [in, out] *input  - Input of open_input
+     * @param [in]      *stream - FILE of input_stream or NULL
+     * @return 1 if the whole file was read or decompressed and 0 if compressed data is damaged or truncated
+     */
+    int close_input(Input *input, FILE *stream = NULL);
+
+    /**
+     * @brief Returns printable name of compression.
+     */
+    const char *compression_name(COMPRESSION compression);
+}
+
+#endif
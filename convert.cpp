@@ -0,0 +1,105 @@
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "quadratic.h"
+#include "common.h"
+#include "arena.h"
+#include "parser.h"
+#include "output.h"
+#include "binary.h"
+
+/**
+ * @brief Converts a text file (input.txt or test.txt style) to binary format.
+ * @param [in] *input     - Name of text file
+ * @param [in] *output    - Name of binary file
+ * @param [in] test       - QD_DEBUG for 6 numbers in a group, QD_NDEBUG for 3
+ * @param [in] precision  - Precision of numbers in binary file
+ * @return Exit code of the program
+ */
+static int to_binary(const char *input, const char *output, quadratic::QUADRATIC_DEBUG test, binary::BINARY_PRECISION precision) {
+	FILE *stream = fopen(input, "r");
+	if (stream == NULL) {
+		printf("Wrong name filename %s\n", input);
+		return 1;
+	}
+
+	quadratic::EquationArena equations = {};
+	parser::parse_stream(&equations, stream, test);
+	fclose(stream);
+
+	int written = binary::write_binary(output, equations.records, equations.size, precision, test == quadratic::QD_DEBUG);
+	printf("%zu equations written to %s\n", equations.size, output);
+	quadratic::free_arena(&equations);
+	return written ? 0 : 1;
+}
+
+/**
+ * @brief Converts a binary file to text: 3 numbers in a line, or 6 numbers like test.txt if the file has roots.
+ * @param [in] *input  - Name of binary file
+ * @param [in] *output - Name of text file
+ * @return Exit code of the program
+ */
+static int to_text(const char *input, const char *output) {
+	binary::BinaryFile file = {};
+	if (!binary::open_binary(&file, input)) {
+		return 1;
+	}
+
+	int fd = open(output, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	output::OutputBuffer out = {};
+	if (fd < 0 || !output::make_output(&out, fd)) {
+		printf("Unable to create %s\n", output);
+		binary::close_binary(&file);
+		return 1;
+	}
+
+	quadratic::EquationArena equations = {};
+	binary::binary_input(&equations, &file);
+	int with_roots = file.header->flags & binary::BF_ROOTS;
+	binary::close_binary(&file);
+
+	for (size_t i = 0; i < equations.size; i++) {
+		const quadratic::Equation *equation = equations.records + i;
+		if (with_roots) {
+			output::output_printf(&out, "%.21Lg %.21Lg %.21Lg %d %.21Lg %.21Lg\n", equation->a, equation->b, equation->c,
+			                      equation->num_roots, equation->x1, equation->x2);
+		} else {
+			output::output_printf(&out, "%.21Lg %.21Lg %.21Lg\n", equation->a, equation->b, equation->c);
+		}
+	}
+
+	int written = output::free_output(&out);
+	close(fd);
+	printf("%zu equations written to %s\n", equations.size, output);
+	quadratic::free_arena(&equations);
+	return written ? 0 : 1;
+}
+
+int main(int argc, const char *argv[]) {
+	if (argc >= 4 && strcmp(argv[1], "to-binary") == 0) {
+		quadratic::QUADRATIC_DEBUG test = quadratic::QD_NDEBUG;
+		binary::BINARY_PRECISION precision = binary::BP_LONG_DOUBLE;
+
+		int arg = 2;
+		for (; arg < argc - 2; arg++) {
+			if (strcmp(argv[arg], "--tests") == 0) {
+				test = quadratic::QD_DEBUG;
+			} else if (strcmp(argv[arg], "--double") == 0) {
+				precision = binary::BP_DOUBLE;
+			} else {
+				break;
+			}
+		}
+		if (arg == argc - 2) {
+			return to_binary(argv[arg], argv[arg + 1], test, precision);
+		}
+	} else if (argc == 4 && strcmp(argv[1], "to-text") == 0) {
+		return to_text(argv[2], argv[3]);
+	}
+
+	printf("Usage: %s to-binary [--tests] [--double] input.txt output.bin\n"
+	       "       %s to-text input.bin output.txt\n", argv[0], argv[0]);
+	return 1;
+}
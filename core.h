@@ -0,0 +1,111 @@
+#ifndef CORE_DEF
+#define CORE_DEF
+
+#include <stdio.h>
+
+#include "common.h"
+#include "quadratic.h"
+
+/**
+ * @brief   Header-only solver core: constexpr, noexcept, without allocations, asserts, printf and errno.
+ * @details solve_core has the same branches and the same absolute zero test (|val| < EPS) as solve_equation, so it gives bit-identical
+ * roots, but it can be inlined into loops of callers and evaluated at compile time (for example, to build tables). It doesn't check its
+ * arguments: validation is made by solve_core_checked and diagnostics by solve_equation, which is a checked wrapper over solve_core.
+ * The zero test is a template parameter (a tolerance policy, look AbsoluteTolerance), so solve_equation<T, Tolerance> of precision.h
+ * solves every type by the same code.
+ */
+namespace quadratic {
+    /**
+     * @brief Result of solve_core.
+     * @param num_roots - Number of roots (look ROOT_NUMBER) or QE_QUAD_ERROR
+     * @param x1, x2    - Roots, 0 if they don't exist
+     */
+    template <typename T>
+    struct CoreRoots {
+        int num_roots;
+        T x1, x2;
+    };
+
+    /// Functions of math.h which are constexpr (builtins are evaluated at compile time by g++).
+    constexpr float       core_sqrt(float val)       noexcept { return __builtin_sqrtf(val); }
+    constexpr double      core_sqrt(double val)      noexcept { return __builtin_sqrt(val);  }
+    constexpr long double core_sqrt(long double val) noexcept { return __builtin_sqrtl(val); }
+    constexpr __float128  core_sqrt(__float128 val)  noexcept { return __builtin_sqrtf128(val); }
+
+    template <typename T>
+    constexpr int core_finite(T val) noexcept { return __builtin_isfinite(val); }
+
+    /// Zero test of common::is_zero for every type.
+    template <typename T>
+    constexpr T core_abs(T val) noexcept { return (val < 0) ? -val : val; }
+
+    template <typename T>
+    constexpr T core_max(T first, T second) noexcept { return (first < second) ? second : first; }
+
+    template <typename T>
+    constexpr int core_is_zero(T val) noexcept { return core_abs(val) < (T)EPS; }
+
+    /**
+     * @brief   Tolerance policy of solve_core: absolute zero test |val| < EPS, same as common::is_zero.
+     * @details A policy has static is_zero(val, scale), where scale is the largest of |a|, |b|, |c| for coefficients and the largest of
+     * b ^ 2 and |4 * a * c| for discriminant. The absolute test ignores scale, so it is not computed when solve_core is inlined.
+     */
+    template <typename T>
+    struct AbsoluteTolerance {
+        static constexpr T EPS = (T)::EPS;
+
+        static constexpr int is_zero(T val, T) noexcept { return core_is_zero(val); }
+    };
+
+    /**
+     * @brief Solves a quadratic equation a * x ^ 2 + b * x + c = 0.
+     * @details Coefficients must be finite (look solve_core_checked). Zero tests are made by Tolerance::is_zero.
+     * @return number of roots and roots
+     */
+    template <typename T, typename Tolerance = AbsoluteTolerance<T>>
+    constexpr CoreRoots<T> solve_core(T a, T b, T c) noexcept {
+        const T scale = core_max(core_abs(a), core_max(core_abs(b), core_abs(c)));
+
+        if (Tolerance::is_zero(a, scale)) {
+            if (Tolerance::is_zero(b, scale)) {
+                return {Tolerance::is_zero(c, scale) ? RN_INF : RN_ZERO, 0, 0};
+            }
+            return {RN_ONE, -c / b, 0};
+        }
+
+        T discriminant = b * b - 4 * a * c;
+        if (discriminant < 0)
+            return {RN_ZERO, 0, 0};
+
+        if (Tolerance::is_zero(discriminant, core_max(b * b, core_abs(4 * a * c))))
+            return {RN_ONE, -b / (2 * a), 0};
+
+        discriminant = core_sqrt(discriminant);
+        return {RN_TWO, (-b + discriminant) / (2 * a), (-b - discriminant) / (2 * a)};
+    }
+
+    /**
+     * @brief Same as solve_core, but num_roots is QE_QUAD_ERROR if a coefficient is not finite.
+     */
+    template <typename T, typename Tolerance = AbsoluteTolerance<T>>
+    constexpr CoreRoots<T> solve_core_checked(T a, T b, T c) noexcept {
+        if (!core_finite(a) || !core_finite(b) || !core_finite(c))
+            return {QE_QUAD_ERROR, 0, 0};
+        return solve_core<T, Tolerance>(a, b, c);
+    }
+
+    /**
+     * @brief Writes result of solve_core to equation like solve_equation: roots which don't exist are not changed.
+     * @return roots.num_roots, you must make equation->num_roots equal to this value
+     */
+    template <typename T>
+    constexpr int store_roots(BasicEquation<T> *equation, const CoreRoots<T> &roots) noexcept {
+        if (roots.num_roots == RN_ONE || roots.num_roots == RN_TWO)
+            equation->x1 = roots.x1;
+        if (roots.num_roots == RN_TWO)
+            equation->x2 = roots.x2;
+        return roots.num_roots;
+    }
+}
+
+#endif
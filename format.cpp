@@ -0,0 +1,530 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+
+#include "common.h"
+#include "format.h"
+
+static_assert(LDBL_MANT_DIG == 64, "format_number needs 80-bit long double with 64-bit mantissa");
+
+namespace format {
+    typedef unsigned __int128 uint128;
+
+    /// Bias of exponent of long double and exponent of infinities and NaN.
+    static const int EXPONENT_BIAS = 16383;
+    static const int EXPONENT_MAX  = 0x7fff;
+
+    /// Powers of 10 up to 10 ^ EXACT_POWER are exact in long double.
+    static const int EXACT_POWER = 27;
+
+    /// Distance from a tie under which NF_FIXED leaves rounding to snprintf: error of scaling by powers of 10 is below 1e-11.
+    static const long double FIXED_TIE = 1e-9L;
+
+    /// Cached powers of NF_SHORTEST are 10 ^ -POWER_RANGE .. 10 ^ POWER_RANGE, other numbers go to snprintf.
+    static const int POWER_RANGE = 350;
+
+    /// Number of fractional bits of fixed-point numbers of NF_SHORTEST.
+    static const int FRACTION_BITS = 50;
+
+    /// Error bound of fixed-point numbers of NF_SHORTEST in their last bits: truncation of cached powers and of products.
+    static const uint128 SHORTEST_MARGIN = 1 << 10;
+
+    /// 10 ^ 19, the largest power of 10 in 64 bits.
+    static const uint64_t DIGITS_19 = 10000000000000000000ULL;
+
+    /// log10(2) to estimate decimal exponent by binary one.
+    static const double LOG10_2 = 0.30102999566398119521;
+
+    /**
+     * @brief Fields of a long double: value = mantissa * 2 ^ (exponent - EXPONENT_BIAS - 63).
+     * @param mantissa - Mantissa with explicit integer bit
+     * @param exponent - Biased exponent, 0 for zero and subnormal numbers, EXPONENT_MAX for infinities and NaN
+     * @param negative - Sign bit
+     */
+    typedef struct {
+        uint64_t mantissa;
+        int exponent;
+        int negative;
+    } Parts;
+
+    /**
+     * @brief Significant digits of a number: value = digits[0].digits[1]digits[2]... * 10 ^ exponent.
+     */
+    typedef struct {
+        char digits[SHORTEST_DIGITS + 3];
+        int count;
+        int exponent;
+    } Decimal;
+
+    /**
+     * @brief A cached power of 10: 10 ^ k = mantissa * 2 ^ exponent, mantissa has the highest bit set.
+     */
+    typedef struct {
+        uint128 mantissa;
+        int exponent;
+    } Power;
+
+    /**
+     * @brief Splits value into fields.
+     */
+    static Parts split(long double value);
+
+    /**
+     * @brief Multiplies x by 10 ^ k in long double by exact powers of 10 (one rounding for every 27 orders).
+     */
+    static long double scale(long double x, int k);
+
+    /**
+     * @brief Writes exponent of %e like printf: 'e', sign and at least 2 digits.
+     * @return number of written characters
+     */
+    static size_t write_exponent(char *text, int exponent);
+
+    /**
+     * @brief Writes digits of decimal like printf("%+.PLg"): %e if exponent < -4 or exponent >= precision, %f otherwise, without trailing zeros.
+     * @return number of written characters
+     */
+    static size_t write_general(char *text, int negative, Decimal *decimal, int precision);
+
+    /**
+     * @brief Rounds a normal number to FIXED_DIGITS significant digits.
+     * @return 1 if digits are sure and 0 if number is too close to a tie
+     */
+    static int fixed_decimal(const Parts *parts, long double value, Decimal *decimal);
+
+    /**
+     * @brief Computes 10 ^ -POWER_RANGE .. 10 ^ POWER_RANGE, multiplying and dividing 1 by 10 with truncation to 128 bits.
+     */
+    static void fill_powers(Power *powers);
+
+    /**
+     * @brief Returns cached 10 ^ k, the table is filled on the first call.
+     */
+    static const Power *cached_power(int k);
+
+    /**
+     * @brief Computes 10 ^ j as fixed-point numbers of NF_SHORTEST for j = 0 .. SHORTEST_DIGITS + 2.
+     */
+    static void fill_steps(uint128 *steps);
+
+    /**
+     * @brief Returns table of fill_steps, the table is filled on the first call.
+     */
+    static const uint128 *decimal_steps();
+
+    /**
+     * @brief Multiplies two 128-bit numbers into 256 bits.
+     */
+    static void multiply(uint128 a, uint128 b, uint128 *high, uint128 *low);
+
+    /**
+     * @brief Computes n * 2 ^ exponent * 10 ^ k as a fixed-point number with FRACTION_BITS fractional bits.
+     * @return 1 if it fits into 128 bits and 0 otherwise
+     */
+    static int scale_fixed(uint128 n, int exponent, const Power *power, uint128 *fixed);
+
+    /**
+     * @brief Finds the shortest correctly rounded digits of a normal number which are inside its rounding interval.
+     * @param [in]  *parts     - Number
+     * @param [out] *decimal   - Digits
+     * @param [out] *precision - Number of significant digits or, if it can't be decided, the least number of digits which is still possible
+     * @return 1 if digits are found and 0 if it can't be decided in 128 bits
+     */
+    static int shortest_decimal(const Parts *parts, Decimal *decimal, int *precision);
+
+    /**
+     * @brief Writes a normal number like printf("%+La").
+     * @return number of written characters
+     */
+    static size_t format_hex(char *text, const Parts *parts);
+
+    /**
+     * @brief Writes value in mode by snprintf, precision of NF_SHORTEST is searched from precision.
+     * @return number of written characters
+     */
+    static size_t format_printf(char *text, long double value, NUMBER_FORMAT mode, int width, int precision);
+
+    static Parts split(long double value) {
+        unsigned char bytes[sizeof(long double)] = {};
+        memcpy(bytes, &value, sizeof(bytes));
+
+        uint64_t mantissa = 0;
+        uint16_t top = 0;
+        memcpy(&mantissa, bytes, sizeof(mantissa));
+        memcpy(&top, bytes + sizeof(mantissa), sizeof(top));
+        return {mantissa, top & EXPONENT_MAX, top >> 15};
+    }
+
+    static long double scale(long double x, int k) {
+        static const long double POWERS[EXACT_POWER + 1] = {
+            1e0L,  1e1L,  1e2L,  1e3L,  1e4L,  1e5L,  1e6L,  1e7L,  1e8L,  1e9L,  1e10L, 1e11L, 1e12L, 1e13L,
+            1e14L, 1e15L, 1e16L, 1e17L, 1e18L, 1e19L, 1e20L, 1e21L, 1e22L, 1e23L, 1e24L, 1e25L, 1e26L, 1e27L
+        };
+
+        for (; k > EXACT_POWER; k -= EXACT_POWER) {
+            x *= POWERS[EXACT_POWER];
+        }
+        for (; k < -EXACT_POWER; k += EXACT_POWER) {
+            x /= POWERS[EXACT_POWER];
+        }
+        return (k >= 0) ? x * POWERS[k] : x / POWERS[-k];
+    }
+
+    static size_t write_exponent(char *text, int exponent) {
+        size_t pos = 0;
+        text[pos++] = 'e';
+        text[pos++] = (exponent < 0) ? '-' : '+';
+
+        unsigned value = (unsigned)abs(exponent);
+        char digits[8] = {};
+        int count = 0;
+        do {
+            digits[count++] = (char)('0' + value % 10);
+            value /= 10;
+        } while (value != 0 || count < 2);
+
+        while (count > 0) {
+            text[pos++] = digits[--count];
+        }
+        return pos;
+    }
+
+    static size_t write_general(char *text, int negative, Decimal *decimal, int precision) {
+        const char *digits = decimal->digits;
+        int count = decimal->count, exponent = decimal->exponent;
+        for (; count > 1 && digits[count - 1] == '0'; --count);
+
+        size_t pos = 0;
+        text[pos++] = negative ? '-' : '+';
+        if (exponent < -4 || exponent >= precision) {
+            text[pos++] = digits[0];
+            if (count > 1) {
+                text[pos++] = '.';
+                memcpy(text + pos, digits + 1, (size_t)(count - 1));
+                pos += (size_t)(count - 1);
+            }
+            return pos + write_exponent(text + pos, exponent);
+        }
+
+        if (exponent >= 0) {
+            for (int i = 0; i <= exponent; ++i) {
+                text[pos++] = (i < count) ? digits[i] : '0';
+            }
+            if (count > exponent + 1) {
+                text[pos++] = '.';
+                memcpy(text + pos, digits + exponent + 1, (size_t)(count - exponent - 1));
+                pos += (size_t)(count - exponent - 1);
+            }
+            return pos;
+        }
+
+        text[pos++] = '0';
+        text[pos++] = '.';
+        for (int i = 0; i < -exponent - 1; ++i) {
+            text[pos++] = '0';
+        }
+        memcpy(text + pos, digits, (size_t)count);
+        return pos + (size_t)count;
+    }
+
+    static int fixed_decimal(const Parts *parts, long double value, Decimal *decimal) {
+        long double x = fabsl(value);
+        int exponent = (int)floor((double)(parts->exponent - EXPONENT_BIAS) * LOG10_2);
+
+        // x >= 2 ^ e >= 10 ^ exponent, so y is 5 digits before the point or 6 if exponent is one less than decimal exponent of x.
+        long double y = scale(x, FIXED_DIGITS - 1 - exponent);
+        if (y >= 1e5L) {
+            y = scale(x, FIXED_DIGITS - 1 - ++exponent);
+        } else if (y < 1e4L) {
+            y = scale(x, FIXED_DIGITS - 1 - --exponent);
+        }
+
+        uint64_t number = (uint64_t)y;
+        long double fraction = y - (long double)number;
+        if (fabsl(fraction - 0.5L) < FIXED_TIE)
+            return 0;
+
+        number += fraction > 0.5L;
+        if (number == 100000) {
+            number = 10000;
+            exponent++;
+        }
+
+        for (int i = FIXED_DIGITS - 1; i >= 0; --i) {
+            decimal->digits[i] = (char)('0' + number % 10);
+            number /= 10;
+        }
+        decimal->count = FIXED_DIGITS;
+        decimal->exponent = exponent;
+        return 1;
+    }
+
+    static void fill_powers(Power *powers) {
+        powers[POWER_RANGE] = {(uint128)1 << 127, -127};
+
+        for (int k = 1; k <= POWER_RANGE; ++k) {
+            const Power *previous = powers + POWER_RANGE + k - 1;
+            uint128 high = 0, low = 0;
+            multiply(previous->mantissa, 10, &high, &low);
+
+            // Product is in [10 * 2 ^ 127, 10 * 2 ^ 128), so high is in [5, 10).
+            int shift = (high >= 8) ? 4 : 3;
+            powers[POWER_RANGE + k] = {(high << (128 - shift)) | (low >> shift), previous->exponent + shift};
+        }
+
+        for (int k = 1; k <= POWER_RANGE; ++k) {
+            const Power *previous = powers + POWER_RANGE - k + 1;
+            uint128 quotient = previous->mantissa / 10, remainder = previous->mantissa % 10;
+
+            // floor(mantissa * 2 ^ shift / 10) with the highest bit set.
+            int shift = 3;
+            uint128 mantissa = (quotient << shift) + (remainder << shift) / 10;
+            if ((mantissa >> 127) == 0) {
+                shift = 4;
+                mantissa = (quotient << shift) + (remainder << shift) / 10;
+            }
+            powers[POWER_RANGE - k] = {mantissa, previous->exponent - shift};
+        }
+    }
+
+    static const Power *cached_power(int k) {
+        static Power powers[2 * POWER_RANGE + 1] = {};
+        static const int filled = (fill_powers(powers), 1);
+        (void)filled;
+
+        return powers + POWER_RANGE + k;
+    }
+
+    static void fill_steps(uint128 *steps) {
+        steps[0] = (uint128)1 << FRACTION_BITS;
+        for (int j = 1; j < SHORTEST_DIGITS + 3; ++j) {
+            steps[j] = steps[j - 1] * 10;
+        }
+    }
+
+    static const uint128 *decimal_steps() {
+        static uint128 steps[SHORTEST_DIGITS + 3] = {};
+        static const int filled = (fill_steps(steps), 1);
+        (void)filled;
+
+        return steps;
+    }
+
+    static void multiply(uint128 a, uint128 b, uint128 *high, uint128 *low) {
+        uint64_t a0 = (uint64_t)a, a1 = (uint64_t)(a >> 64), b0 = (uint64_t)b, b1 = (uint64_t)(b >> 64);
+        uint128 p00 = (uint128)a0 * b0, p01 = (uint128)a0 * b1, p10 = (uint128)a1 * b0, p11 = (uint128)a1 * b1;
+
+        uint128 middle = (p00 >> 64) + (uint64_t)p01 + (uint64_t)p10;
+        *low  = (middle << 64) | (uint64_t)p00;
+        *high = p11 + (p01 >> 64) + (p10 >> 64) + (middle >> 64);
+    }
+
+    static int scale_fixed(uint128 n, int exponent, const Power *power, uint128 *fixed) {
+        uint128 high = 0, low = 0;
+        multiply(n, power->mantissa, &high, &low);
+
+        int shift = -(exponent + power->exponent + FRACTION_BITS);
+        if (shift <= 0 || shift >= 128 || (high >> shift) != 0)
+            return 0;
+
+        *fixed = (high << (128 - shift)) | (low >> shift);
+        return 1;
+    }
+
+    static int shortest_decimal(const Parts *parts, Decimal *decimal, int *precision) {
+        // x = 4 * mantissa * 2 ^ (e - 2), bounds of its rounding interval are halfway to neighbours (a quarter below a power of 2).
+        int binary = parts->exponent - EXPONENT_BIAS - 63;
+        int k = SHORTEST_DIGITS - (int)floor((double)(parts->exponent - EXPONENT_BIAS) * LOG10_2);
+        if (k < -POWER_RANGE || k > POWER_RANGE)
+            return 0;
+
+        const Power *power = cached_power(k);
+        uint128 four = (uint128)parts->mantissa << 2;
+        uint128 below = (parts->mantissa == (1ULL << 63) && parts->exponent > 1) ? four - 1 : four - 2;
+        uint128 value = 0, upper = 0, lower = 0;
+        if (!scale_fixed(four, binary - 2, power, &value) || !scale_fixed(four + 2, binary - 2, power, &upper) ||
+            !scale_fixed(below, binary - 2, power, &lower))
+            return 0;
+
+        // value = x * 10 ^ k is in [10 ^ 21, 10 ^ 23): its integer part has 22 or 23 digits, 19 low ones fit into 64 bits.
+        uint128 whole = value >> FRACTION_BITS;
+        unsigned high = (unsigned)(whole / DIGITS_19);
+        uint64_t low = (uint64_t)(whole - (uint128)high * DIGITS_19);
+        char all[SHORTEST_DIGITS + 3] = {};
+        int digits = (high >= 1000) ? 4 : 3;
+        for (int i = digits - 1; i >= 0; --i, high /= 10) {
+            all[i] = (char)('0' + high % 10);
+        }
+        for (int i = digits + 18; i >= digits; --i, low /= 10) {
+            all[i] = (char)('0' + (int)(low % 10));
+        }
+        digits += 19;
+
+        // Gaps from value to the widened bounds: while both neighbours of value with count digits are beyond them, no checks are needed.
+        const uint128 *steps = decimal_steps();
+        uint128 truncated = 0, gap_below = value - lower + SHORTEST_MARGIN, gap_above = upper - value + SHORTEST_MARGIN;
+        for (int count = 1; count <= SHORTEST_DIGITS; ++count) {
+            // truncated is value cut to count digits, step is a unit of its last digit.
+            uint128 step = steps[digits - count];
+            truncated += (uint128)(unsigned char)(all[count - 1] - '0') * step;
+            uint128 rest = value - truncated, half = step / 2;
+            if (rest > gap_below && step - rest > gap_above)
+                continue;
+
+            *precision = count;
+            if (rest + SHORTEST_MARGIN >= half && rest <= half + SHORTEST_MARGIN)
+                return 0;
+            int up = rest > half;
+            uint128 rounded = truncated + (up ? step : 0);
+
+            if (rounded + SHORTEST_MARGIN >= lower && rounded <= upper + SHORTEST_MARGIN &&
+                (rounded <= lower + SHORTEST_MARGIN || rounded + SHORTEST_MARGIN >= upper))
+                return 0;
+            if (rounded <= lower || rounded >= upper)
+                continue;
+
+            // Rounding up may carry through nines into one more digit: 10 ^ count.
+            memcpy(decimal->digits, all, (size_t)count);
+            int carry = up, last = count - 1;
+            for (; carry && last >= 0; --last) {
+                carry = decimal->digits[last] == '9';
+                decimal->digits[last] = carry ? '0' : (char)(decimal->digits[last] + 1);
+            }
+            decimal->count = count;
+            decimal->exponent = digits - 1 - k;
+            if (carry) {
+                decimal->digits[0] = '1';
+                decimal->exponent++;
+            }
+            return 1;
+        }
+        return 0;
+    }
+
+    static size_t format_hex(char *text, const Parts *parts) {
+        static const char HEX[] = "0123456789abcdef";
+
+        size_t pos = 0;
+        text[pos++] = parts->negative ? '-' : '+';
+        text[pos++] = '0';
+        text[pos++] = 'x';
+        text[pos++] = HEX[parts->mantissa >> 60];
+
+        uint64_t rest = parts->mantissa << 4;
+        if (rest != 0) {
+            text[pos++] = '.';
+            for (; rest != 0; rest <<= 4) {
+                text[pos++] = HEX[rest >> 60];
+            }
+        }
+
+        // The first hexadecimal digit has 4 bits of mantissa, so exponent is 3 less than exponent of 1.xxx.
+        int exponent = parts->exponent - EXPONENT_BIAS - 3;
+        text[pos++] = 'p';
+        text[pos++] = (exponent < 0) ? '-' : '+';
+
+        char digits[8] = {};
+        int count = 0;
+        unsigned value = (unsigned)abs(exponent);
+        do {
+            digits[count++] = (char)('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        while (count > 0) {
+            text[pos++] = digits[--count];
+        }
+        return pos;
+    }
+
+    static size_t format_printf(char *text, long double value, NUMBER_FORMAT mode, int width, int precision) {
+        int length = 0;
+        switch (mode) {
+        case NF_SHORTEST:
+            length = snprintf(text, NUMBER_LENGTH, "%+-*.*Lg", width, shortest_precision(value, precision), value);
+            break;
+        case NF_HEX:
+            length = snprintf(text, NUMBER_LENGTH, "%+-*La", width, value);
+            break;
+        case NF_FIXED:
+        default:
+            length = snprintf(text, NUMBER_LENGTH, "%+-*.*Lg", width, FIXED_DIGITS, value);
+            break;
+        }
+        return (length < 0) ? 0 : (size_t)length;
+    }
+
+    size_t format_number(char *text, long double value, NUMBER_FORMAT mode, int width) {
+        ASSERTIF(text != NULL, "nullptr in text", 0);
+
+        width = (width < 0) ? 0 : (width > NUMBER_WIDTH_MAX) ? NUMBER_WIDTH_MAX : width;
+        Parts parts = split(value);
+        Decimal decimal = {};
+        int precision = (mode == NF_SHORTEST) ? 1 : FIXED_DIGITS;
+
+        size_t length = 0;
+        if (parts.exponent == 0 && parts.mantissa == 0) {
+            const char *zero = (mode == NF_HEX) ? "0x0p+0" : "0";
+            text[0] = parts.negative ? '-' : '+';
+            length = strlen(zero) + 1;
+            memcpy(text + 1, zero, length - 1);
+        } else if (parts.exponent == 0 || parts.exponent == EXPONENT_MAX || (parts.mantissa >> 63) == 0) {
+            return format_printf(text, value, mode, width, precision);
+        } else if (mode == NF_HEX) {
+            length = format_hex(text, &parts);
+        } else if (mode == NF_SHORTEST ? shortest_decimal(&parts, &decimal, &precision) : fixed_decimal(&parts, value, &decimal)) {
+            length = write_general(text, parts.negative, &decimal, precision);
+        } else {
+            return format_printf(text, value, mode, width, precision);
+        }
+
+        if (length < (size_t)width) {
+            memset(text + length, ' ', (size_t)width - length);
+            length = (size_t)width;
+        }
+        text[length] = '\0';
+        return length;
+    }
+
+    int shortest_precision(long double value, int from) {
+        char text[NUMBER_LENGTH] = "";
+        for (int precision = (from < 1) ? 1 : from; precision < SHORTEST_DIGITS; ++precision) {
+            snprintf(text, sizeof(text), "%.*Lg", precision, value);
+            long double back = strtold(text, NULL);
+            if (!(back < value) && !(back > value))
+                return precision;
+        }
+        return SHORTEST_DIGITS;
+    }
+
+    int parse_number_format(const char *name, NUMBER_FORMAT *mode) {
+        ASSERTIF(name != NULL, "nullptr in name", 0);
+        ASSERTIF(mode != NULL, "nullptr in mode", 0);
+
+        if (strcmp(name, "fixed") == 0) {
+            *mode = NF_FIXED;
+        } else if (strcmp(name, "shortest") == 0) {
+            *mode = NF_SHORTEST;
+        } else if (strcmp(name, "hex") == 0) {
+            *mode = NF_HEX;
+        } else {
+            return 0;
+        }
+        return 1;
+    }
+
+    const char *number_format_name(NUMBER_FORMAT mode) {
+        switch (mode) {
+        case NF_FIXED:
+            return "fixed";
+        case NF_SHORTEST:
+            return "shortest";
+        case NF_HEX:
+            return "hex";
+        default:
+            return "unknown";
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef FORMAT_DEF
+#define FORMAT_DEF
+
+#include <stddef.h>
+
+/**
+ * @brief   This namespace includes formatting of coefficients and roots without printf.
+ * @details Every mode writes a number with a sign, left-justified in a field of width characters, straight into a buffer:
+ * - NF_FIXED writes FIXED_DIGITS significant digits exactly like printf("%+-10.5Lg"). The number is scaled to 5 digits by exact
+ *   powers of 10 in long double, a digit which is too close to a tie to be rounded surely is left to snprintf.
+ * - NF_SHORTEST writes the shortest "%+.PLg" (P up to 21 digits) which is read back by strtold as the same long double. Like Grisu,
+ *   the number and the bounds of its rounding interval are multiplied by a cached 128-bit power of 10, and the shortest correctly rounded
+ *   number of digits which is surely inside the interval is taken; if it can't be decided in 128 bits, P is found by snprintf and strtold.
+ * - NF_HEX writes the exact value like printf("%+La"), for example +0x8p-3 for 1.
+ * Zeros never go to snprintf, infinities, NaN and subnormal numbers always do.
+ */
+namespace format {
+    /// Size of buffer for one number of format_number (with '\0'), enough for any width up to NUMBER_WIDTH_MAX.
+    const size_t NUMBER_LENGTH = 64;
+
+    /// Width of field used by print_roots and plain output.
+    const int NUMBER_WIDTH = 10;
+
+    /// Maximal width of field.
+    const int NUMBER_WIDTH_MAX = 48;
+
+    /// Number of significant digits of NF_FIXED.
+    const int FIXED_DIGITS = 5;
+
+    /// Maximal number of significant digits of NF_SHORTEST: any long double is read back from 21 digits.
+    const int SHORTEST_DIGITS = 21;
+
+    /// Enumerated type of data with modes of format_number.
+    typedef enum {
+        NF_FIXED,    ///< 5 significant digits like "%+-10.5Lg", default of the program
+        NF_SHORTEST, ///< Shortest digits which are read back as the same number
+        NF_HEX       ///< Exact hexadecimal floating point like "%+La"
+    } NUMBER_FORMAT;
+
+    /**
+     * @brief Writes value in mode, left-justified in a field of width characters.
+     * @param [out] *text  - Buffer of NUMBER_LENGTH characters, '\0' is written after the number
+     * @param [in]  value  - Number
+     * @param [in]  mode   - Mode
+     * @param [in]  width  - Width of field (0 for no padding, at most NUMBER_WIDTH_MAX)
+     * @return number of written characters without '\0'
+     */
+    size_t format_number(char *text, long double value, NUMBER_FORMAT mode, int width = NUMBER_WIDTH);
+
+    /**
+     * @brief Returns the smallest precision P >= from such that "%.PLg" of value is read by strtold as value, found by snprintf and strtold.
+     * @details Used when format_number can't decide (from the digits which it has already rejected) and to test it.
+     */
+    int shortest_precision(long double value, int from = 1);
+
+    /**
+     * @brief Parses name of mode.
+     * @param [in]  *name - "fixed", "shortest" or "hex"
+     * @param [out] *mode - Parsed mode
+     * @return 1 if name is known and 0 otherwise
+     */
+    int parse_number_format(const char *name, NUMBER_FORMAT *mode);
+
+    /**
+     * @brief Returns printable name of mode.
+     */
+    const char *number_format_name(NUMBER_FORMAT mode);
+}
+
+#endif
@@ -0,0 +1,607 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "quadratic.h"
+#include "common.h"
+#include "output.h"
+#include "binary.h"
+#include "format.h"
+#include "pool.h"
+
+/// Enumerated type of data with classes of generated equations.
+typedef enum {
+	GC_TWO,    ///< Two roots
+	GC_ONE,    ///< One root: discriminant is 0 or below EPS
+	GC_LINEAR, ///< a = 0, one root
+	GC_INF,    ///< All coefficients are 0 or below EPS
+	GC_ZERO,   ///< Negative discriminant, or a = 0, b below EPS and c != 0
+	GC_COUNT   ///< Number of classes
+} GENERATED_CLASS;
+
+/// Names of classes in --mix.
+static const char *const CLASS_NAMES[GC_COUNT] = {"two", "one", "linear", "inf", "zero"};
+
+/// Bits of mantissa of leading coefficient (of b for linear equations).
+static const int SCALE_BITS = 5;
+
+/// Coefficients and discriminants are at least EPS * EPS_MARGIN or at most EPS / EPS_MARGIN, so their class is not on the edge of EPS.
+static const long double EPS_MARGIN = 4;
+
+/// Number of draws of an equation of one class before generator gives up.
+static const int MAX_ATTEMPTS = 1000;
+
+/// Largest decimal exponent of --magnitude: coefficients stay normal in double.
+static const int MAGNITUDE_MAX = 100;
+
+/// Number of equations in a block: blocks are made by workers of the pool and written in order.
+static const size_t GENERATE_BLOCK = 1 << 16;
+
+/// Number of blocks made at once by every worker.
+static const size_t BLOCKS_PER_WORKER = 2;
+
+/// log2(10): decimal exponents of --magnitude to binary ones.
+static const long double LOG2_10 = 3.321928094887362347870L;
+
+/**
+ * @brief Options of generator.
+ * @details Every block has its own seed made of seed and number of block, so output doesn't depend on number of threads.
+ * @param count      - Number of equations
+ * @param seed       - Seed of pseudorandom generator (--seed)
+ * @param weights    - Weights of classes
+ * @param low, high  - Decimal exponents of magnitudes of roots and leading coefficients (--magnitude)
+ * @param octaves    - Binary exponents of the lowest and the highest octave of roots
+ * @param scale_low  - Binary exponent of the lowest octave of leading coefficients, they are not below EPS * EPS_MARGIN
+ * @param condition  - Number of first decimal digits which two roots share (0 for independent roots)
+ * @param shift      - 10^-condition
+ * @param root_bits  - Bits of mantissa of roots, so that b and c are exact in precision of output
+ * @param equations  - Write only coefficients
+ * @param precision  - Precision of binary file (0 for text)
+ * @param threads    - Number of threads (0 for all hardware threads)
+ */
+typedef struct {
+	unsigned long long count, seed;
+	unsigned weights[GC_COUNT];
+	int low, high, octaves[2], scale_low, condition;
+	long double shift;
+	int root_bits, equations, precision, threads;
+} Generator;
+
+/**
+ * @brief A block of equations made by a worker.
+ * @param out       - Text or columns of block one after another (OUTPUT_MEMORY)
+ * @param equations - Equations of block which are turned into columns (NULL for text)
+ * @param size      - Number of made equations
+ * @param made      - Number of equations of every class
+ * @param failed    - Class + 1 if an equation of this class can't be made with options, 0 otherwise
+ */
+typedef struct {
+	output::OutputBuffer out;
+	quadratic::Equation *equations;
+	size_t size;
+	unsigned long long made[GC_COUNT];
+	int failed;
+} Block;
+
+/**
+ * @brief Context of make_blocks.
+ * @param *generator - Options
+ * @param *blocks    - Blocks of this round
+ * @param first      - Number of the first block of this round
+ */
+typedef struct {
+	const Generator *generator;
+	Block *blocks;
+	unsigned long long first;
+} GenerateContext;
+
+/**
+ * @brief A random number: mantissa * 2^quantum.
+ */
+typedef struct {
+	int64_t mantissa;
+	int quantum;
+} Draw;
+
+/**
+ * @brief Returns the next 64 pseudorandom bits, same sequence for the same seed.
+ */
+static uint64_t random_bits(unsigned long long *seed);
+
+/**
+ * @brief Returns pseudorandom number in [0, 1).
+ */
+static long double random_unit(unsigned long long *seed);
+
+/**
+ * @brief Returns number of random sign with bits significant bits in a random octave of [low, high].
+ * @details Octaves are uniform, so magnitudes are log-uniform like 10^uniform, without powl (it takes most of the time otherwise).
+ */
+static Draw random_draw(unsigned long long *seed, int bits, int low, int high);
+
+/**
+ * @brief Returns mantissa of draw rounded to a multiple of 2^quantum (quantum is not less than draw.quantum).
+ */
+static int64_t align_draw(Draw draw, int quantum);
+
+/**
+ * @brief Returns 2^exponent, made from its x87 bits (ldexpl is too slow for every number).
+ */
+static long double power_of_two(int exponent);
+
+/**
+ * @brief Returns mantissa * 2^quantum.
+ */
+static long double draw_value(int64_t mantissa, int quantum);
+
+/**
+ * @brief Returns seed of block number, far from seeds of other blocks (splitmix64).
+ */
+static unsigned long long block_seed(unsigned long long seed, unsigned long long number);
+
+/**
+ * @brief Makes an equation of class from its roots.
+ * @details Roots are integers of root_bits bits times a common power of 2 and a has SCALE_BITS bits, so b = -a (x1 + x2) and
+ * c = a x1 x2 are exact and the roots written with the equation are its roots. The class is that of exact coefficients by the rules
+ * of solve_equation (absolute EPS), with a margin around EPS.
+ * @param [in]      *generator - Options
+ * @param [in, out] *seed      - State of pseudorandom generator
+ * @param [in]      cls        - Class
+ * @param [out]     *equation  - Equation with roots
+ * @return 1 if equation was made and 0 if MAX_ATTEMPTS draws didn't fit options
+ */
+static int make_class(const Generator *generator, unsigned long long *seed, GENERATED_CLASS cls, quadratic::Equation *equation);
+
+/**
+ * @brief Writes equation as a line of text: a b c num_roots x1 x2 (a b c for --equations), numbers are the shortest ones read back exactly.
+ * @return void
+ */
+static void write_text(output::OutputBuffer *out, const quadratic::Equation *equation, int equations);
+
+/**
+ * @brief Writes columns of equations one after another like in a binary file (look binary.h): a, b, c and, without --equations,
+ * x1, x2 and num_roots.
+ * @return void
+ */
+static void write_columns(output::OutputBuffer *out, const quadratic::Equation *equations, size_t size, int precision, int equations_only);
+
+/**
+ * @brief Writes columns of block to their places in binary file: the block starts at equation first.
+ * @return 1 if columns were written and 0 otherwise
+ */
+static int write_block(int fd, const binary::BinaryHeader *header, const Block *block, unsigned long long first);
+
+/**
+ * @brief Makes header of binary file of all equations, sizes stdout and writes the header to it.
+ * @return 1 if stdout is a regular file which is ready for columns and 0 otherwise
+ */
+static int start_binary(const Generator *generator, binary::BinaryHeader *header);
+
+/**
+ * @brief Makes blocks [begin, end) of GenerateContext (look parallel::TASK).
+ */
+static void make_blocks(void *context, size_t begin, size_t end, int worker);
+
+/**
+ * @brief Makes and writes generator->count equations to stdout, prints counts and throughput to stderr.
+ * @details Rounds of BLOCKS_PER_WORKER blocks for every worker are made by the pool and written in order by the calling thread.
+ * @return Exit code of the program
+ */
+static int generate(const Generator *generator);
+
+/**
+ * @brief Parses weights of classes like "two=60,one=10,linear=10,inf=5,zero=15", classes which are not given get 0.
+ * @return 1 if spec is right and the sum of weights is not 0, 0 otherwise
+ */
+static int parse_mix(const char *spec, unsigned *weights);
+
+static uint64_t random_bits(unsigned long long *seed) {
+	*seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+	uint64_t bits = *seed;
+	bits ^= bits >> 33;
+	bits *= 0xff51afd7ed558ccdULL;
+	return bits ^ (bits >> 33);
+}
+
+static long double random_unit(unsigned long long *seed) {
+	return (long double)(random_bits(seed) >> 11) * 0x1p-53L;
+}
+
+static Draw random_draw(unsigned long long *seed, int bits, int low, int high) {
+	uint64_t random = random_bits(seed);
+	int octave = low + (int)((random & UINT32_MAX) % (uint64_t)(high - low + 1));
+	int64_t mantissa = (int64_t)((1ULL << (bits - 1)) | (random >> (65 - bits)));
+	return {(random & (1ULL << 32)) ? -mantissa : mantissa, octave + 1 - bits};
+}
+
+static int64_t align_draw(Draw draw, int quantum) {
+	int distance = quantum - draw.quantum;
+	if (distance == 0)
+		return draw.mantissa;
+	if (distance >= 63)
+		return 0;
+
+	int64_t magnitude = (draw.mantissa < 0) ? -draw.mantissa : draw.mantissa;
+	magnitude = (magnitude + (1LL << (distance - 1))) >> distance;
+	return (draw.mantissa < 0) ? -magnitude : magnitude;
+}
+
+static long double power_of_two(int exponent) {
+	const uint64_t mantissa = 1ULL << 63;
+	const uint16_t biased = (uint16_t)(exponent + 16383);
+
+	long double value = 0;
+	memcpy(&value, &mantissa, sizeof(mantissa));
+	memcpy((char *)&value + sizeof(mantissa), &biased, sizeof(biased));
+	return value;
+}
+
+static long double draw_value(int64_t mantissa, int quantum) {
+	return (long double)mantissa * power_of_two(quantum);
+}
+
+static unsigned long long block_seed(unsigned long long seed, unsigned long long number) {
+	uint64_t bits = seed + (number + 1) * 0x9e3779b97f4a7c15ULL;
+	bits = (bits ^ (bits >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	bits = (bits ^ (bits >> 27)) * 0x94d049bb133111ebULL;
+	return bits ^ (bits >> 31);
+}
+
+static int make_class(const Generator *generator, unsigned long long *seed, GENERATED_CLASS cls, quadratic::Equation *equation) {
+	const int root_bits = generator->root_bits, low = generator->octaves[0], high = generator->octaves[1];
+	for (int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt) {
+		Draw scale = random_draw(seed, SCALE_BITS, generator->scale_low, high);
+		long double a = draw_value(scale.mantissa, scale.quantum);
+
+		switch (cls) {
+		case GC_TWO: {
+			Draw first = random_draw(seed, root_bits, low, high), second = first;
+			if (generator->condition > 0) {
+				int64_t magnitude = (first.mantissa < 0) ? -first.mantissa : first.mantissa;
+				int64_t shift = (int64_t)((long double)magnitude * (1 + 9 * random_unit(seed)) * generator->shift);
+				shift = (shift < 1) ? 1 : shift;
+				second.mantissa += (random_bits(seed) & 1) ? shift : -shift;
+			} else {
+				second = random_draw(seed, root_bits, low, high);
+			}
+			int quantum = (first.quantum > second.quantum) ? first.quantum : second.quantum;
+			long double x1 = draw_value(align_draw(first, quantum), quantum), x2 = draw_value(align_draw(second, quantum), quantum);
+
+			long double distance = a * (x1 - x2);
+			if (distance * distance < EPS * EPS_MARGIN)
+				continue;
+			*equation = {a, -a * (x1 + x2), a * x1 * x2, x1, x2, quadratic::RN_TWO};
+			return 1;
+		}
+		case GC_ONE: {
+			// The second root is moved from the first by k quanta, so that the discriminant a^2 (x1 - x2)^2 stays below EPS.
+			Draw root = random_draw(seed, root_bits, low, high);
+			long double quantum = power_of_two(root.quantum), x1 = draw_value(root.mantissa, root.quantum), x2 = x1;
+
+			long double steps = sqrtl(EPS / EPS_MARGIN) / (fabsl(a) * quantum);
+			steps = (steps < (long double)(1LL << (root_bits - 1))) ? steps : (long double)(1LL << (root_bits - 1));
+			if (steps >= 1 && (random_bits(seed) & 1))
+				x2 = x1 + (long double)(int64_t)(random_unit(seed) * (steps + 1)) * quantum;
+			*equation = {a, -a * (x1 + x2), a * x1 * x2, (x1 + x2) / 2, 0, quadratic::RN_ONE};
+			return 1;
+		}
+		case GC_LINEAR: {
+			Draw root = random_draw(seed, root_bits, low, high);
+			long double x1 = draw_value(root.mantissa, root.quantum);
+			*equation = {0, a, -a * x1, x1, 0, quadratic::RN_ONE};
+			return 1;
+		}
+		case GC_INF: {
+			long double tiny[3] = {};
+			for (int i = 0; i < 3; ++i) {
+				if (random_bits(seed) & 1)
+					tiny[i] = (EPS / EPS_MARGIN) * (2 * random_unit(seed) - 1);
+			}
+			*equation = {tiny[0], tiny[1], tiny[2], 0, 0, quadratic::RN_INF};
+			return 1;
+		}
+		case GC_ZERO: {
+			// a (x - p)^2 + a s^2 has discriminant -4 a^2 s^2; every fourth equation is a = 0, |b| < EPS and c != 0 instead.
+			if ((random_bits(seed) & 3) == 0) {
+				long double tiny = (EPS / EPS_MARGIN) * (2 * random_unit(seed) - 1);
+				*equation = {0, tiny, a, 0, 0, quadratic::RN_ZERO};
+				return 1;
+			}
+			Draw center = random_draw(seed, root_bits, low, high), imaginary = random_draw(seed, root_bits, low, high);
+			int quantum = (center.quantum > imaginary.quantum) ? center.quantum : imaginary.quantum;
+			long double p = draw_value(align_draw(center, quantum), quantum), s = draw_value(align_draw(imaginary, quantum), quantum);
+			if (fpclassify(s) == FP_ZERO)
+				continue;
+			*equation = {a, -2 * a * p, a * (p * p + s * s), 0, 0, quadratic::RN_ZERO};
+			return 1;
+		}
+		case GC_COUNT:
+		default:
+			ASSERTIF(0, "default case", 0);
+		}
+	}
+	return 0;
+}
+
+static void write_text(output::OutputBuffer *out, const quadratic::Equation *equation, int equations) {
+	const long double numbers[5] = {equation->a, equation->b, equation->c, equation->x1, equation->x2};
+	char line[6 * format::NUMBER_LENGTH] = "";
+	size_t length = 0;
+	for (int i = 0; i < (equations ? 3 : 5); ++i) {
+		if (i == 3) {
+			line[length++] = (char)('0' + equation->num_roots);
+			line[length++] = ' ';
+		}
+		char text[format::NUMBER_LENGTH] = "";
+		size_t size = format::format_number(text, numbers[i], format::NF_SHORTEST, 0), sign = (text[0] == '+');
+		memcpy(line + length, text + sign, size - sign);
+		length += size - sign;
+		line[length++] = ' ';
+	}
+	line[length - 1] = '\n';
+
+	output::output_write(out, line, length);
+}
+
+static void write_columns(output::OutputBuffer *out, const quadratic::Equation *equations, size_t size, int precision, int equations_only) {
+	for (int column = binary::BC_A; column < (equations_only ? binary::BC_X1 : binary::BC_COUNT); ++column) {
+		for (size_t i = 0; i < size; ++i) {
+			const quadratic::Equation *equation = equations + i;
+			const long double numbers[binary::BC_NUM_ROOTS] = {equation->a, equation->b, equation->c, equation->x1, equation->x2};
+			if (column == binary::BC_NUM_ROOTS) {
+				int32_t num_roots = equation->num_roots;
+				output::output_write(out, (const char *)&num_roots, sizeof(num_roots));
+			} else if (precision == binary::BP_DOUBLE) {
+				double number = (double)numbers[column];
+				output::output_write(out, (const char *)&number, sizeof(number));
+			} else {
+				output::output_write(out, (const char *)&numbers[column], sizeof(long double));
+			}
+		}
+	}
+}
+
+static int write_block(int fd, const binary::BinaryHeader *header, const Block *block, unsigned long long first) {
+	const char *data = block->out.data;
+	for (int column = binary::BC_A; column < binary::BC_COUNT && header->offsets[column] != 0; ++column) {
+		size_t bytes = binary::column_size(header->precision, column, block->size);
+		off_t offset = (off_t)(header->offsets[column] + binary::column_size(header->precision, column, first));
+		for (size_t done = 0; done < bytes;) {
+			ssize_t written = pwrite(fd, data + done, bytes - done, offset + (off_t)done);
+			if (written <= 0)
+				return 0;
+			done += (size_t)written;
+		}
+		data += bytes;
+	}
+	return 1;
+}
+
+static int start_binary(const Generator *generator, binary::BinaryHeader *header) {
+	struct stat info = {};
+	int flags = fcntl(STDOUT_FILENO, F_GETFL);
+	if (fstat(STDOUT_FILENO, &info) != 0 || !S_ISREG(info.st_mode) || flags < 0 || (flags & O_APPEND)) {
+		fprintf(stderr, "--binary writes columns of a binary file (look binary.h), so stdout must be a file\n");
+		return 0;
+	}
+
+	size_t bytes = binary::make_header(header, (binary::BINARY_PRECISION)generator->precision, generator->count, !generator->equations);
+	if (ftruncate(STDOUT_FILENO, (off_t)bytes) != 0 || pwrite(STDOUT_FILENO, header, sizeof(*header), 0) != (ssize_t)sizeof(*header)) {
+		fprintf(stderr, "Unable to write binary file of %zu bytes: %s\n", bytes, strerror(errno));
+		return 0;
+	}
+	return 1;
+}
+
+static void make_blocks(void *context, size_t begin, size_t end, int) {
+	const GenerateContext *generate = (const GenerateContext *)context;
+	const Generator *generator = generate->generator;
+
+	unsigned total = 0;
+	for (int cls = 0; cls < GC_COUNT; ++cls) {
+		total += generator->weights[cls];
+	}
+
+	for (size_t index = begin; index < end; ++index) {
+		Block *block = generate->blocks + index;
+		unsigned long long number = generate->first + index, seed = block_seed(generator->seed, number);
+		unsigned long long size = generator->count - number * GENERATE_BLOCK;
+		size = (size < GENERATE_BLOCK) ? size : GENERATE_BLOCK;
+
+		for (unsigned long long i = 0; i < size; ++i) {
+			unsigned pick = (unsigned)(random_bits(&seed) % total);
+			int cls = 0;
+			for (; pick >= generator->weights[cls]; pick -= generator->weights[cls], ++cls);
+
+			quadratic::Equation equation = {};
+			if (!make_class(generator, &seed, (GENERATED_CLASS)cls, &equation)) {
+				block->failed = cls + 1;
+				break;
+			}
+			block->made[cls]++;
+
+			if (block->equations != NULL) {
+				block->equations[block->size++] = equation;
+			} else {
+				write_text(&block->out, &equation, generator->equations);
+				block->size++;
+			}
+		}
+
+		if (block->equations != NULL) {
+			write_columns(&block->out, block->equations, block->size, generator->precision, generator->equations);
+		}
+	}
+}
+
+static int generate(const Generator *generator) {
+	const int columns = generator->precision != 0;
+	binary::BinaryHeader header = {};
+	if (columns && !start_binary(generator, &header))
+		return 1;
+
+	parallel::ThreadPool *pool = parallel::make_pool(generator->threads);
+	const size_t round = (pool != NULL) ? BLOCKS_PER_WORKER * (size_t)parallel::pool_size(pool) : 0;
+	Block *blocks = (Block *)calloc(round + 1, sizeof(Block));
+	output::OutputBuffer out = {};
+	int ready = pool != NULL && blocks != NULL && (columns || output::make_output(&out, STDOUT_FILENO));
+	for (size_t i = 0; ready && i < round; ++i) {
+		ready = output::make_output(&blocks[i].out, output::OUTPUT_MEMORY, GENERATE_BLOCK * 6 * sizeof(long double));
+		if (ready && columns) {
+			blocks[i].equations = (quadratic::Equation *)calloc(GENERATE_BLOCK, sizeof(quadratic::Equation));
+			ready = blocks[i].equations != NULL;
+		}
+	}
+	if (!ready) {
+		fprintf(stderr, "Unable to alloc memory for %zu blocks\n", round);
+		for (size_t i = 0; blocks != NULL && i < round; ++i) {
+			output::free_output(&blocks[i].out);
+			free(blocks[i].equations);
+		}
+		free(blocks);
+		output::free_output(&out);
+		parallel::free_pool(pool);
+		return 1;
+	}
+
+	struct timespec start = {}, finish = {};
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	unsigned long long made[GC_COUNT] = {}, bytes = 0, equations = 0;
+	const unsigned long long total_blocks = (generator->count + GENERATE_BLOCK - 1) / GENERATE_BLOCK;
+	int failed = 0, written = 1;
+	for (unsigned long long first = 0; first < total_blocks && !failed && written; first += round) {
+		size_t count = (total_blocks - first < round) ? (size_t)(total_blocks - first) : round;
+		for (size_t i = 0; i < count; ++i) {
+			blocks[i].out.size = 0;
+			blocks[i].size = 0;
+			memset(blocks[i].made, 0, sizeof(blocks[i].made));
+		}
+
+		GenerateContext context = {generator, blocks, first};
+		parallel::pool_for(pool, count, 1, make_blocks, &context);
+
+		for (size_t i = 0; i < count && !failed && written; ++i) {
+			if (columns) {
+				written = write_block(STDOUT_FILENO, &header, blocks + i, equations);
+			} else {
+				output::output_write(&out, blocks[i].out.data, blocks[i].out.size);
+				written = !out.failed;
+			}
+			bytes += blocks[i].out.size;
+			for (int cls = 0; cls < GC_COUNT; ++cls) {
+				made[cls] += blocks[i].made[cls];
+				equations += blocks[i].made[cls];
+			}
+			failed = blocks[i].failed;
+		}
+	}
+
+	written = (columns || output::free_output(&out)) && written;
+	clock_gettime(CLOCK_MONOTONIC, &finish);
+	for (size_t i = 0; i < round; ++i) {
+		output::free_output(&blocks[i].out);
+		free(blocks[i].equations);
+	}
+	free(blocks);
+	parallel::free_pool(pool);
+
+	if (failed) {
+		fprintf(stderr, "Unable to make %s equations with --magnitude %d:%d and --condition %d\n", CLASS_NAMES[failed - 1],
+		        generator->low, generator->high, generator->condition);
+		return 1;
+	}
+
+	double seconds = (double)(finish.tv_sec - start.tv_sec) + (double)(finish.tv_nsec - start.tv_nsec) * 1e-9;
+	fprintf(stderr, "Generated %llu equations (two %llu, one %llu, linear %llu, inf %llu, zero %llu), %llu bytes in %.3f s: %.1f MB/s\n",
+	        equations, made[GC_TWO], made[GC_ONE], made[GC_LINEAR], made[GC_INF], made[GC_ZERO], bytes, seconds,
+	        (seconds > 0) ? (double)bytes / seconds * 1e-6 : 0);
+	return written ? 0 : 1;
+}
+
+static int parse_mix(const char *spec, unsigned *weights) {
+	memset(weights, 0, GC_COUNT * sizeof(unsigned));
+
+	unsigned long total = 0;
+	for (const char *cur = spec; *cur != '\0';) {
+		const char *equal = strchr(cur, '=');
+		if (equal == NULL)
+			return 0;
+
+		size_t length = (size_t)(equal - cur);
+		int cls = 0;
+		for (; cls < GC_COUNT && (strlen(CLASS_NAMES[cls]) != length || strncmp(cur, CLASS_NAMES[cls], length) != 0); ++cls);
+		char *end = NULL;
+		unsigned long weight = strtoul(equal + 1, &end, 10);
+		if (cls == GC_COUNT || end == equal + 1 || (*end != ',' && *end != '\0') || weight > 1000000)
+			return 0;
+
+		weights[cls] = (unsigned)weight;
+		total += weight;
+		cur = (*end == ',') ? end + 1 : end;
+	}
+	return total != 0;
+}
+
+int main(int argc, const char *argv[]) {
+	Generator generator = {1000000, 2022, {60, 10, 10, 5, 15}, -2, 2, {}, 0, 0, 1, 0, 0, 0, 1};
+
+	int right = 1;
+	for (int arg = 1; arg < argc && right; arg++) {
+		char *end = NULL;
+		if (strcmp(argv[arg], "-n") == 0 && arg + 1 < argc) {
+			generator.count = strtoull(argv[++arg], &end, 10);
+			right = *end == '\0';
+		} else if (strcmp(argv[arg], "--seed") == 0 && arg + 1 < argc) {
+			generator.seed = strtoull(argv[++arg], &end, 10);
+			right = *end == '\0';
+		} else if (strcmp(argv[arg], "--mix") == 0 && arg + 1 < argc) {
+			right = parse_mix(argv[++arg], generator.weights);
+		} else if (strcmp(argv[arg], "--magnitude") == 0 && arg + 1 < argc) {
+			right = sscanf(argv[++arg], "%d:%d", &generator.low, &generator.high) == 2 && generator.low <= generator.high &&
+			        generator.low >= -MAGNITUDE_MAX && generator.high <= MAGNITUDE_MAX;
+		} else if (strcmp(argv[arg], "--condition") == 0 && arg + 1 < argc) {
+			generator.condition = (int)strtol(argv[++arg], &end, 10);
+			right = *end == '\0' && generator.condition >= 0 && generator.condition <= 18;
+		} else if (strcmp(argv[arg], "-j") == 0 && arg + 1 < argc) {
+			generator.threads = (int)strtol(argv[++arg], &end, 10);
+			right = *end == '\0' && generator.threads >= 0;
+		} else if (strcmp(argv[arg], "--equations") == 0) {
+			generator.equations = 1;
+		} else if (strcmp(argv[arg], "--binary") == 0 && arg + 1 < argc) {
+			arg++;
+			generator.precision = (strcmp(argv[arg], "double") == 0) ? binary::BP_DOUBLE :
+			                      (strcmp(argv[arg], "long") == 0)   ? binary::BP_LONG_DOUBLE : 0;
+			right = generator.precision != 0;
+		} else {
+			right = 0;
+		}
+	}
+
+	if (!right) {
+		fprintf(stderr, "Usage: %s [-n count] [--seed N] [--mix two=60,one=10,linear=10,inf=5,zero=15] [--magnitude low:high]\n"
+		                "       [--condition digits] [--equations] [--binary double|long] [-j threads] > output\n", argv[0]);
+		return 1;
+	}
+
+	// a x1 x2 and a (p^2 + s^2) must fit into the mantissa of numbers which are written.
+	generator.root_bits = (((generator.precision == binary::BP_DOUBLE) ? 53 : 64) - SCALE_BITS - 1) / 2;
+	generator.octaves[0] = (int)floorl(generator.low * LOG2_10);
+	generator.octaves[1] = (int)ceill(generator.high * LOG2_10) - 1;
+	generator.octaves[1] = (generator.octaves[1] < generator.octaves[0]) ? generator.octaves[0] : generator.octaves[1];
+	generator.scale_low = ilogbl(EPS * EPS_MARGIN) + 1;
+	generator.scale_low = (generator.scale_low < generator.octaves[0]) ? generator.octaves[0] : generator.scale_low;
+	generator.shift = powl(10.0L, -(long double)generator.condition);
+	if (generator.scale_low > generator.octaves[1]) {
+		fprintf(stderr, "Leading coefficients of --magnitude %d:%d are below EPS\n", generator.low, generator.high);
+		return 1;
+	}
+	return generate(&generator);
+}
@@ -0,0 +1,75 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "common.h"
+#include "batch.h"
+#include "libquadratic.h"
+
+static_assert(QE_ERROR == quadratic::QE_QUAD_ERROR && QE_ZERO == quadratic::RN_ZERO && QE_ONE == quadratic::RN_ONE &&
+              QE_TWO == quadratic::RN_TWO && QE_INF == quadratic::RN_INF, "QE_* must match ROOT_NUMBER");
+
+/// Number of records which are copied to columns on the stack at once by qe_solve_records.
+static const size_t RECORD_BLOCK = 64;
+
+/**
+ * @brief Counts equations which were solved without QE_ERROR.
+ */
+static size_t count_solved(const int *num_roots, size_t count);
+
+static size_t count_solved(const int *num_roots, size_t count) {
+    size_t solved = 0;
+    for (size_t i = 0; i < count; ++i) {
+        solved += num_roots[i] != QE_ERROR;
+    }
+    return solved;
+}
+
+int qe_abi_version(void) {
+    return QE_ABI_VERSION;
+}
+
+qe_layout qe_equation_layout(void) {
+    return {sizeof(qe_equation), offsetof(qe_equation, a), offsetof(qe_equation, b), offsetof(qe_equation, c),
+            offsetof(qe_equation, x1), offsetof(qe_equation, x2), offsetof(qe_equation, num_roots)};
+}
+
+size_t qe_solve_columns(const double *a, const double *b, const double *c, double *x1, double *x2, int *num_roots, size_t count) {
+    if (a == NULL || b == NULL || c == NULL || x1 == NULL || x2 == NULL || num_roots == NULL)
+        return 0;
+
+    quadratic::solve_columns(a, b, c, x1, x2, num_roots, count);
+    return count_solved(num_roots, count);
+}
+
+size_t qe_solve_records(void *records, size_t count, const qe_layout *layout) {
+    if (records == NULL || layout == NULL)
+        return 0;
+
+    double a[RECORD_BLOCK] = {}, b[RECORD_BLOCK] = {}, c[RECORD_BLOCK] = {}, x1[RECORD_BLOCK] = {}, x2[RECORD_BLOCK] = {};
+    int num_roots[RECORD_BLOCK] = {};
+
+    size_t solved = 0;
+    for (size_t first = 0; first < count; first += RECORD_BLOCK) {
+        size_t n = (count - first < RECORD_BLOCK) ? count - first : RECORD_BLOCK;
+        char *block = (char *)records + first * layout->stride;
+
+        // Fields are copied by memcpy because records of numpy and packed structs may be unaligned.
+        for (size_t i = 0; i < n; ++i) {
+            const char *record = block + i * layout->stride;
+            memcpy(a + i, record + layout->a, sizeof(double));
+            memcpy(b + i, record + layout->b, sizeof(double));
+            memcpy(c + i, record + layout->c, sizeof(double));
+        }
+
+        quadratic::solve_columns(a, b, c, x1, x2, num_roots, n);
+
+        for (size_t i = 0; i < n; ++i) {
+            char *record = block + i * layout->stride;
+            memcpy(record + layout->x1,        x1 + i,        sizeof(double));
+            memcpy(record + layout->x2,        x2 + i,        sizeof(double));
+            memcpy(record + layout->num_roots, num_roots + i, sizeof(int));
+        }
+        solved += count_solved(num_roots, n);
+    }
+    return solved;
+}
@@ -0,0 +1,93 @@
+#ifndef LIBQUADRATIC_DEF
+#define LIBQUADRATIC_DEF
+
+#include <stddef.h>
+
+/**
+ * @brief   C ABI of libquadratic.so and libquadratic.a (make lib).
+ * @details Equations are solved in place in buffers owned by the caller: separate columns (qe_solve_columns) or records of any layout
+ * with a stride, like numpy structured arrays or arrays of C structs (qe_solve_records). Coefficients and roots are double, equations
+ * are solved by the kernels of solve_batch with the same classification as solve_equation gives for these double coefficients (look
+ * solve_columns in batch.h: rounding of decimal coefficients to double may change class of an equation with a discriminant near 0
+ * or EPS). Functions don't allocate memory, don't print and don't change errno, so they can be called from any number of threads
+ * on different buffers. Only this header is the stable interface: the library exports nothing but qe_* functions, and QE_ABI_VERSION
+ * changes if any of them changes.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define QE_API __attribute__((visibility("default")))
+
+/// Version of this interface, returned by qe_abi_version.
+#define QE_ABI_VERSION 1
+
+/// Values of num_roots, the same as ROOT_NUMBER and QE_QUAD_ERROR of quadratic.h.
+#define QE_ERROR -1 ///< Coefficient is infinite or NaN
+#define QE_ZERO   1 ///< No roots
+#define QE_ONE    2 ///< One root in x1
+#define QE_TWO    3 ///< Two roots in x1 and x2
+#define QE_INF    4 ///< Any number is a root
+
+/**
+ * @brief   One equation in the default record layout.
+ * @details Records of other layouts are described by qe_layout, this one is given by qe_equation_layout.
+ */
+typedef struct {
+    double a, b, c;
+    double x1, x2;
+    int num_roots;
+} qe_equation;
+
+/**
+ * @brief   Layout of records of equations.
+ * @details Every field is a double (num_roots is an int) at its byte offset from the beginning of a record, records follow each other
+ * at stride bytes. Fields don't need to be aligned.
+ * @param stride    - Distance between records in bytes
+ * @param a, b, c   - Offsets of coefficients
+ * @param x1, x2    - Offsets of roots (roots which don't exist are written as 0)
+ * @param num_roots - Offset of number of roots
+ */
+typedef struct {
+    size_t stride;
+    size_t a, b, c;
+    size_t x1, x2;
+    size_t num_roots;
+} qe_layout;
+
+/**
+ * @brief Returns QE_ABI_VERSION of the library, to check that it matches the header.
+ */
+QE_API int qe_abi_version(void);
+
+/**
+ * @brief Returns layout of an array of qe_equation.
+ */
+QE_API qe_layout qe_equation_layout(void);
+
+/**
+ * @brief Solves count equations given as separate columns, without copying them.
+ * @param [in]  *a, *b, *c - Columns of coefficients
+ * @param [out] *x1, *x2   - Columns of roots
+ * @param [out] *num_roots - Column of numbers of roots (QE_ZERO, QE_ONE, QE_TWO, QE_INF or QE_ERROR)
+ * @param [in]  count      - Number of equations
+ * @return number of equations which were solved without QE_ERROR, 0 if a pointer is NULL
+ */
+QE_API size_t qe_solve_columns(const double *a, const double *b, const double *c, double *x1, double *x2, int *num_roots,
+                               size_t count);
+
+/**
+ * @brief Solves count records of equations in place.
+ * @param [in, out] *records - The first record
+ * @param [in]      count    - Number of records
+ * @param [in]      *layout  - Layout of records
+ * @return number of equations which were solved without QE_ERROR, 0 if a pointer is NULL
+ */
+QE_API size_t qe_solve_records(void *records, size_t count, const qe_layout *layout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,16 +1,329 @@
 ﻿#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
 #include <iostream>
 
 #include "quadratic.h"
+#include "arena.h"
+#include "options.h"
+#include "solver.h"
+#include "parser.h"
+#include "output.h"
+#include "binary.h"
+#include "stats.h"
+#include "stream.h"
+#include "server.h"
+#include "polynomial.h"
+#include "query.h"
+#include "sweep.h"
+#include "shard.h"
+#include "compressed.h"
 #include "common.h"
 #include "test.h"
 
+/**
+ * @brief   Solves a single binary file into options->binary_out without copying it into an arena.
+ * @details Numbers are solved in long double and written in options->precision (look solve_binary), so run_batch takes this way
+ * only for --type long without --cache and --stats; other options go through the arena like any other input.
+ * @param [in] *name     - Name of binary file with equations
+ * @param [in] *options  - Options of the program
+ * @return Exit code of the program
+ */
+static int run_binary(const char *name, const options::Options *options) {
+	binary::BinaryFile input = {};
+	if (!binary::open_binary(&input, name)) {
+		return 1;
+	}
+
+	int written = binary::solve_binary(&input, options->binary_out, options->precision, options->threads);
+	binary::close_binary(&input);
+	return written ? 0 : 1;
+}
+
+/**
+ * @brief   Streaming mode of the program (--stream).
+ * @details Arguments must be "-f file" pairs, equations of files are streamed one after another; without arguments stdin is streamed.
+ * Compressed files are decompressed by their own threads while they are streamed (look compressed.h).
+ * @param [in] argc     - Number of terminal arguments without options
+ * @param [in] **argv   - Terminal arguments without options
+ * @param [in] *options - Options of the program
+ * @return Exit code of the program
+ */
+static int run_stream(int argc, const char **argv, const options::Options *options) {
+	if (options->binary_out != NULL || argc % 2 == 0) {
+		printf("Only -f files or stdin can be streamed to text output\n");
+		return 1;
+	}
+
+	int count = (argc - 1) / 2, exit_code = 0;
+	int *fds = new int[(size_t)count + 1];
+	compressed::Input *inputs = new compressed::Input[(size_t)count + 1]();
+	for (int i = 0; i < count; i++) {
+		fds[i] = -1;
+	}
+	if (count == 0) {
+		fds[0] = STDIN_FILENO;
+	}
+
+	for (int i = 0; i < count && exit_code == 0; i++) {
+		if (strcmp(argv[2 * i + 1], "-f") != 0) {
+			printf("Only -f files or stdin can be streamed to text output\n");
+			exit_code = 1;
+		} else if (!compressed::open_input(inputs + i, argv[2 * i + 2])) {
+			if (inputs[i].error != NULL) {
+				printf("Unable to read %s: %s\n", argv[2 * i + 2], inputs[i].error);
+			} else {
+				printf("Wrong name filename %s\n", argv[2 * i + 2]);
+			}
+			exit_code = 1;
+		}
+		fds[i] = inputs[i].fd;
+	}
+
+	if (exit_code == 0) {
+		stream::run_stream(fds, (count == 0) ? 1 : count, options);
+	}
+	for (int i = 0; i < count; i++) {
+		if (fds[i] >= 0 && !compressed::close_input(inputs + i)) {
+			printf("Only a part of %s was read: compressed data is damaged or truncated\n", argv[2 * i + 2]);
+			exit_code = 1;
+		}
+	}
+	delete[] inputs;
+	delete[] fds;
+	return exit_code;
+}
+
+/**
+ * @brief   Polynomial mode of the program (--poly).
+ * @details Arguments must be "-f file" pairs with polynomials or "-t file" pairs with tests of polynomials; without arguments
+ * polynomials are read from stdin. Tests are run by test_polynomials, polynomials are solved and written to stdout in options->format.
+ * @param [in] argc     - Number of terminal arguments without options
+ * @param [in] **argv   - Terminal arguments without options
+ * @param [in] *options - Options of the program
+ * @return Exit code of the program
+ */
+static int run_polynomials(int argc, const char **argv, const options::Options *options) {
+	if (options->binary_out != NULL || argc % 2 == 0) {
+		printf("Only -f and -t files or stdin can have polynomials\n");
+		return 1;
+	}
+
+	quadratic::PolynomialArray polynomials = {}, tests = {};
+	uint64_t start = stats::stats_now();
+	if (argc == 1) {
+		quadratic::polynomial_stream_input(&polynomials, stdin);
+	}
+	for (int arg = 1; arg + 1 < argc; arg += 2) {
+		int test = strcmp(argv[arg], "-t") == 0;
+		compressed::Input source = {};
+		int opened = (test || strcmp(argv[arg], "-f") == 0) && compressed::open_input(&source, argv[arg + 1]);
+		FILE *input = opened ? compressed::input_stream(&source) : NULL;
+		if (input == NULL) {
+			if (source.error != NULL) {
+				printf("Unable to read %s: %s\n", argv[arg + 1], source.error);
+			} else {
+				printf("Wrong name filename %s\n", argv[arg + 1]);
+			}
+			if (opened) {
+				compressed::close_input(&source);
+			}
+			continue;
+		}
+		quadratic::polynomial_stream_input(test ? &tests : &polynomials, input, test ? quadratic::QD_DEBUG : quadratic::QD_NDEBUG);
+		if (!compressed::close_input(&source, input)) {
+			printf("Only a part of %s was read: compressed data is damaged or truncated\n", argv[arg + 1]);
+		}
+	}
+	stats::stats_stage(stats::SS_INPUT, stats::stats_now() - start, polynomials.size + tests.size);
+
+	int exit_code = 0;
+	if (tests.size != 0) {
+		exit_code = unit_tests::test_polynomials(&tests) ? 1 : 0;
+	}
+
+	start = stats::stats_now();
+	quadratic::solve_polynomials(polynomials.records, polynomials.size);
+	stats::stats_stage(stats::SS_SOLVE, stats::stats_now() - start, polynomials.size);
+
+	output::OutputBuffer out = {};
+	if (polynomials.size != 0 && output::make_output(&out, STDOUT_FILENO)) {
+		out.numbers = options->numbers;
+		start = stats::stats_now();
+		fflush(stdout);
+		output::write_polynomial_header(&out, options->format);
+		for (size_t i = 0; i < polynomials.size; i++) {
+			output::write_polynomial(&out, i + 1, polynomials.records + i, options->format);
+		}
+		exit_code |= output::free_output(&out) ? 0 : 1;
+		stats::stats_stage(stats::SS_OUTPUT, stats::stats_now() - start, polynomials.size);
+	}
+
+	quadratic::free_polynomials(&polynomials);
+	quadratic::free_polynomials(&tests);
+	return exit_code;
+}
+
+/**
+ * @brief   Self-tests of the program (--self-test).
+ * @details Arguments must be "-t file" pairs; without arguments tests are read from stdin. Tests of all files are given to
+ * unit_tests::self_test, which checks other solvers and modules of the program against solve_equation on them.
+ * @param [in] argc     - Number of terminal arguments without options
+ * @param [in] **argv   - Terminal arguments without options
+ * @param [in] *options - Options of the program
+ * @return Exit code of the program: 0 if every check passed and 1 otherwise
+ */
+static int run_self_test(int argc, const char **argv, const options::Options *options) {
+	if (options->binary_out != NULL || argc % 2 == 0) {
+		printf("Only -t files or stdin can have self-tests\n");
+		return 1;
+	}
+
+	quadratic::EquationArena tests = {};
+	int exit_code = 0;
+	if (argc == 1) {
+		parser::parse_fd(&tests, STDIN_FILENO, quadratic::QD_DEBUG);
+	}
+	for (int arg = 1; arg + 1 < argc; arg += 2) {
+		if (strcmp(argv[arg], "-t") != 0) {
+			printf("Only -t files or stdin can have self-tests\n");
+			exit_code = 1;
+			continue;
+		}
+
+		compressed::Input source = {};
+		int opened = compressed::open_input(&source, argv[arg + 1]);
+		FILE *input = opened ? compressed::input_stream(&source) : NULL;
+		if (input == NULL) {
+			printf("Wrong name filename %s\n", argv[arg + 1]);
+			if (opened) {
+				compressed::close_input(&source);
+			}
+			exit_code = 1;
+			continue;
+		}
+		parser::parse_stream(&tests, input, quadratic::QD_DEBUG);
+		if (!compressed::close_input(&source, input)) {
+			printf("Only a part of %s was read: compressed data is damaged or truncated\n", argv[arg + 1]);
+			exit_code = 1;
+		}
+	}
+
+	if (tests.size == 0) {
+		printf("No tests for self-tests\n");
+		exit_code = 1;
+	} else if (unit_tests::self_test(&tests) != 0) {
+		exit_code = 1;
+	}
+
+	quadratic::free_arena(&tests);
+	return exit_code;
+}
+
+/**
+ * @brief   Non-interactive mode of the program (--batch).
+ * @details Reads equations from terminal arguments or, if there are none, from stdin. Doesn't ask anything and doesn't print colors,
+ * results are written to stdout through OutputBuffer in options->format, or to a binary file if options->binary_out is set.
+ * If options have queries (--roots-in, --class, --top-k), only answers to them are written (look query.h). A --sweep is solved
+ * by run_sweep instead of input. With options->shard only the lines of its byte range of a single "-f file" are read (look shard.h).
+ * A single "-b file" with options->binary_out, --type long and without --cache and --stats is solved by run_binary.
+ * @param [in] argc     - Number of terminal arguments without options
+ * @param [in] **argv   - Terminal arguments without options
+ * @param [in] *options - Options of the program
+ * @return Exit code of the program: 1 if output failed or an input file could not be read completely (what was read is still solved)
+ */
+static int run_batch(int argc, const char **argv, const options::Options *options) {
+	if (options->sweep.enabled) {
+		return sweep::run_sweep(options, STDOUT_FILENO);
+	}
+	if (options->stream) {
+		return run_stream(argc, argv, options);
+	}
+	if (options->poly) {
+		return run_polynomials(argc, argv, options);
+	}
+	if (options->self_test) {
+		return run_self_test(argc, argv, options);
+	}
+	if (options->binary_out != NULL && argc == 3 && strcmp(argv[1], "-b") == 0 && options->type == quadratic::NT_LONG_DOUBLE &&
+	    !options->cache && !options->stats) {
+		return run_binary(argv[2], options);
+	}
+
+	if (options->shard.enabled && (argc != 3 || strcmp(argv[1], "-f") != 0)) {
+		printf("Only a single -f file can be sharded\n");
+		return 1;
+	}
+
+	quadratic::EquationArena equations = {};
+	uint64_t start = stats::stats_now();
+	int failed = 0;
+	int numequations = (options->shard.enabled) ? shard::shard_input(&equations, argv[2], &options->shard)
+	                 : (argc > 1)               ? quadratic::terminal_input(&equations, argc, argv, options, &failed)
+	                                            : parser::parse_fd(&equations, STDIN_FILENO, quadratic::QD_NDEBUG);
+	if (numequations < 0) {
+		quadratic::free_arena(&equations);
+		return 1;
+	}
+	stats::stats_stage(stats::SS_INPUT, stats::stats_now() - start, (size_t)numequations);
+	fflush(stdout);
+
+	quadratic::solve_equations(equations.records, (size_t)numequations, options);
+
+	if (options->binary_out != NULL) {
+		int written = binary::write_binary(options->binary_out, equations.records, (size_t)numequations, options->precision, 1);
+		quadratic::free_arena(&equations);
+		return (written && failed == 0) ? 0 : 1;
+	}
+
+	output::OutputBuffer out = {};
+	if (!output::make_output(&out, STDOUT_FILENO)) {
+		quadratic::free_arena(&equations);
+		return 1;
+	}
+	out.numbers = options->numbers;
+
+	start = stats::stats_now();
+	int indexed = 1;
+	if (options->roots_in || options->query_class || options->top_k != 0) {
+		indexed = query::write_queries(&out, equations.records, (size_t)numequations, options);
+	} else {
+		output::write_header(&out, options->format);
+		for (int i = 0; i < numequations; i++) {
+			output::write_equation(&out, (size_t)i + 1, equations.records + i, options->format);
+		}
+	}
+
+	int written = output::free_output(&out) && indexed;
+	stats::stats_stage(stats::SS_OUTPUT, stats::stats_now() - start, (size_t)numequations);
+	quadratic::free_arena(&equations);
+	return (written && failed == 0) ? 0 : 1;
+}
+
 int main(int argc, const char *argv[]) {
+	options::Options options = {};
+	if (!options::parse_options(&options, &argc, argv)) {
+		return 1;
+	}
+	if (options.stats && !stats::stats_enable(options.stats_format)) {
+		printf("Statistics are compiled out (_NSTATS)\n");
+	}
+
+	if (options.serve != NULL) {
+		return server::run_server(options.serve, &options) ? 0 : 1;
+	}
+	if (options.batch) {
+		return run_batch(argc, argv, &options);
+	}
+
 	printf("%s%s# Program for solving quadratic equations a * x^2 + b * x + c = 0\n", COLORS::T_BLUE, COLORS::T_ARTICLE);
 	printf("# By NThemeDEV (c) 2022 ver. 0.9%s\n", COLORS::T_GREEN);
 
-	quadratic::Equation **equations = NULL;
-	int numequations = quadratic::terminal_input(&equations, argc, argv);
+	quadratic::EquationArena equations = {};
+	uint64_t start = stats::stats_now();
+	int numequations = quadratic::terminal_input(&equations, argc, argv, &options);
+	stats::stats_stage(stats::SS_INPUT, stats::stats_now() - start, (size_t)numequations);
 
 	char inputmore = 0;
 	if (argc > 1) {		
@@ -29,10 +342,9 @@ int main(int argc, const char *argv[]) {
 			common::clearbuffer();
 		}
 
-		equations = quadratic::realloc_equations(equations, (size_t)(numequations + add));
 		for (int i = 0; i < add; i++) {
 			printf("Input a, b, c of %d your extra equation divided by space:%s ", i + 1, COLORS::T_GREEN);
-			if (equation_stream_input(&equations[numequations + i]) != 1) {
+			if (equation_stream_input(&equations) != 1) {
 				printf("%sWrong input! Try again. ", COLORS::T_RED);
 				common::clearbuffer();
 				i--;
@@ -41,19 +353,35 @@ int main(int argc, const char *argv[]) {
 		numequations += add;
 	}
 
+	int presolved = options.threads > 1 || options.type != quadratic::NT_LONG_DOUBLE || options.cache || stats::stats_enabled();
+	if (presolved) {
+		quadratic::solve_equations(equations.records, (size_t)numequations, &options);
+	}
+
+	start = stats::stats_now();
+	char a[format::NUMBER_LENGTH] = "", b[format::NUMBER_LENGTH] = "", c[format::NUMBER_LENGTH] = "";
 	for (int i = 0; i < numequations; i++) {
-		printf("%s\nEquation %3d with a = %+-10.5Lg b = %+-10.5Lg and c = %+-10.5Lg ", COLORS::T_GREEN, i + 1, equations[i]->a, equations[i]->b, equations[i]->c);
+		quadratic::Equation *equation = equations.records + i;
+		format::format_number(a, equation->a, options.numbers);
+		format::format_number(b, equation->b, options.numbers);
+		format::format_number(c, equation->c, options.numbers);
+		printf("%s\nEquation %3d with a = %s b = %s and c = %s ", COLORS::T_GREEN, i + 1, a, b, c);
 
-		if ((equations[i]->num_roots = quadratic::solve_equation(equations[i])) == quadratic::QE_QUAD_ERROR) {
+		if (!presolved) {
+			equation->num_roots = quadratic::solve_equation(equation);
+		}
+		if (equation->num_roots == quadratic::QE_QUAD_ERROR) {
 			printf("%sis unable to be solved!%s\n", COLORS::T_RED, COLORS::T_GREEN);
 		} else {
 			printf("has %s", COLORS::T_BLUE);
-			print_roots(equations[i]);
+			print_roots(equation, options.numbers);
 		}
 	}
 
 	printf("%s%s\n", COLORS::T_GREEN, COLORS::T_REGULAR);
+	fflush(stdout);
+	stats::stats_stage(stats::SS_OUTPUT, stats::stats_now() - start, (size_t)numequations);
 
-	free_equations(equations, numequations);
+	quadratic::free_arena(&equations);
 	return 0;
 }
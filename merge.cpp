@@ -0,0 +1,141 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "common.h"
+#include "shard.h"
+
+/// Option which is added to arguments of build/task.
+static char SHARD_OPTION[] = "--shard";
+
+/**
+ * @brief Writes outputs of shards to stdout in order by merge_outputs (look shard.h) and prints number of merged equations.
+ * @param [in] **files - Outputs of shards 0..count-1
+ * @param [in] count   - Number of shards
+ * @return Exit code of the program
+ */
+static int merge_files(FILE **files, int count) {
+	size_t merged = 0;
+	int written = shard::merge_outputs(files, count, STDOUT_FILENO, &merged);
+	fprintf(stderr, "Merged %zu equations of %d shards\n", merged, count);
+	return written ? 0 : 1;
+}
+
+/**
+ * @brief Runs count processes of build/task with --shard i/count and merges their outputs.
+ * @details build/task is taken from the directory of this program, outputs of shards are kept in temporary files.
+ * @param [in] *self   - Path of this program (argv[0])
+ * @param [in] count   - Number of shards
+ * @param [in] argc    - Number of arguments of build/task
+ * @param [in] **argv  - Arguments of build/task, without the program name
+ * @return Exit code of the program
+ */
+static int run_shards(const char *self, int count, int argc, char **argv) {
+	const char *slash = strrchr(self, '/');
+	size_t directory = (slash == NULL) ? 0 : (size_t)(slash - self) + 1;
+	char *task = (char *)calloc(directory + sizeof("task"), 1);
+	char **args = (char **)calloc((size_t)argc + 4, sizeof(char *));
+	FILE **files = (FILE **)calloc((size_t)count, sizeof(FILE *));
+	pid_t *children = (pid_t *)calloc((size_t)count, sizeof(pid_t));
+	if (task == NULL || args == NULL || files == NULL || children == NULL) {
+		printf("Unable to alloc memory for shards\n");
+		free(task);
+		free(args);
+		free(files);
+		free(children);
+		return 1;
+	}
+	memcpy(task, self, directory);
+	strcat(task, "task");
+
+	char spec[64] = "";
+	args[0] = task;
+	for (int arg = 0; arg < argc; arg++) {
+		args[arg + 1] = argv[arg];
+	}
+	args[argc + 1] = SHARD_OPTION;
+	args[argc + 2] = spec;
+
+	int exit_code = 0;
+	fflush(stdout);
+	for (int shard = 0; shard < count && exit_code == 0; shard++) {
+		snprintf(spec, sizeof(spec), "%d/%d", shard, count);
+		files[shard] = tmpfile();
+		children[shard] = (files[shard] != NULL) ? fork() : -1;
+		if (children[shard] == 0) {
+			dup2(fileno(files[shard]), STDOUT_FILENO);
+			execv(task, args);
+			fprintf(stderr, "Unable to run %s\n", task);
+			_exit(127);
+		}
+		if (children[shard] < 0) {
+			printf("Unable to start shard %d\n", shard);
+			exit_code = 1;
+		}
+	}
+
+	for (int shard = 0; shard < count; shard++) {
+		int status = 0;
+		if (children[shard] > 0 && (waitpid(children[shard], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)) {
+			fprintf(stderr, "Shard %d/%d failed\n", shard, count);
+			exit_code = 1;
+		}
+		if (files[shard] != NULL) {
+			rewind(files[shard]);
+		}
+	}
+
+	if (exit_code == 0) {
+		exit_code = merge_files(files, count);
+	}
+	for (int shard = 0; shard < count; shard++) {
+		if (files[shard] != NULL) {
+			fclose(files[shard]);
+		}
+	}
+	free(task);
+	free(args);
+	free(files);
+	free(children);
+	return exit_code;
+}
+
+int main(int argc, char *argv[]) {
+	if (argc >= 4 && strcmp(argv[1], "--run") == 0) {
+		char *end = NULL;
+		long count = strtol(argv[2], &end, 10);
+		if (end != argv[2] && *end == '\0' && count > 0 && (size_t)count <= shard::MAX_SHARDS) {
+			return run_shards(argv[0], (int)count, argc - 3, argv + 3);
+		}
+	} else if (argc >= 2 && strcmp(argv[1], "--run") != 0) {
+		int count = argc - 1, exit_code = 0;
+		FILE **files = (FILE **)calloc((size_t)count, sizeof(FILE *));
+		for (int shard = 0; files != NULL && shard < count && exit_code == 0; shard++) {
+			if ((files[shard] = fopen(argv[shard + 1], "r")) == NULL) {
+				printf("Wrong name filename %s\n", argv[shard + 1]);
+				exit_code = 1;
+			}
+		}
+
+		if (files == NULL) {
+			printf("Unable to alloc memory for shards\n");
+			return 1;
+		}
+		if (exit_code == 0) {
+			exit_code = merge_files(files, count);
+		}
+		for (int shard = 0; shard < count; shard++) {
+			if (files[shard] != NULL) {
+				fclose(files[shard]);
+			}
+		}
+		free(files);
+		return exit_code;
+	}
+
+	printf("Usage: %s shard_0.txt ... shard_N-1.txt\n"
+	       "       %s --run N [task options] -f equations.txt\n", argv[0], argv[0]);
+	return 1;
+}
@@ -0,0 +1,197 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "common.h"
+#include "options.h"
+#include "pool.h"
+#include "query.h"
+
+namespace options {
+    /**
+     * @brief Returns value of option given as "--name value" or "--name=value".
+     * @param [in]      *name - Name of option with "--"
+     * @param [in]      argc  - Number of terminal arguments
+     * @param [in]      **argv - Terminal arguments
+     * @param [in, out] *arg  - Index of current argument, increased if value is the next argument
+     * @return Value of option or NULL if current argument is not this option
+     */
+    static const char *option_value(const char *name, int argc, const char **argv, int *arg);
+
+    /**
+     * @brief Parses a number like strtold, whole string must be a number.
+     * @return 1 if value is a number and 0 otherwise
+     */
+    static int parse_number(const char *value, long double *number);
+
+    static const char *option_value(const char *name, int argc, const char **argv, int *arg) {
+        size_t length = strlen(name);
+        if (strncmp(argv[*arg], name, length) != 0)
+            return NULL;
+
+        if (argv[*arg][length] == '=')
+            return argv[*arg] + length + 1;
+        if (argv[*arg][length] != '\0')
+            return NULL;
+
+        return (*arg + 1 < argc) ? argv[++*arg] : "";
+    }
+
+    static int parse_number(const char *value, long double *number) {
+        char *end = NULL;
+        *number = strtold(value, &end);
+        return end != value && *end == '\0';
+    }
+
+    int parse_options(Options *options, int *argc, const char **argv) {
+        ASSERTIF(options != NULL, "nullptr in options", 0);
+        ASSERTIF(argc    != NULL, "nullptr in argc",    0);
+        ASSERTIF(argv    != NULL, "nullptr in argv",    0);
+
+        *options = {};
+        options->precision = binary::BP_LONG_DOUBLE;
+
+        int kept = 1;
+        for (int arg = 1; arg < *argc; ++arg) {
+            const char *value = NULL;
+            if (strncmp(argv[arg], "-j", 2) == 0) {
+                value = (argv[arg][2] != '\0') ? argv[arg] + 2 : (arg + 1 < *argc) ? argv[++arg] : "";
+                char *end = NULL;
+                long threads = strtol(value, &end, 10);
+                if (end == value || *end != '\0' || threads < 0 || threads > 4096) {
+                    printf("Wrong number of threads %s\n", value);
+                    return 0;
+                }
+                options->threads = (threads == 0) ? parallel::hardware_threads() : (int)threads;
+                continue;
+            }
+
+            if (strncmp(argv[arg], "--", 2) != 0) {
+                argv[kept++] = argv[arg];
+                continue;
+            }
+
+            if (strcmp(argv[arg], "--parse-rate") == 0) {
+                options->parse_rate = 1;
+            } else if (strcmp(argv[arg], "--fscanf") == 0) {
+                options->fscanf = 1;
+            } else if (strcmp(argv[arg], "--stream") == 0) {
+                options->stream = 1;
+                options->batch = 1;
+            } else if (strcmp(argv[arg], "--poly") == 0) {
+                options->poly = 1;
+                options->batch = 1;
+            } else if (strcmp(argv[arg], "--sweep-changes") == 0) {
+                options->sweep.changes = 1;
+                options->batch = 1;
+            } else if (strcmp(argv[arg], "--cache") == 0) {
+                options->cache = 1;
+            } else if (strcmp(argv[arg], "--bulk-tests") == 0) {
+                options->bulk_tests = 1;
+            } else if (strcmp(argv[arg], "--self-test") == 0) {
+                options->self_test = 1;
+                options->batch = 1;
+            } else if (strcmp(argv[arg], "--batch") == 0) {
+                options->batch = 1;
+            } else if (strncmp(argv[arg], "--stats", 7) == 0 && (argv[arg][7] == '\0' || argv[arg][7] == '=')) {
+                value = (argv[arg][7] == '=') ? argv[arg] + 8 : "table";
+                if (strcmp(value, "table") == 0) {
+                    options->stats_format = stats::SF_TABLE;
+                } else if (strcmp(value, "json") == 0) {
+                    options->stats_format = stats::SF_JSON;
+                } else {
+                    printf("Unknown format of statistics %s\n", value);
+                    return 0;
+                }
+                options->stats = 1;
+            } else if (strcmp(argv[arg], "--roots-in") == 0) {
+                if (arg + 2 >= *argc || !parse_number(argv[arg + 1], &options->roots_lo) || !parse_number(argv[arg + 2], &options->roots_hi)) {
+                    printf("Wrong range of --roots-in, expected two numbers lo hi\n");
+                    return 0;
+                }
+                arg += 2;
+                options->roots_in = 1;
+                options->batch = 1;
+            } else if ((value = option_value("--class", *argc, argv, &arg)) != NULL) {
+                if (!query::parse_class(value, &options->num_roots)) {
+                    printf("Unknown class %s\n", value);
+                    return 0;
+                }
+                options->query_class = 1;
+                options->batch = 1;
+            } else if ((value = option_value("--top-k", *argc, argv, &arg)) != NULL) {
+                char *end = NULL;
+                long long top_k = strtoll(value, &end, 10);
+                if (end == value || *end != '\0' || top_k <= 0) {
+                    printf("Wrong number of roots %s\n", value);
+                    return 0;
+                }
+                options->top_k = (size_t)top_k;
+                options->batch = 1;
+            } else if ((value = option_value("--format", *argc, argv, &arg)) != NULL) {
+                if (!output::parse_format(value, &options->format)) {
+                    printf("Unknown format %s\n", value);
+                    return 0;
+                }
+                options->batch = 1;
+            } else if ((value = option_value("--numbers", *argc, argv, &arg)) != NULL) {
+                if (!format::parse_number_format(value, &options->numbers)) {
+                    printf("Unknown format of numbers %s, expected fixed, shortest or hex\n", value);
+                    return 0;
+                }
+            } else if ((value = option_value("--sweep", *argc, argv, &arg)) != NULL) {
+                if (!sweep::parse_axis(&options->sweep, value)) {
+                    printf("Wrong sweep %s, expected a, b or c=value or start:stop:step\n", value);
+                    return 0;
+                }
+                options->batch = 1;
+            } else if ((value = option_value("--shard", *argc, argv, &arg)) != NULL) {
+                if (!shard::parse_shard(&options->shard, value)) {
+                    printf("Wrong shard %s, expected i/N with 0 <= i < N <= %zu\n", value, shard::MAX_SHARDS);
+                    return 0;
+                }
+                options->batch = 1;
+            } else if ((value = option_value("--serve", *argc, argv, &arg)) != NULL) {
+                if (*value == '\0') {
+                    printf("No path of socket for --serve\n");
+                    return 0;
+                }
+                options->serve = value;
+            } else if ((value = option_value("--binary-out", *argc, argv, &arg)) != NULL) {
+                options->binary_out = value;
+                options->batch = 1;
+            } else if ((value = option_value("--binary-precision", *argc, argv, &arg)) != NULL) {
+                if (strcmp(value, "double") == 0) {
+                    options->precision = binary::BP_DOUBLE;
+                } else if (strcmp(value, "long") == 0) {
+                    options->precision = binary::BP_LONG_DOUBLE;
+                } else {
+                    printf("Unknown precision %s\n", value);
+                    return 0;
+                }
+            } else if ((value = option_value("--type", *argc, argv, &arg)) != NULL) {
+                if (!quadratic::parse_number_type(value, &options->type)) {
+                    printf("Unknown type %s\n", value);
+                    return 0;
+                }
+            } else {
+                printf("Unknown option %s\n", argv[arg]);
+                return 0;
+            }
+        }
+
+        if (options->sweep.changes && !options->sweep.enabled) {
+            printf("No --sweep for --sweep-changes\n");
+            return 0;
+        }
+
+        if (options->shard.enabled && (options->stream || options->poly || options->sweep.enabled)) {
+            printf("--shard can't be used with --stream, --poly or --sweep\n");
+            return 0;
+        }
+
+        argv[kept] = NULL;
+        *argc = kept;
+        return 1;
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef OPTIONS_DEF
+#define OPTIONS_DEF
+
+#include "output.h"
+#include "binary.h"
+#include "precision.h"
+#include "stats.h"
+#include "sweep.h"
+#include "shard.h"
+
+/**
+ * @brief   This namespace includes command line options which are not equations or input files.
+ * @details Options start with "--", the only short option is -j. They are removed from argv by parse_options, so terminal_input sees only -f/-t flags and coefficients.
+ */
+namespace options {
+    /**
+     * @brief   A struct with all options of the program.
+     * @details Options made by parse_options from arguments without options mean default behavior.
+     * @param parse_rate - Print parsing speed of each input file (--parse-rate)
+     * @param fscanf     - Parse input files with fscanf instead of parser (--fscanf)
+     * @param threads    - Number of threads which solve equations (-j N, 0 means one thread without pool; -j 0 means all hardware threads)
+     * @param batch      - Non-interactive mode without prompt and colors, results are written through OutputBuffer (--batch)
+     * @param format     - Layout of results in batch mode (--format plain|csv|tsv, implies --batch)
+     * @param numbers    - Format of coefficients and roots in text output (--numbers fixed|shortest|hex, fixed by default, look format.h)
+     * @param binary_out - Name of binary file for results instead of text (--binary-out file, implies --batch)
+     * @param precision  - Precision of numbers in binary_out (--binary-precision double|long, long by default)
+     * @param type       - Type of numbers used to solve equations (--type float|double|long|quad, long by default)
+     * @param stream     - Read, solve and write at the same time by a pipeline of threads with constant memory (--stream, implies --batch)
+     * @param poly       - Input files and stdin have polynomials of any degree instead of quadratic equations (--poly, implies --batch)
+     * @param sweep      - Equations of a grid over coefficients instead of input (--sweep a|b|c=value|start:stop:step, --sweep-changes,
+     * implies --batch, look sweep.h)
+     * @param shard      - Solve only the i-th of N byte ranges of a single -f file (--shard i/N, implies --batch, look shard.h)
+     * @param serve      - Path of Unix domain socket of solver daemon (--serve path, look server.h)
+     * @param cache      - Solve equations through a cache of normalized coefficients (--cache, long double only)
+     * @param bulk_tests - Run tests of -t files on all threads, print only failures and a summary (--bulk-tests)
+     * @param self_test  - Check other solvers and modules against solve_equation on tests of -t files (--self-test, implies --batch)
+     * @param roots_in   - Write only roots in [roots_lo, roots_hi] (--roots-in lo hi, implies --batch, look query.h)
+     * @param query_class, num_roots - Write only equations with num_roots roots (--class zero|one|two|inf|error, implies --batch)
+     * @param top_k      - Write only top_k smallest positive roots (--top-k N, implies --batch)
+     * @param stats      - Measure stages and print report at exit (--stats or --stats=table|json)
+     * @param stats_format - Layout of report
+     */
+    typedef struct Options {
+        int parse_rate;
+        int fscanf;
+        int threads;
+        int batch;
+        output::OUTPUT_FORMAT format;
+        format::NUMBER_FORMAT numbers;
+        const char *binary_out;
+        binary::BINARY_PRECISION precision;
+        quadratic::NUMBER_TYPE type;
+        int stream;
+        int poly;
+        sweep::Sweep sweep;
+        shard::Shard shard;
+        const char *serve;
+        int cache;
+        int bulk_tests;
+        int self_test;
+        int roots_in;
+        long double roots_lo, roots_hi;
+        int query_class, num_roots;
+        size_t top_k;
+        int stats;
+        stats::STATS_FORMAT stats_format;
+    } Options;
+
+    /**
+     * @brief Parses options and removes them from argv.
+     * @param [out]     *options - Parsed options
+     * @param [in, out] *argc    - Number of terminal arguments, decreased by number of removed ones
+     * @param [in, out] **argv   - Terminal arguments, options are removed
+     * @return 1 if all options are known and 0 otherwise
+     */
+    int parse_options(Options *options, int *argc, const char **argv);
+}
+
+#endif
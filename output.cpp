@@ -0,0 +1,361 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "output.h"
+
+namespace output {
+    /**
+     * @brief Returns number of roots as it is written in num_roots column.
+     * @param [in] num_roots - Number of roots (look ROOT_NUMBER) or QE_QUAD_ERROR
+     * @return "0", "1", "2", "inf", "error" or "" for RN_DEFAULT
+     */
+    static const char *count_name(int num_roots);
+
+    /**
+     * @brief Writes all size bytes of data to fd, repeating write(2) if it was interrupted or partial.
+     * @return 1 if everything was written and 0 otherwise
+     */
+    static int write_all(int fd, const char *data, size_t size);
+
+    /**
+     * @brief Makes room for size more bytes: flushes buffer or, if it is in memory, grows it.
+     * @return void
+     */
+    static void make_room(OutputBuffer *out, size_t size);
+
+    /**
+     * @brief Appends a number of csv/tsv line with all digits: "%.21Lg" for NF_FIXED and format_number without '+' otherwise.
+     * @return void
+     */
+    static void output_value(OutputBuffer *out, long double value);
+
+    static int write_all(int fd, const char *data, size_t size) {
+        size_t written = 0;
+        while (written < size) {
+            ssize_t result = write(fd, data + written, size - written);
+            if (result < 0 && errno == EINTR)
+                continue;
+            if (result <= 0)
+                return 0;
+            written += (size_t)result;
+        }
+        return 1;
+    }
+
+    static void make_room(OutputBuffer *out, size_t size) {
+        if (out->fd != OUTPUT_MEMORY) {
+            output_flush(out);
+            return;
+        }
+
+        size_t capacity = (out->capacity != 0) ? out->capacity : OUTPUT_CAPACITY;
+        for (; capacity - out->size < size; capacity *= 2);
+
+        char *grown = (char *)realloc(out->data, capacity);
+        if (grown == NULL) {
+            out->failed = 1;
+            return;
+        }
+        out->data = grown;
+        out->capacity = capacity;
+    }
+
+    int make_output(OutputBuffer *out, int fd, size_t capacity) {
+        ASSERTIF(out != NULL, "nullptr in out", 0);
+
+        *out = {fd, (char *)malloc(capacity), 0, capacity, 0, format::NF_FIXED};
+        return out->data != NULL;
+    }
+
+    int output_flush(OutputBuffer *out) {
+        ASSERTIF(out != NULL, "nullptr in out", 0);
+
+        if (out->fd == OUTPUT_MEMORY)
+            return !out->failed;
+
+        out->failed |= !write_all(out->fd, out->data, out->size);
+        out->size = 0;
+        return !out->failed;
+    }
+
+    void output_write(OutputBuffer *out, const char *data, size_t size) {
+        ASSERTIF(out  != NULL, "nullptr in out",  );
+        ASSERTIF(data != NULL, "nullptr in data", );
+
+        if (out->size + size > out->capacity) {
+            make_room(out, size);
+        }
+        if (out->size + size > out->capacity) {
+            if (out->fd == OUTPUT_MEMORY)
+                return;
+
+            out->failed |= !write_all(out->fd, data, size);
+            return;
+        }
+
+        memcpy(out->data + out->size, data, size);
+        out->size += size;
+    }
+
+    void output_printf(OutputBuffer *out, const char *format, ...) {
+        ASSERTIF(out    != NULL, "nullptr in out",    );
+        ASSERTIF(format != NULL, "nullptr in format", );
+
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            va_list args;
+            va_start(args, format);
+            int length = vsnprintf(out->data + out->size, out->capacity - out->size, format, args);
+            va_end(args);
+
+            if (length < 0)
+                return;
+            if ((size_t)length < out->capacity - out->size) {
+                out->size += (size_t)length;
+                return;
+            }
+            make_room(out, (size_t)length + 1);
+            if (out->failed && out->fd == OUTPUT_MEMORY)
+                return;
+        }
+
+        // Text is longer than the whole buffer.
+        va_list args;
+        va_start(args, format);
+        char *text = NULL;
+        int length = vasprintf(&text, format, args);
+        va_end(args);
+
+        if (length >= 0) {
+            output_write(out, text, (size_t)length);
+            free(text);
+        }
+    }
+
+    void output_number(OutputBuffer *out, long double value, int width) {
+        ASSERTIF(out != NULL, "nullptr in out", );
+
+        if (out->size + format::NUMBER_LENGTH > out->capacity) {
+            make_room(out, format::NUMBER_LENGTH);
+        }
+        if (out->size + format::NUMBER_LENGTH > out->capacity) {
+            char text[format::NUMBER_LENGTH] = "";
+            output_write(out, text, format::format_number(text, value, out->numbers, width));
+            return;
+        }
+        out->size += format::format_number(out->data + out->size, value, out->numbers, width);
+    }
+
+    static void output_value(OutputBuffer *out, long double value) {
+        if (out->numbers == format::NF_FIXED) {
+            output_printf(out, "%.21Lg", value);
+            return;
+        }
+
+        char text[format::NUMBER_LENGTH] = "";
+        size_t length = format::format_number(text, value, out->numbers, 0), sign = (text[0] == '+');
+        output_write(out, text + sign, length - sign);
+    }
+
+    int free_output(OutputBuffer *out) {
+        if (out == NULL)
+            return 0;
+
+        int flushed = output_flush(out);
+        free(out->data);
+        *out = {};
+        return flushed;
+    }
+
+    int parse_format(const char *name, OUTPUT_FORMAT *format) {
+        ASSERTIF(name   != NULL, "nullptr in name",   0);
+        ASSERTIF(format != NULL, "nullptr in format", 0);
+
+        if (strcmp(name, "plain") == 0) {
+            *format = OF_PLAIN;
+        } else if (strcmp(name, "csv") == 0) {
+            *format = OF_CSV;
+        } else if (strcmp(name, "tsv") == 0) {
+            *format = OF_TSV;
+        } else {
+            return 0;
+        }
+        return 1;
+    }
+
+    void write_header(OutputBuffer *out, OUTPUT_FORMAT format) {
+        switch (format) {
+        case OF_CSV:
+            output_printf(out, "index,a,b,c,num_roots,x1,x2\n");
+            break;
+        case OF_TSV:
+            output_printf(out, "index\ta\tb\tc\tnum_roots\tx1\tx2\n");
+            break;
+        case OF_PLAIN:
+            break;
+        default:
+            ASSERTIF(0, "default case", );
+        }
+    }
+
+    void write_roots(OutputBuffer *out, const quadratic::Equation *equation) {
+        ASSERTIF(equation != NULL, "nullptr in equation", );
+
+        switch (equation->num_roots) {
+        case quadratic::RN_INF:
+            output_printf(out, "infinity of roots");
+            break;
+        case quadratic::RN_ZERO:
+            output_printf(out, "zero roots");
+            break;
+        case quadratic::RN_ONE:
+            output_printf(out, "one  root:  ");
+            output_number(out, equation->x1);
+            break;
+        case quadratic::RN_TWO:
+            output_printf(out, "two  roots: ");
+            output_number(out, equation->x1);
+            output_write(out, " ", 1);
+            output_number(out, equation->x2);
+            break;
+        case quadratic::RN_DEFAULT:
+            output_printf(out, "uninitialized");
+            break;
+        default:
+            ASSERTIF(0, "default case", );
+        }
+    }
+
+    static const char *count_name(int num_roots) {
+        switch (num_roots) {
+        case quadratic::RN_ZERO:
+            return "0";
+        case quadratic::RN_ONE:
+            return "1";
+        case quadratic::RN_TWO:
+            return "2";
+        case quadratic::RN_INF:
+            return "inf";
+        case quadratic::QE_QUAD_ERROR:
+            return "error";
+        default:
+            return "";
+        }
+    }
+
+    void write_equation(OutputBuffer *out, size_t index, const quadratic::Equation *equation, OUTPUT_FORMAT format) {
+        ASSERTIF(equation != NULL, "nullptr in equation", );
+
+        if (format == OF_PLAIN) {
+            output_printf(out, "Equation %3zu with a = ", index);
+            output_number(out, equation->a);
+            output_printf(out, " b = ");
+            output_number(out, equation->b);
+            output_printf(out, " and c = ");
+            output_number(out, equation->c);
+            output_write(out, " ", 1);
+            if (equation->num_roots == quadratic::QE_QUAD_ERROR) {
+                output_printf(out, "is unable to be solved!\n");
+            } else {
+                output_printf(out, "has ");
+                write_roots(out, equation);
+                output_write(out, "\n", 1);
+            }
+            return;
+        }
+
+        const char delimiter = (format == OF_TSV) ? '\t' : ',';
+        output_printf(out, "%zu%c", index, delimiter);
+        output_value(out, equation->a);
+        output_write(out, &delimiter, 1);
+        output_value(out, equation->b);
+        output_write(out, &delimiter, 1);
+        output_value(out, equation->c);
+        output_printf(out, "%c%s%c", delimiter, count_name(equation->num_roots), delimiter);
+        if (equation->num_roots == quadratic::RN_ONE || equation->num_roots == quadratic::RN_TWO) {
+            output_value(out, equation->x1);
+        }
+        output_write(out, &delimiter, 1);
+        if (equation->num_roots == quadratic::RN_TWO) {
+            output_value(out, equation->x2);
+        }
+        output_write(out, "\n", 1);
+    }
+
+    void write_root_header(OutputBuffer *out, OUTPUT_FORMAT format) {
+        if (format != OF_PLAIN) {
+            output_printf(out, "index%croot\n", (format == OF_TSV) ? '\t' : ',');
+        }
+    }
+
+    void write_root(OutputBuffer *out, size_t index, long double root, OUTPUT_FORMAT format) {
+        if (format == OF_PLAIN) {
+            output_printf(out, "Equation %3zu has root ", index);
+            output_number(out, root);
+        } else {
+            output_printf(out, "%zu%c", index, (format == OF_TSV) ? '\t' : ',');
+            output_value(out, root);
+        }
+        output_write(out, "\n", 1);
+    }
+
+    void write_polynomial_header(OutputBuffer *out, OUTPUT_FORMAT format) {
+        if (format != OF_PLAIN) {
+            const char delimiter = (format == OF_TSV) ? '\t' : ',';
+            output_printf(out, "index%cdegree%cnum_roots%croots\n", delimiter, delimiter, delimiter);
+        }
+    }
+
+    void write_polynomial(OutputBuffer *out, size_t index, const quadratic::Polynomial *polynomial, OUTPUT_FORMAT format) {
+        ASSERTIF(polynomial != NULL, "nullptr in polynomial", );
+
+        if (format == OF_PLAIN) {
+            output_printf(out, "Polynomial %3zu of degree %2d ", index, polynomial->degree);
+            switch (polynomial->num_roots) {
+            case quadratic::QE_QUAD_ERROR:
+                output_printf(out, "is unable to be solved!\n");
+                return;
+            case quadratic::POLY_INF_ROOTS:
+                output_printf(out, "has infinity of roots\n");
+                return;
+            case 0:
+                output_printf(out, "has zero roots\n");
+                return;
+            case 1:
+                output_printf(out, "has one  root:  ");
+                output_number(out, polynomial->roots[0]);
+                output_write(out, "\n", 1);
+                return;
+            default:
+                output_printf(out, "has %d roots:", polynomial->num_roots);
+                for (int i = 0; i < polynomial->num_roots; ++i) {
+                    output_write(out, " ", 1);
+                    output_number(out, polynomial->roots[i]);
+                }
+                output_write(out, "\n", 1);
+                return;
+            }
+        }
+
+        const char delimiter = (format == OF_TSV) ? '\t' : ',';
+        output_printf(out, "%zu%c%d%c", index, delimiter, polynomial->degree, delimiter);
+        if (polynomial->num_roots == quadratic::QE_QUAD_ERROR) {
+            output_printf(out, "error%c", delimiter);
+        } else if (polynomial->num_roots == quadratic::POLY_INF_ROOTS) {
+            output_printf(out, "inf%c", delimiter);
+        } else {
+            output_printf(out, "%d%c", polynomial->num_roots, delimiter);
+        }
+        for (int i = 0; i < polynomial->num_roots; ++i) {
+            if (i != 0) {
+                output_write(out, " ", 1);
+            }
+            output_value(out, polynomial->roots[i]);
+        }
+        output_write(out, "\n", 1);
+    }
+}
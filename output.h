@@ -0,0 +1,151 @@
+#ifndef OUTPUT_DEF
+#define OUTPUT_DEF
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "quadratic.h"
+#include "polynomial.h"
+#include "format.h"
+
+/**
+ * @brief   This namespace includes buffered output of results without colors.
+ * @details Text is collected in a large user-space buffer and written to file descriptor by one write(2) per block.
+ */
+namespace output {
+    /// Default size of OutputBuffer.
+    const size_t OUTPUT_CAPACITY = 1 << 20;
+
+    /// File descriptor of OutputBuffer which keeps text in memory: buffer grows instead of being written, flush does nothing.
+    const int OUTPUT_MEMORY = -1;
+
+    /// Enumerated type of data with layouts of results.
+    typedef enum {
+        OF_PLAIN, ///< Same lines as the interactive output, without colors
+        OF_CSV,   ///< index,a,b,c,num_roots,x1,x2
+        OF_TSV    ///< Same columns as OF_CSV divided by tabs
+    } OUTPUT_FORMAT;
+
+    /**
+     * @brief A buffer of output.
+     * @param fd       - File descriptor to write
+     * @param data     - Buffered text
+     * @param size     - Number of buffered bytes
+     * @param capacity - Size of data
+     * @param failed   - 1 if one of writes failed
+     * @param numbers  - Format of coefficients and roots, NF_FIXED after make_output
+     */
+    typedef struct {
+        int fd;
+        char *data;
+        size_t size, capacity;
+        int failed;
+        format::NUMBER_FORMAT numbers;
+    } OutputBuffer;
+
+    /**
+     * @brief Allocates an empty buffer.
+     * @param [out] *out     - Buffer to initialize
+     * @param [in]  fd       - File descriptor to write or OUTPUT_MEMORY
+     * @param [in]  capacity - Size of buffer (initial size for OUTPUT_MEMORY)
+     * @return 1 if memory was allocated and 0 otherwise
+     */
+    int make_output(OutputBuffer *out, int fd, size_t capacity = OUTPUT_CAPACITY);
+
+    /**
+     * @brief Writes buffered text to file descriptor.
+     * @param [in, out] *out - Buffer
+     * @return 1 if everything was written and 0 otherwise
+     */
+    int output_flush(OutputBuffer *out);
+
+    /**
+     * @brief Appends size bytes of data to buffer, flushes it if it is full.
+     * @return void
+     */
+    void output_write(OutputBuffer *out, const char *data, size_t size);
+
+    /**
+     * @brief Appends text formatted like printf to buffer.
+     * @return void
+     */
+    void output_printf(OutputBuffer *out, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+    /**
+     * @brief Appends a coefficient or a root formatted by format_number in out->numbers, directly into buffer.
+     * @param [in, out] *out  - Buffer
+     * @param [in]      value - Number
+     * @param [in]      width - Width of field
+     * @return void
+     */
+    void output_number(OutputBuffer *out, long double value, int width = format::NUMBER_WIDTH);
+
+    /**
+     * @brief Flushes buffer and frees it.
+     * @param [in] *out - Buffer
+     * @return 1 if everything was written and 0 otherwise
+     */
+    int free_output(OutputBuffer *out);
+
+    /**
+     * @brief Parses name of format.
+     * @param [in]  *name   - "plain", "csv" or "tsv"
+     * @param [out] *format - Parsed format
+     * @return 1 if name is known and 0 otherwise
+     */
+    int parse_format(const char *name, OUTPUT_FORMAT *format);
+
+    /**
+     * @brief Appends header line of format (nothing for OF_PLAIN).
+     * @return void
+     */
+    void write_header(OutputBuffer *out, OUTPUT_FORMAT format);
+
+    /**
+     * @brief Appends roots of equation like print_roots does.
+     * @return void
+     */
+    void write_roots(OutputBuffer *out, const quadratic::Equation *equation);
+
+    /**
+     * @brief Appends one line with solved equation.
+     * @details OF_PLAIN writes numbers by output_number. OF_CSV and OF_TSV keep all digits: "%.21Lg" for NF_FIXED, and
+     * format_number without sign '+' for other formats.
+     * @param [in, out] *out      - Buffer
+     * @param [in]      index     - Number of equation (from 1)
+     * @param [in]      *equation - Solved equation
+     * @param [in]      format    - Layout of line
+     * @return void
+     */
+    void write_equation(OutputBuffer *out, size_t index, const quadratic::Equation *equation, OUTPUT_FORMAT format);
+
+    /**
+     * @brief Appends header line of format for roots (nothing for OF_PLAIN).
+     */
+    void write_root_header(OutputBuffer *out, OUTPUT_FORMAT format);
+
+    /**
+     * @brief Appends one line with a root of equation (answer to a query, look query.h).
+     * @details OF_PLAIN writes "Equation index has root x", OF_CSV and OF_TSV have columns index and root.
+     */
+    void write_root(OutputBuffer *out, size_t index, long double root, OUTPUT_FORMAT format);
+
+    /**
+     * @brief Appends header line of format for polynomials (nothing for OF_PLAIN).
+     * @return void
+     */
+    void write_polynomial_header(OutputBuffer *out, OUTPUT_FORMAT format);
+
+    /**
+     * @brief Appends one line with solved polynomial (--poly).
+     * @details OF_PLAIN writes roots like print_polynomial, OF_CSV and OF_TSV have columns index, degree, num_roots and roots divided by spaces.
+     * @param [in, out] *out        - Buffer
+     * @param [in]      index       - Number of polynomial (from 1)
+     * @param [in]      *polynomial - Solved polynomial
+     * @param [in]      format      - Layout of line
+     * @return void
+     */
+    void write_polynomial(OutputBuffer *out, size_t index, const quadratic::Polynomial *polynomial, OUTPUT_FORMAT format);
+}
+
+#endif
@@ -0,0 +1,303 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "arena.h"
+#include "parser.h"
+
+namespace parser {
+    /// Size of chunk read by one read(2).
+    static const size_t CHUNK = 1 << 20;
+
+    /// Maximal number of significant digits which fit into uint64_t.
+    static const int MAX_DIGITS = 19;
+
+    /// Powers of ten which are exact in long double.
+    static const long double POW10[] = {
+        1e0L,  1e1L,  1e2L,  1e3L,  1e4L,  1e5L,  1e6L,  1e7L,  1e8L,  1e9L,  1e10L, 1e11L, 1e12L, 1e13L,
+        1e14L, 1e15L, 1e16L, 1e17L, 1e18L, 1e19L, 1e20L, 1e21L, 1e22L, 1e23L, 1e24L, 1e25L, 1e26L, 1e27L
+    };
+    static const int MAX_POW10 = (int)(sizeof(POW10) / sizeof(POW10[0])) - 1;
+
+    /**
+     * @brief Returns time of monotonic clock in seconds.
+     */
+    static double now();
+
+    /**
+     * @brief Parses numbers from buffer and appends complete groups to arena.
+     * @param [out]     *equations - Arena to append equations
+     * @param [in]      *buffer    - Buffer with data, buffer[limit] must be a space or '\0'
+     * @param [in, out] *pos       - Position of first not parsed character
+     * @param [in]      limit      - Where to stop
+     * @param [in, out] *group     - Numbers of current incomplete group
+     * @param [in, out] *filled    - Number of numbers in group
+     * @param [in]      test       - Mode of input
+     * @param [in, out] *numbers   - Number of parsed numbers
+     * @param [in]      target    - Stop when arena has target equations
+     * @return 1 if all numbers before limit (or target) were parsed and 0 if one of them can't be parsed
+     */
+    static int parse_buffer(quadratic::EquationArena *equations, const char *buffer, size_t *pos, size_t limit,
+                            long double *group, int *filled, quadratic::QUADRATIC_DEBUG test, size_t *numbers, size_t target);
+
+    /**
+     * @brief Moves not parsed data to the start of buffer and reads the next chunk, sets limit of parsing.
+     * @return 1 if buffer was refilled and 0 if it can't grow
+     */
+    static int refill(FdParser *parser);
+
+    static double now() {
+        timespec time = {};
+        clock_gettime(CLOCK_MONOTONIC, &time);
+        return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+    }
+
+    long double parse_number(const char *str, const char **end) {
+        const char *cur = str;
+        int negative = (*cur == '-');
+        if (*cur == '-' || *cur == '+')
+            ++cur;
+
+        uint64_t mantissa = 0;
+        int digits = 0, exponent = 0, any = 0;
+        for (; isdigit((unsigned char)*cur); ++cur, any = 1) {
+            if (mantissa == 0 && *cur == '0')
+                continue;
+            if (digits++ == MAX_DIGITS)
+                break;
+            mantissa = mantissa * 10 + (uint64_t)(*cur - '0');
+        }
+        if (*cur == '.') {
+            for (++cur; digits <= MAX_DIGITS && isdigit((unsigned char)*cur); ++cur, any = 1) {
+                if (mantissa == 0 && *cur == '0') {
+                    --exponent;
+                    continue;
+                }
+                if (digits++ == MAX_DIGITS)
+                    break;
+                mantissa = mantissa * 10 + (uint64_t)(*cur - '0');
+                --exponent;
+            }
+        }
+
+        // Like scanf, an exponent mark is consumed even without digits after it: "1e+" is 1.
+        if (any && (*cur == 'e' || *cur == 'E')) {
+            const char *exp = cur + 1;
+            int exp_negative = (*exp == '-');
+            if (*exp == '-' || *exp == '+')
+                ++exp;
+
+            int value = 0;
+            for (; isdigit((unsigned char)*exp); ++exp) {
+                if (value < 100000)
+                    value = value * 10 + (*exp - '0');
+            }
+            exponent += exp_negative ? -value : value;
+            cur = exp;
+        }
+
+        // Hex floats, infinities, NaNs, too long mantissas and huge exponents are left to strtold.
+        if (!any || digits > MAX_DIGITS || *cur == 'x' || *cur == 'X' || exponent > MAX_POW10 || exponent < -MAX_POW10) {
+            char *strtold_end = NULL;
+            long double value = strtold(str, &strtold_end);
+
+            const char *last = strtold_end, *digits_start = (*str == '-' || *str == '+') ? str + 1 : str;
+            if ((*last == 'x' || *last == 'X') && last == digits_start + 1 && *digits_start == '0') {
+                // scanf fails on "0x" without hex digits.
+                last = str;
+            } else if (last > str && (isdigit((unsigned char)last[-1]) || last[-1] == '.') && (*last == 'e' || *last == 'E')) {
+                last += (last[1] == '-' || last[1] == '+') ? 2 : 1;
+            }
+            *end = last;
+            return value;
+        }
+
+        long double value = (long double)mantissa;
+        if (mantissa != 0) {
+            value = (exponent >= 0) ? value * POW10[exponent] : value / POW10[-exponent];
+        }
+
+        *end = cur;
+        return negative ? -value : value;
+    }
+
+    static int parse_buffer(quadratic::EquationArena *equations, const char *buffer, size_t *pos, size_t limit,
+                            long double *group, int *filled, quadratic::QUADRATIC_DEBUG test, size_t *numbers, size_t target) {
+        const int group_size = (test == quadratic::QD_DEBUG) ? 6 : 3;
+
+        while (equations->size < target) {
+            for (; *pos < limit && isspace((unsigned char)buffer[*pos]); ++*pos);
+            if (*pos >= limit)
+                return 1;
+
+            const char *start = buffer + *pos, *end = start;
+            if (test == quadratic::QD_DEBUG && *filled == 3) {
+                char *strtol_end = NULL;
+                group[*filled] = (long double)(int)strtol(start, &strtol_end, 10);
+                end = strtol_end;
+            } else {
+                group[*filled] = parse_number(start, &end);
+            }
+            if (end == start)
+                return 0;
+
+            *pos += (size_t)(end - start);
+            ++*numbers;
+
+            if (++*filled == group_size) {
+                quadratic::Equation equation = {group[0], group[1], group[2], 0, 0, quadratic::RN_DEFAULT};
+                if (test == quadratic::QD_DEBUG) {
+                    equation.num_roots = (int)group[3];
+                    equation.x1 = group[4];
+                    equation.x2 = group[5];
+                }
+                if (quadratic::arena_push(equations, &equation) == NULL)
+                    return 0;
+                *filled = 0;
+            }
+        }
+        return 1;
+    }
+
+    int make_parser(FdParser *parser, int fd, quadratic::QUADRATIC_DEBUG test) {
+        ASSERTIF(parser != NULL, "nullptr in parser", 0);
+
+        *parser = {};
+        parser->fd = fd;
+        parser->test = test;
+        parser->valid = 1;
+        parser->capacity = CHUNK;
+        parser->buffer = (char *)malloc(CHUNK + 1);
+        return parser->buffer != NULL;
+    }
+
+    void free_parser(FdParser *parser) {
+        if (parser == NULL)
+            return;
+
+        free(parser->buffer);
+        *parser = {};
+    }
+
+    static int refill(FdParser *parser) {
+        char *buffer = parser->buffer;
+        memmove(buffer, buffer + parser->pos, parser->size - parser->pos);
+        parser->size -= parser->pos;
+        parser->pos = parser->limit = 0;
+
+        if (parser->size == parser->capacity) {
+            char *grown = (char *)realloc(buffer, parser->capacity * 2 + 1);
+            if (grown == NULL)
+                return 0;
+            buffer = parser->buffer = grown;
+            parser->capacity *= 2;
+        }
+
+        ssize_t got = read(parser->fd, buffer + parser->size, parser->capacity - parser->size);
+        if (got <= 0) {
+            parser->eof = 1;
+        } else {
+            parser->size  += (size_t)got;
+            parser->bytes += (size_t)got;
+        }
+        buffer[parser->size] = '\0';
+
+        // A number can't contain a space, so everything before the last space can be parsed without the next chunk.
+        size_t limit = parser->size;
+        if (!parser->eof) {
+            for (; limit > 0 && !isspace((unsigned char)buffer[limit - 1]); --limit);
+            limit -= (limit > 0);
+        }
+        parser->limit = limit;
+        return 1;
+    }
+
+    size_t parser_next(FdParser *parser, quadratic::EquationArena *equations, size_t max) {
+        ASSERTIF(parser    != NULL, "nullptr in parser",    0);
+        ASSERTIF(equations != NULL, "nullptr in equations", 0);
+
+        size_t first = equations->size, target = (max > SIZE_MAX - first) ? SIZE_MAX : first + max;
+        while (parser->valid) {
+            if (parser->pos < parser->limit) {
+                parser->valid = parse_buffer(equations, parser->buffer, &parser->pos, parser->limit, parser->group, &parser->filled,
+                                             parser->test, &parser->numbers, target);
+                if (equations->size >= target)
+                    break;
+            }
+
+            // Everything read is parsed: return equations before the next read(2) may block.
+            if (equations->size > first || parser->eof)
+                break;
+            if (!refill(parser)) {
+                parser->valid = 0;
+            }
+        }
+        return equations->size - first;
+    }
+
+    size_t parse_text(quadratic::EquationArena *equations, const char *text, size_t size, quadratic::QUADRATIC_DEBUG test) {
+        ASSERTIF(equations != NULL, "nullptr in equations", 0);
+        ASSERTIF(text      != NULL, "nullptr in text",      0);
+
+        long double group[6] = {};
+        int filled = 0;
+        size_t first = equations->size, pos = 0, numbers = 0;
+        parse_buffer(equations, text, &pos, size, group, &filled, test, &numbers, SIZE_MAX);
+        return equations->size - first;
+    }
+
+    int parse_fd(quadratic::EquationArena *equations, int fd, quadratic::QUADRATIC_DEBUG test, ParseStats *stats) {
+        ASSERTIF(equations != NULL, "nullptr in equations", 0);
+
+        double start = now();
+        size_t first = equations->size;
+
+        FdParser parser = {};
+        if (!make_parser(&parser, fd, test)) {
+            free_parser(&parser);
+            return 0;
+        }
+        while (parser_next(&parser, equations, SIZE_MAX) != 0);
+
+        if (stats != NULL) {
+            *stats = {parser.numbers, parser.bytes, now() - start};
+        }
+        free_parser(&parser);
+        return (int)(equations->size - first);
+    }
+
+    int parse_stream(quadratic::EquationArena *equations, FILE *stream, quadratic::QUADRATIC_DEBUG test, ParseStats *stats) {
+        ASSERTIF(stream != NULL, "nullptr in stream", 0);
+
+        return parse_fd(equations, fileno(stream), test, stats);
+    }
+
+    int scan_stream(quadratic::EquationArena *equations, FILE *stream, quadratic::QUADRATIC_DEBUG test, ParseStats *stats) {
+        ASSERTIF(stream    != NULL, "nullptr in stream",    0);
+        ASSERTIF(equations != NULL, "nullptr in equations", 0);
+
+        double start = now();
+        long begin = ftell(stream);
+        int read = quadratic::stream_input(equations, stream, test);
+
+        if (stats != NULL) {
+            size_t numbers = (size_t)read * ((test == quadratic::QD_DEBUG) ? 6 : 3);
+            long end = ftell(stream);
+            *stats = {numbers, (begin >= 0 && end >= begin) ? (size_t)(end - begin) : 0, now() - start};
+        }
+        return read;
+    }
+
+    void print_stats(const char *name, const ParseStats *stats) {
+        ASSERTIF(name  != NULL, "nullptr in name",  );
+        ASSERTIF(stats != NULL, "nullptr in stats", );
+
+        double rate = (stats->seconds > 0) ? (double)stats->numbers / stats->seconds : 0;
+        fprintf(stderr, "Parsed %zu numbers (%zu bytes) from %s in %.6f s: %.0f numbers/s\n", stats->numbers, stats->bytes, name, stats->seconds, rate);
+    }
+}
@@ -0,0 +1,131 @@
+#ifndef PARSER_DEF
+#define PARSER_DEF
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "quadratic.h"
+
+/**
+ * @brief   This namespace includes a fast parser of input files with coefficients.
+ * @details Parser reads file by large chunks with read(2) and converts numbers without scanf: decimal numbers with at most 19
+ * significant digits and small exponent are converted exactly by one long double multiplication or division, other ones by strtold.
+ * It accepts and rejects same data as equation_stream_input: reading stops at first number which can't be parsed, last incomplete
+ * group of numbers is thrown away.
+ */
+namespace parser {
+    /**
+     * @brief Statistics of one parsed file.
+     * @param numbers - Number of parsed numbers
+     * @param bytes   - Number of read bytes
+     * @param seconds - Time of parsing
+     */
+    typedef struct {
+        size_t numbers, bytes;
+        double seconds;
+    } ParseStats;
+
+    /**
+     * @brief   Incremental parser of a file descriptor.
+     * @details Keeps not parsed data and incomplete group of numbers between calls of parser_next.
+     * @param fd       - File descriptor
+     * @param test     - Mode of input
+     * @param buffer   - Read data, buffer[limit] is a space or '\0'
+     * @param capacity - Size of buffer without '\0'
+     * @param size     - Number of read bytes in buffer
+     * @param pos      - Position of first not parsed character
+     * @param limit    - Position where parsing of read data stops
+     * @param group    - Numbers of current incomplete group
+     * @param filled   - Number of numbers in group
+     * @param eof      - End of file was reached
+     * @param valid    - No number failed to parse
+     * @param numbers  - Number of parsed numbers
+     * @param bytes    - Number of read bytes
+     */
+    typedef struct {
+        int fd;
+        quadratic::QUADRATIC_DEBUG test;
+        char *buffer;
+        size_t capacity, size, pos, limit;
+        long double group[6];
+        int filled;
+        int eof, valid;
+        size_t numbers, bytes;
+    } FdParser;
+
+    /**
+     * @brief Allocates buffer of parser.
+     * @param [out] *parser - Parser to make
+     * @param [in]  fd      - File descriptor to read
+     * @param [in]  test    - Mode of input
+     * @return 1 if buffer was allocated and 0 otherwise
+     */
+    int make_parser(FdParser *parser, int fd, quadratic::QUADRATIC_DEBUG test);
+
+    /**
+     * @brief Frees buffer of parser.
+     * @return void
+     */
+    void free_parser(FdParser *parser);
+
+    /**
+     * @brief Appends at most max next equations to arena.
+     * @details Returns as soon as data which was already read is parsed and at least one equation was appended, so equations of a
+     * pipe come out without waiting for the next chunk. read(2) is called only when there is nothing to return.
+     * @param [in, out] *parser    - Parser
+     * @param [out]     *equations - Arena to append equations
+     * @param [in]      max        - Maximal number of equations to append
+     * @return number of appended equations, 0 only at the end of file or at a number which can't be parsed
+     */
+    size_t parser_next(FdParser *parser, quadratic::EquationArena *equations, size_t max);
+
+    /**
+     * @brief Appends equations of text in memory to arena, like parse_fd does for a file.
+     * @param [out] *equations - Arena to append equations
+     * @param [in]  *text      - Text, text[size] must be a character which can't continue a number (like '\0')
+     * @param [in]  size       - Size of text
+     * @param [in]  test       - Mode of input
+     * @return number of appended equations
+     */
+    size_t parse_text(quadratic::EquationArena *equations, const char *text, size_t size, quadratic::QUADRATIC_DEBUG test);
+
+    /**
+     * @brief Reads a plenty of Equation from file descriptor and appends them to arena.
+     * @details If test == QD_NDEBUG, reads groups of 3 numbers: a, b, c. If test == QD_DEBUG, groups of 6 numbers: a, b, c, num_roots, x1, x2.
+     * @param [out] *equations - Arena to append equations
+     * @param [in]  fd         - File descriptor to read until the end
+     * @param [in]  test       - Mode of input
+     * @param [out] *stats     - Statistics of parsing (may be NULL)
+     * @return number of equations that was read successfully
+     */
+    int parse_fd(quadratic::EquationArena *equations, int fd, quadratic::QUADRATIC_DEBUG test, ParseStats *stats = NULL);
+
+    /**
+     * @brief Same as parse_fd, but for FILE. Nothing must be read from stream before.
+     */
+    int parse_stream(quadratic::EquationArena *equations, FILE *stream, quadratic::QUADRATIC_DEBUG test, ParseStats *stats = NULL);
+
+    /**
+     * @brief Reads a plenty of Equation from stream by fscanf (stream_input) and measures it like parse_stream.
+     * @details Used to compare parser with the old path.
+     */
+    int scan_stream(quadratic::EquationArena *equations, FILE *stream, quadratic::QUADRATIC_DEBUG test, ParseStats *stats = NULL);
+
+    /**
+     * @brief Converts a number from the beginning of string like strtold, but faster for plain decimal numbers.
+     * @param [in]  *str - String, must be terminated by a character which can't continue a number
+     * @param [out] *end - Where to write pointer to first not parsed character (str if nothing was parsed)
+     * @return Parsed number
+     */
+    long double parse_number(const char *str, const char **end);
+
+    /**
+     * @brief Prints statistics of parsing to stderr.
+     * @param [in] *name  - Name of parsed file
+     * @param [in] *stats - Statistics
+     * @return void
+     */
+    void print_stats(const char *name, const ParseStats *stats);
+}
+
+#endif
@@ -0,0 +1,566 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+
+#include "common.h"
+#include "polynomial.h"
+
+namespace quadratic {
+    /// Maximal number of Aberth iterations.
+    static const int ABERTH_ITERATIONS = 500;
+
+    /// Aberth iteration stops when every correction is smaller than this part of its root (squared).
+    static const double ABERTH_PRECISION = 1e-28;
+
+    /// A complex root is real if its imaginary part is smaller than this part of its modulus plus 1.
+    static const long double REAL_TOLERANCE = 1e-6L;
+
+    /// Real roots which differ less than this part of their modulus plus 1 are one root.
+    static const long double SAME_TOLERANCE = 1e-6L;
+
+    /// Maximal number of Newton steps which refine a root.
+    static const int NEWTON_STEPS = 8;
+
+    /**
+     * @brief Polynomials of the same degree which are iterated together.
+     * @param degree       - Degree of all polynomials
+     * @param count        - Number of used lanes
+     * @param polynomials  - Polynomial of each lane
+     * @param scaled       - Scaled coefficients of each lane (look prepare)
+     * @param coefficients - Coefficients of monic polynomials, lane is the last index
+     * @param re, im       - Roots, lane is the last index
+     */
+    typedef struct {
+        int degree;
+        size_t count;
+        Polynomial *polynomials[POLY_LANES];
+        long double scaled[POLY_LANES][POLY_MAX_DEGREE + 1];
+        double coefficients[POLY_MAX_DEGREE + 1][POLY_LANES];
+        double re[POLY_MAX_DEGREE][POLY_LANES], im[POLY_MAX_DEGREE][POLY_LANES];
+    } AberthBlock;
+
+    /**
+     * @brief Scales coefficients of polynomial of degree 3 or higher so the largest of them is in [1, 2) and drops leading zeros.
+     * @details Scaling by a power of 2 is exact and doesn't change roots, but makes common::is_zero tests of quadratic factors relative.
+     * @param [in]  *polynomial - Polynomial
+     * @param [out] *scaled     - Coefficients from the first nonzero one
+     * @return Degree of scaled polynomial, QE_QUAD_ERROR if a coefficient is not finite or POLY_INF_ROOTS if all of them are zero
+     */
+    static int prepare(const Polynomial *polynomial, long double *scaled);
+
+    /**
+     * @brief Solves polynomial of degree 2 or lower by solve_equation.
+     * @param [in]  *coefficients - Coefficients from the leading one
+     * @param [in]  degree        - Degree
+     * @param [out] *roots        - Where to append roots
+     * @param [in]  count         - Number of roots in roots
+     * @return New number of roots or num_roots of Polynomial if it is not a number of roots
+     */
+    static int solve_low(const long double *coefficients, int degree, long double *roots, int count);
+
+    /**
+     * @brief The quadratic path: solves polynomial of degree 2 or lower like solve_low, roots are in ascending order.
+     * @return num_roots of Polynomial
+     */
+    static int solve_quadratic(const long double *coefficients, int degree, long double *roots);
+
+    /**
+     * @brief Returns the largest real root of x ^ 3 + a2 * x ^ 2 + a1 * x + a0 (Cardano or trigonometric form).
+     */
+    static long double cubic_root(long double a2, long double a1, long double a0);
+
+    /**
+     * @brief Solves cubic of scaled coefficients: splits off a real root and solves the rest by solve_low.
+     * @return Number of found roots (not refined)
+     */
+    static int solve_cubic(const long double *scaled, long double *roots);
+
+    /**
+     * @brief Solves quartic of scaled coefficients by Ferrari: splits it into two quadratics which are solved by solve_low.
+     * @return Number of found roots (not refined)
+     */
+    static int solve_quartic(const long double *scaled, long double *roots);
+
+    /**
+     * @brief Makes Newton steps while they make value of polynomial smaller.
+     * @return Refined root
+     */
+    static long double refine(const long double *scaled, int degree, long double root);
+
+    /**
+     * @brief Refines roots, sorts them and merges equal ones.
+     * @return Number of distinct roots
+     */
+    static int finish(const long double *scaled, int degree, long double *roots, int count);
+
+    /**
+     * @brief Adds polynomial to block (block->degree must be equal to degree).
+     */
+    static void aberth_push(AberthBlock *block, Polynomial *polynomial, const long double *scaled);
+
+    /**
+     * @brief Runs Aberth iteration on all lanes of block, writes real roots to polynomials and empties block.
+     */
+    static void aberth_run(AberthBlock *block);
+
+    Polynomial *polynomial_push(PolynomialArray *polynomials, const Polynomial *polynomial) {
+        ASSERTIF(polynomials != NULL, "nullptr in polynomials", NULL);
+        ASSERTIF(polynomial  != NULL, "nullptr in polynomial",  NULL);
+
+        if (polynomials->size == polynomials->capacity) {
+            size_t capacity = (polynomials->capacity == 0) ? 1024 : polynomials->capacity * 2;
+            Polynomial *grown = (Polynomial *)realloc(polynomials->records, capacity * sizeof(Polynomial));
+            if (grown == NULL)
+                return NULL;
+            polynomials->records = grown;
+            polynomials->capacity = capacity;
+        }
+
+        polynomials->records[polynomials->size] = *polynomial;
+        return polynomials->records + polynomials->size++;
+    }
+
+    void free_polynomials(PolynomialArray *polynomials) {
+        if (polynomials == NULL)
+            return;
+
+        free(polynomials->records);
+        *polynomials = {};
+    }
+
+    int polynomial_stream_input(PolynomialArray *polynomials, FILE *stream, QUADRATIC_DEBUG test) {
+        ASSERTIF(polynomials != NULL, "nullptr in polynomials", 0);
+        ASSERTIF(stream      != NULL, "nullptr in stream",      0);
+
+        int read = 0;
+        while (1) {
+            Polynomial polynomial = {};
+            if (fscanf(stream, "%d", &polynomial.degree) != 1 || polynomial.degree < 0 || polynomial.degree > POLY_MAX_DEGREE)
+                break;
+
+            int valid = 1;
+            for (int i = 0; i <= polynomial.degree && valid; ++i) {
+                valid = fscanf(stream, "%Lf", &polynomial.coefficients[i]) == 1;
+            }
+            if (valid && test == QD_DEBUG) {
+                valid = fscanf(stream, "%d", &polynomial.num_roots) == 1 && polynomial.num_roots <= polynomial.degree;
+                for (int i = 0; i < polynomial.num_roots && valid; ++i) {
+                    valid = fscanf(stream, "%Lf", &polynomial.roots[i]) == 1;
+                }
+            }
+            if (!valid || polynomial_push(polynomials, &polynomial) == NULL)
+                break;
+            ++read;
+        }
+        return read;
+    }
+
+    static int prepare(const Polynomial *polynomial, long double *scaled) {
+        int scale = INT_MIN;
+        for (int i = 0; i <= polynomial->degree; ++i) {
+            long double coefficient = polynomial->coefficients[i];
+            if (!isfinite(coefficient))
+                return QE_QUAD_ERROR;
+            if (fpclassify(coefficient) != FP_ZERO && ilogbl(coefficient) > scale) {
+                scale = ilogbl(coefficient);
+            }
+        }
+        if (scale == INT_MIN)
+            return POLY_INF_ROOTS;
+
+        int first = 0;
+        for (; fpclassify(polynomial->coefficients[first]) == FP_ZERO; ++first);
+        for (int i = first; i <= polynomial->degree; ++i) {
+            scaled[i - first] = scalbnl(polynomial->coefficients[i], -scale);
+        }
+        return polynomial->degree - first;
+    }
+
+    static int solve_low(const long double *coefficients, int degree, long double *roots, int count) {
+        Equation equation = {0, 0, 0, 0, 0, RN_DEFAULT};
+        long double *members[3] = {&equation.a, &equation.b, &equation.c};
+        for (int i = 0; i <= degree; ++i) {
+            if (!isfinite(coefficients[i]))
+                return QE_QUAD_ERROR;
+            *members[2 - degree + i] = coefficients[i];
+        }
+
+        switch (solve_equation(&equation)) {
+        case RN_TWO:
+            roots[count++] = equation.x2;
+            roots[count++] = equation.x1;
+            return count;
+        case RN_ONE:
+            roots[count++] = equation.x1;
+            return count;
+        case RN_ZERO:
+            return count;
+        case RN_INF:
+            return POLY_INF_ROOTS;
+        default:
+            return QE_QUAD_ERROR;
+        }
+    }
+
+    static int solve_quadratic(const long double *coefficients, int degree, long double *roots) {
+        int count = solve_low(coefficients, degree, roots, 0);
+        if (count == 2 && roots[0] > roots[1]) {
+            long double root = roots[0];
+            roots[0] = roots[1];
+            roots[1] = root;
+        }
+        return count;
+    }
+
+    static long double cubic_root(long double a2, long double a1, long double a0) {
+        long double shift = a2 / 3;
+        long double half  = (2 * a2 * a2 * a2 / 27 - a2 * a1 / 3 + a0) / 2;
+        long double third = (a1 - a2 * shift) / 3;
+        long double delta = half * half + third * third * third;
+
+        long double root = 0;
+        if (delta > 0) {
+            // One real root: u is taken with the sign which avoids cancellation, v = -third / u.
+            long double u = cbrtl(-half - copysignl(sqrtl(delta), half));
+            root = (fpclassify(u) == FP_ZERO) ? 0 : u - third / u;
+        } else if (third < 0) {
+            // Three real roots, the first one of trigonometric form is the largest.
+            long double radius = sqrtl(-third);
+            long double cosine = fmaxl(-1.0L, fminl(1.0L, -half / (radius * radius * radius)));
+            root = 2 * radius * cosl(acosl(cosine) / 3);
+        }
+        return root - shift;
+    }
+
+    static int solve_cubic(const long double *scaled, long double *roots) {
+        long double a = scaled[0];
+        long double root = refine(scaled, 3, cubic_root(scaled[1] / a, scaled[2] / a, scaled[3] / a));
+
+        // Division by (x - root) leaves a * x ^ 2 + b * x + c.
+        long double b = scaled[1] + a * root, c = scaled[2] + b * root;
+        long double quadratic[3] = {a, b, c};
+
+        roots[0] = root;
+        int count = solve_low(quadratic, 2, roots, 1);
+        return (count < 1) ? 1 : count;
+    }
+
+    static int solve_quartic(const long double *scaled, long double *roots) {
+        long double a = scaled[1] / scaled[0], b = scaled[2] / scaled[0], c = scaled[3] / scaled[0], d = scaled[4] / scaled[0];
+
+        // x = y - a / 4 gives y ^ 4 + p * y ^ 2 + q * y + r.
+        long double shift = a / 4, square = a * a;
+        long double p = b - 3 * square / 8;
+        long double q = c - a * b / 2 + square * a / 8;
+        long double r = d - a * c / 4 + square * b / 16 - 3 * square * square / 256;
+
+        int count = 0;
+        long double split = 0, m = 0;
+        if (!common::is_zero(q)) {
+            // (y ^ 2 + m) ^ 2 = (2m - p) * y ^ 2 - q * y + m ^ 2 - r is a difference of squares if m is a root of resolvent cubic.
+            m = cubic_root(-p / 2, -r, (4 * p * r - q * q) / 8);
+            split = (2 * m - p > 0) ? sqrtl(2 * m - p) : 0;
+        }
+
+        if (fpclassify(split) == FP_ZERO) {
+            // Biquadratic: z = y ^ 2.
+            long double squares[2] = {};
+            long double quadratic[3] = {1, p, r};
+            int found = solve_low(quadratic, 2, squares, 0);
+            for (int i = 0; i < found; ++i) {
+                if (squares[i] < 0)
+                    continue;
+                roots[count++] = sqrtl(squares[i]);
+                roots[count++] = -sqrtl(squares[i]);
+            }
+        } else {
+            long double first[3]  = {1,  split, m - q / (2 * split)};
+            long double second[3] = {1, -split, m + q / (2 * split)};
+            count = solve_low(first, 2, roots, 0);
+            count = solve_low(second, 2, roots, (count < 0) ? 0 : count);
+            count = (count < 0) ? 0 : count;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            roots[i] -= shift;
+        }
+        return count;
+    }
+
+    static long double refine(const long double *scaled, int degree, long double root) {
+        for (int step = 0; step < NEWTON_STEPS; ++step) {
+            long double value = scaled[0], derivative = 0;
+            for (int i = 1; i <= degree; ++i) {
+                derivative = derivative * root + value;
+                value = value * root + scaled[i];
+            }
+            if (fpclassify(value) == FP_ZERO || fpclassify(derivative) == FP_ZERO)
+                break;
+
+            long double next = root - value / derivative, next_value = scaled[0];
+            for (int i = 1; i <= degree; ++i) {
+                next_value = next_value * next + scaled[i];
+            }
+            if (!isfinite(next) || !(fabsl(next_value) < fabsl(value)))
+                break;
+            root = next;
+        }
+        return root;
+    }
+
+    static int finish(const long double *scaled, int degree, long double *roots, int count) {
+        for (int i = 0; i < count; ++i) {
+            roots[i] = refine(scaled, degree, roots[i]);
+        }
+
+        for (int i = 1; i < count; ++i) {
+            long double root = roots[i];
+            int j = i - 1;
+            for (; j >= 0 && roots[j] > root; --j) {
+                roots[j + 1] = roots[j];
+            }
+            roots[j + 1] = root;
+        }
+
+        int distinct = 0;
+        for (int i = 0; i < count; ++i) {
+            if (distinct > 0 && roots[i] - roots[distinct - 1] <= SAME_TOLERANCE * (1 + fabsl(roots[i])))
+                continue;
+            roots[distinct++] = roots[i];
+        }
+        return distinct;
+    }
+
+    static void aberth_push(AberthBlock *block, Polynomial *polynomial, const long double *scaled) {
+        size_t lane = block->count++;
+        block->polynomials[lane] = polynomial;
+        for (int i = 0; i <= block->degree; ++i) {
+            block->scaled[lane][i] = scaled[i];
+            block->coefficients[i][lane] = (double)(scaled[i] / scaled[0]);
+        }
+    }
+
+    static void aberth_run(AberthBlock *block) {
+        const int degree = block->degree;
+
+        // Free lanes repeat the first one, so every lane has a polynomial.
+        for (size_t lane = block->count; lane < POLY_LANES; ++lane) {
+            for (int i = 0; i <= degree; ++i) {
+                block->coefficients[i][lane] = block->coefficients[i][0];
+            }
+        }
+
+        // Start on a circle of radius 2 * max |c_k| ^ (1 / k), which contains all roots (Fujiwara).
+        for (size_t lane = 0; lane < POLY_LANES; ++lane) {
+            double radius = 0;
+            for (int i = 1; i <= degree; ++i) {
+                radius = fmax(radius, pow(fabs(block->coefficients[i][lane]), 1.0 / i));
+            }
+            radius = (radius > 0) ? 2 * radius : 1;
+            for (int k = 0; k < degree; ++k) {
+                double angle = 2 * M_PI * k / degree + 0.4;
+                block->re[k][lane] = radius * cos(angle);
+                block->im[k][lane] = radius * sin(angle);
+            }
+        }
+
+        // Lane loops are the innermost ones and run over rows of lanes, so every step is made for all lanes by vector instructions.
+        // Comparisons instead of fmax and division by infinity instead of a branch keep the loops free of calls and control flow.
+        for (int iteration = 0; iteration < ABERTH_ITERATIONS; ++iteration) {
+            double change[POLY_LANES] = {};
+            for (int k = 0; k < degree; ++k) {
+                double *re = block->re[k], *im = block->im[k];
+
+                // p(z) and p'(z) by Horner.
+                double pr[POLY_LANES], pi[POLY_LANES], dr[POLY_LANES] = {}, di[POLY_LANES] = {};
+                for (size_t lane = 0; lane < POLY_LANES; ++lane) {
+                    pr[lane] = 1;
+                    pi[lane] = 0;
+                }
+                for (int i = 1; i <= degree; ++i) {
+                    const double *coefficients = block->coefficients[i];
+                    for (size_t lane = 0; lane < POLY_LANES; ++lane) {
+                        double zr = re[lane], zi = im[lane];
+                        double next_dr = dr[lane] * zr - di[lane] * zi + pr[lane], next_di = dr[lane] * zi + di[lane] * zr + pi[lane];
+                        dr[lane] = next_dr;
+                        di[lane] = next_di;
+                        double next_pr = pr[lane] * zr - pi[lane] * zi + coefficients[lane], next_pi = pr[lane] * zi + pi[lane] * zr;
+                        pr[lane] = next_pr;
+                        pi[lane] = next_pi;
+                    }
+                }
+
+                // s = sum of 1 / (z - z_j) over other roots.
+                double sr[POLY_LANES] = {}, si[POLY_LANES] = {};
+                for (int j = 0; j < degree; ++j) {
+                    if (j == k)
+                        continue;
+
+                    const double *other_re = block->re[j], *other_im = block->im[j];
+                    for (size_t lane = 0; lane < POLY_LANES; ++lane) {
+                        double wr = re[lane] - other_re[lane], wi = im[lane] - other_im[lane], norm = wr * wr + wi * wi;
+                        norm = (norm > 1e-300) ? norm : 1e-300;
+                        sr[lane] += wr / norm;
+                        si[lane] -= wi / norm;
+                    }
+                }
+
+                // Correction p / (p' - p * s).
+                for (size_t lane = 0; lane < POLY_LANES; ++lane) {
+                    double zr = re[lane], zi = im[lane];
+                    double qr = dr[lane] - (pr[lane] * sr[lane] - pi[lane] * si[lane]);
+                    double qi = di[lane] - (pr[lane] * si[lane] + pi[lane] * sr[lane]), norm = qr * qr + qi * qi;
+                    double divisor = (norm > 0) ? norm : INFINITY;
+                    double cr = (pr[lane] * qr + pi[lane] * qi) / divisor;
+                    double ci = (pi[lane] * qr - pr[lane] * qi) / divisor;
+
+                    re[lane] = zr - cr;
+                    im[lane] = zi - ci;
+                    double step = (cr * cr + ci * ci) / (1 + zr * zr + zi * zi);
+                    change[lane] = (step > change[lane]) ? step : change[lane];
+                }
+            }
+
+            double largest = 0;
+            for (size_t lane = 0; lane < POLY_LANES; ++lane) {
+                largest = fmax(largest, change[lane]);
+            }
+            if (!(largest > ABERTH_PRECISION))
+                break;
+        }
+
+        for (size_t lane = 0; lane < block->count; ++lane) {
+            Polynomial *polynomial = block->polynomials[lane];
+            int count = 0;
+            for (int k = 0; k < degree; ++k) {
+                long double re = block->re[k][lane], im = block->im[k][lane];
+                if (isfinite(re) && fabsl(im) <= REAL_TOLERANCE * (1 + fabsl(re))) {
+                    polynomial->roots[count++] = re;
+                }
+            }
+            polynomial->num_roots = finish(block->scaled[lane], degree, polynomial->roots, count);
+        }
+        block->count = 0;
+    }
+
+    int solve_polynomial(Polynomial *polynomial) {
+        ASSERTIF(polynomial != NULL, "nullptr in polynomial", QE_QUAD_ERROR);
+        ASSERTIF(polynomial->degree >= 0 && polynomial->degree <= POLY_MAX_DEGREE, "wrong degree", QE_QUAD_ERROR);
+
+        if (polynomial->degree <= 2)
+            return polynomial->num_roots = solve_quadratic(polynomial->coefficients, polynomial->degree, polynomial->roots);
+
+        long double scaled[POLY_MAX_DEGREE + 1] = {};
+        int degree = prepare(polynomial, scaled);
+        int count = 0;
+        switch (degree) {
+        case QE_QUAD_ERROR:
+        case POLY_INF_ROOTS:
+            return polynomial->num_roots = degree;
+        case 0:
+        case 1:
+        case 2:
+            // Zero leading coefficients: same as the quadratic path for the rest of them.
+            return polynomial->num_roots = solve_quadratic(polynomial->coefficients + polynomial->degree - degree, degree, polynomial->roots);
+        case 3:
+            count = solve_cubic(scaled, polynomial->roots);
+            break;
+        case 4:
+            count = solve_quartic(scaled, polynomial->roots);
+            break;
+        default: {
+            AberthBlock *block = (AberthBlock *)calloc(1, sizeof(AberthBlock));
+            if (block == NULL)
+                return polynomial->num_roots = QE_QUAD_ERROR;
+
+            block->degree = degree;
+            aberth_push(block, polynomial, scaled);
+            aberth_run(block);
+            free(block);
+            return polynomial->num_roots;
+        }
+        }
+
+        return polynomial->num_roots = (count > 0) ? finish(scaled, degree, polynomial->roots, count) : count;
+    }
+
+    size_t solve_polynomials(Polynomial *polynomials, size_t size) {
+        ASSERTIF(polynomials != NULL || size == 0, "nullptr in polynomials", 0);
+
+        // Degree 4 and lower is solved at once, higher degrees are remembered and solved by blocks of the same degree.
+        int *degrees = (int *)calloc(size + 1, sizeof(int));
+        AberthBlock *block = (AberthBlock *)calloc(1, sizeof(AberthBlock));
+        if (degrees == NULL || block == NULL) {
+            free(degrees);
+            free(block);
+            size_t solved = 0;
+            for (size_t i = 0; i < size; ++i) {
+                solved += solve_polynomial(polynomials + i) != QE_QUAD_ERROR;
+            }
+            return solved;
+        }
+
+        long double scaled[POLY_MAX_DEGREE + 1] = {};
+        for (size_t i = 0; i < size; ++i) {
+            degrees[i] = (polynomials[i].degree > 4) ? prepare(polynomials + i, scaled) : polynomials[i].degree;
+            if (degrees[i] <= 4) {
+                solve_polynomial(polynomials + i);
+            }
+        }
+
+        for (int degree = 5; degree <= POLY_MAX_DEGREE; ++degree) {
+            block->degree = degree;
+            for (size_t i = 0; i < size; ++i) {
+                if (degrees[i] != degree)
+                    continue;
+
+                prepare(polynomials + i, scaled);
+                aberth_push(block, polynomials + i, scaled);
+                if (block->count == POLY_LANES) {
+                    aberth_run(block);
+                }
+            }
+            if (block->count != 0) {
+                aberth_run(block);
+            }
+        }
+
+        size_t solved = 0;
+        for (size_t i = 0; i < size; ++i) {
+            solved += polynomials[i].num_roots != QE_QUAD_ERROR;
+        }
+        free(degrees);
+        free(block);
+        return solved;
+    }
+
+    int print_polynomial(const Polynomial *polynomial, format::NUMBER_FORMAT numbers) {
+        ASSERTIF(polynomial != NULL, "nullptr in polynomial", QE_QUAD_ERROR);
+
+        char root[format::NUMBER_LENGTH] = "";
+        switch (polynomial->num_roots) {
+        case QE_QUAD_ERROR:
+            return QE_QUAD_ERROR;
+        case POLY_INF_ROOTS:
+            printf("infinity of roots");
+            break;
+        case 0:
+            printf("zero roots");
+            break;
+        case 1:
+            format::format_number(root, polynomial->roots[0], numbers);
+            printf("one  root:  %s", root);
+            break;
+        default:
+            printf("%d roots:", polynomial->num_roots);
+            for (int i = 0; i < polynomial->num_roots; ++i) {
+                format::format_number(root, polynomial->roots[i], numbers);
+                printf(" %s", root);
+            }
+            break;
+        }
+        return 0;
+    }
+}
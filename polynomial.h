@@ -0,0 +1,102 @@
+#ifndef POLYNOMIAL_DEF
+#define POLYNOMIAL_DEF
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "quadratic.h"
+
+/**
+ * @brief   Real roots of polynomials of degree up to POLY_MAX_DEGREE (--poly).
+ * @details Degree 2 and lower is solved by solve_equation, so a polynomial of degree 2 gets the same roots as the same Equation.
+ * Cubics and quartics are solved by closed forms (Cardano and Ferrari) which split them into a linear factor and a quadratic or into two
+ * quadratics, quadratic factors are solved by solve_equation too. Higher degrees are solved by Aberth iteration in double, solve_polynomials
+ * runs it on POLY_LANES polynomials of the same degree at once: their coefficients and roots are kept lane by lane, and the innermost
+ * loops of an iteration go across lanes, so compilers vectorize them (-O2 of GCC 12 and later). Cubics and quartics are solved one by one:
+ * closed forms take no iterations, but branch on signs of their discriminants and call cbrtl, acosl and sqrtl in long double, which
+ * has no vector instructions, so lanes would only add copying. Every root of degree 3 and higher is refined by Newton steps in long double.
+ */
+namespace quadratic {
+    /// Maximal degree of Polynomial.
+    const int POLY_MAX_DEGREE = 16;
+
+    /// Number of polynomials which are iterated together by solve_polynomials.
+    const size_t POLY_LANES = 8;
+
+    /// Number of roots of zero polynomial (num_roots of Polynomial).
+    const int POLY_INF_ROOTS = -2;
+
+    /**
+     * @brief   A polynomial coefficients[0] * x ^ degree + ... + coefficients[degree] and its real roots.
+     * @param degree       - Degree given in input (leading coefficients may be zero)
+     * @param coefficients - Coefficients from the leading one to the free one
+     * @param num_roots    - Number of distinct real roots, POLY_INF_ROOTS for zero polynomial or QE_QUAD_ERROR (RN_DEFAULT before solving)
+     * @param roots        - Real roots in ascending order
+     */
+    typedef struct {
+        int degree;
+        long double coefficients[POLY_MAX_DEGREE + 1];
+        int num_roots;
+        long double roots[POLY_MAX_DEGREE];
+    } Polynomial;
+
+    /**
+     * @brief Growing array of Polynomial records.
+     * @param records  - Records
+     * @param size     - Number of records
+     * @param capacity - Number of allocated records
+     */
+    typedef struct {
+        Polynomial *records;
+        size_t size, capacity;
+    } PolynomialArray;
+
+    /**
+     * @brief Appends a copy of polynomial to array.
+     * @return A pointer to new record or NULL if array can't grow
+     */
+    Polynomial *polynomial_push(PolynomialArray *polynomials, const Polynomial *polynomial);
+
+    /**
+     * @brief Frees records of array.
+     * @return void
+     */
+    void free_polynomials(PolynomialArray *polynomials);
+
+    /**
+     * @brief Reads polynomials from *stream and appends them to array.
+     * @details Like stream_input, but every record is degree and degree + 1 coefficients from the leading one. If test == QD_DEBUG, the
+     * record continues with number of roots and the roots. Reading stops at the first record which can't be read.
+     * @param [out] *polynomials - Array to append polynomials
+     * @param [in]  *stream      - Stream with input data
+     * @param [in]  test         - Mode of input
+     * @return number of polynomials that was read successfully
+     */
+    int polynomial_stream_input(PolynomialArray *polynomials, FILE *stream = stdin, QUADRATIC_DEBUG test = QD_NDEBUG);
+
+    /**
+     * @brief Solves a polynomial.
+     * @details Writes num_roots and roots. Degree 2 and lower is solved by solve_equation, 3 and 4 by closed forms, higher by Aberth
+     * iteration. Leading zero coefficients lower the degree, so "3 0 1 -3 2" is solved like Equation 1 -3 2.
+     * @param [in, out] *polynomial - Polynomial
+     * @return num_roots
+     */
+    int solve_polynomial(Polynomial *polynomial);
+
+    /**
+     * @brief Solves a plenty of polynomials.
+     * @details Same results as solve_polynomial for each of them, but polynomials of degree 5 and higher are iterated POLY_LANES at once.
+     * @param [in, out] *polynomials - Array of polynomials
+     * @param [in]      size         - Number of polynomials
+     * @return number of polynomials which were solved without QE_QUAD_ERROR
+     */
+    size_t solve_polynomials(Polynomial *polynomials, size_t size);
+
+    /**
+     * @brief Prints roots of Polynomial like print_roots.
+     * @return 0 if roots were written successfully and QE_QUAD_ERROR otherwise
+     */
+    int print_polynomial(const Polynomial *polynomial, format::NUMBER_FORMAT numbers = format::NF_FIXED);
+}
+
+#endif
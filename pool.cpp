@@ -0,0 +1,188 @@
+#include <stdio.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+#include "common.h"
+#include "pool.h"
+
+namespace parallel {
+    /**
+     * @brief Chunks of a worker: [front, back). Owner takes chunks from front, thieves from back.
+     */
+    struct Deque {
+        std::mutex lock;
+        size_t front, back;
+
+        Deque(): lock(), front(0), back(0) {}
+    };
+
+    /**
+     * @brief   A thread pool.
+     * @details Workers sleep on start until generation changes, run chunks of the job and decrease running.
+     */
+    struct ThreadPool {
+        int size;
+        std::vector<std::thread> threads;
+        std::vector<Deque> deques;
+
+        std::mutex lock;
+        std::condition_variable start, done;
+        unsigned long generation;
+        int running, stop;
+
+        TASK task;
+        void *context;
+        size_t job_size, chunk;
+
+        explicit ThreadPool(int workers): size(workers), threads(), deques((size_t)workers), lock(), start(), done(), generation(0),
+                                          running(0), stop(0), task(NULL), context(NULL), job_size(0), chunk(0) {}
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+    };
+
+    /**
+     * @brief Takes a chunk from worker's own deque or steals it from another one.
+     * @param [in]  *pool  - Pool
+     * @param [in]  worker - Number of worker
+     * @param [out] *chunk - Number of taken chunk
+     * @return 1 if chunk was taken and 0 if all chunks of job are taken
+     */
+    static int take_chunk(ThreadPool *pool, int worker, size_t *chunk);
+
+    /**
+     * @brief Runs chunks of current job until all of them are taken.
+     * @param [in] *pool  - Pool
+     * @param [in] worker - Number of worker
+     * @return void
+     */
+    static void run_chunks(ThreadPool *pool, int worker);
+
+    /**
+     * @brief Main function of pool's threads.
+     * @param [in] *pool  - Pool
+     * @param [in] worker - Number of worker
+     * @return void
+     */
+    static void worker_loop(ThreadPool *pool, int worker);
+
+    int hardware_threads() {
+        unsigned threads = std::thread::hardware_concurrency();
+        return (threads == 0) ? 1 : (int)threads;
+    }
+
+    static int take_chunk(ThreadPool *pool, int worker, size_t *chunk) {
+        {
+            Deque &own = pool->deques[(size_t)worker];
+            std::lock_guard<std::mutex> guard(own.lock);
+            if (own.front < own.back) {
+                *chunk = own.front++;
+                return 1;
+            }
+        }
+
+        for (int shift = 1; shift < pool->size; ++shift) {
+            Deque &victim = pool->deques[(size_t)((worker + shift) % pool->size)];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (victim.front < victim.back) {
+                *chunk = --victim.back;
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    static void run_chunks(ThreadPool *pool, int worker) {
+        size_t chunk = 0;
+        while (take_chunk(pool, worker, &chunk)) {
+            size_t begin = chunk * pool->chunk;
+            size_t end   = (begin + pool->chunk < pool->job_size) ? begin + pool->chunk : pool->job_size;
+            pool->task(pool->context, begin, end, worker);
+        }
+    }
+
+    static void worker_loop(ThreadPool *pool, int worker) {
+        unsigned long seen = 0;
+        while (1) {
+            {
+                std::unique_lock<std::mutex> guard(pool->lock);
+                pool->start.wait(guard, [&] { return pool->stop || pool->generation != seen; });
+                if (pool->stop)
+                    return;
+                seen = pool->generation;
+            }
+
+            run_chunks(pool, worker);
+
+            std::lock_guard<std::mutex> guard(pool->lock);
+            if (--pool->running == 0) {
+                pool->done.notify_all();
+            }
+        }
+    }
+
+    ThreadPool *make_pool(int threads) {
+        ASSERTIF(threads >= 0, "negative number of threads", NULL);
+
+        ThreadPool *pool = new ThreadPool(threads == 0 ? hardware_threads() : threads);
+        for (int worker = 1; worker < pool->size; ++worker) {
+            pool->threads.emplace_back(worker_loop, pool, worker);
+        }
+        return pool;
+    }
+
+    int pool_size(const ThreadPool *pool) {
+        ASSERTIF(pool != NULL, "nullptr in pool", 1);
+
+        return pool->size;
+    }
+
+    void pool_for(ThreadPool *pool, size_t size, size_t chunk, TASK task, void *context) {
+        ASSERTIF(pool != NULL, "nullptr in pool", );
+        ASSERTIF(task != NULL, "nullptr in task", );
+        ASSERTIF(chunk > 0,    "zero chunk",      );
+
+        if (size == 0)
+            return;
+
+        size_t chunks = (size + chunk - 1) / chunk, workers = (size_t)pool->size;
+        for (size_t worker = 0; worker < workers; ++worker) {
+            std::lock_guard<std::mutex> guard(pool->deques[worker].lock);
+            pool->deques[worker].front = chunks * worker / workers;
+            pool->deques[worker].back  = chunks * (worker + 1) / workers;
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(pool->lock);
+            pool->task     = task;
+            pool->context  = context;
+            pool->job_size = size;
+            pool->chunk    = chunk;
+            pool->running  = pool->size - 1;
+            ++pool->generation;
+        }
+        pool->start.notify_all();
+
+        run_chunks(pool, 0);
+
+        std::unique_lock<std::mutex> guard(pool->lock);
+        pool->done.wait(guard, [&] { return pool->running == 0; });
+    }
+
+    void free_pool(ThreadPool *pool) {
+        if (pool == NULL)
+            return;
+
+        {
+            std::lock_guard<std::mutex> guard(pool->lock);
+            pool->stop = 1;
+        }
+        pool->start.notify_all();
+
+        for (std::thread &thread : pool->threads) {
+            thread.join();
+        }
+        delete pool;
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef POOL_DEF
+#define POOL_DEF
+
+#include <stddef.h>
+
+/**
+ * @brief   This namespace includes a work-stealing thread pool.
+ * @details A job is a range of indices cut into chunks. At the start of a job every worker gets an equal contiguous part of chunks.
+ * A worker takes chunks from the front of its part, and when the part is empty it steals chunks from the back of other workers' parts,
+ * so workers which got cheap chunks help the ones which got expensive chunks.
+ */
+namespace parallel {
+    /**
+     * @brief   A function which processes a chunk of a job.
+     * @param [in] *context - Context given to pool_for
+     * @param [in] begin    - First index of chunk
+     * @param [in] end      - Index after the last index of chunk
+     * @param [in] worker   - Number of worker which runs the chunk, from 0 to pool_size() - 1
+     */
+    typedef void (*TASK)(void *context, size_t begin, size_t end, int worker);
+
+    /// Thread pool (look pool.cpp).
+    struct ThreadPool;
+
+    /**
+     * @brief Returns number of hardware threads.
+     * @return Number of hardware threads, at least 1
+     */
+    int hardware_threads();
+
+    /**
+     * @brief Starts a thread pool.
+     * @details Calling thread is worker 0, so threads - 1 threads are started.
+     * @param [in] threads - Number of workers (0 for hardware_threads())
+     * @return A pointer to pool or NULL in case of errors
+     */
+    ThreadPool *make_pool(int threads);
+
+    /**
+     * @brief Returns number of workers of pool.
+     * @param [in] *pool - Pool
+     * @return Number of workers
+     */
+    int pool_size(const ThreadPool *pool);
+
+    /**
+     * @brief Runs task for all chunks of [0, size) and waits until they are finished.
+     * @param [in] *pool    - Pool
+     * @param [in] size     - Number of indices
+     * @param [in] chunk    - Number of indices in one chunk
+     * @param [in] task     - Function to run
+     * @param [in] *context - Argument of task
+     * @return void
+     */
+    void pool_for(ThreadPool *pool, size_t size, size_t chunk, TASK task, void *context);
+
+    /**
+     * @brief Stops threads of the pool and frees it.
+     * @param [in] *pool - Pool to free
+     * @return void
+     */
+    void free_pool(ThreadPool *pool);
+}
+
+#endif
@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "common.h"
+#include "precision.h"
+#include "core.h"
+#include "adaptive.h"
+
+namespace quadratic {
+    int parse_number_type(const char *name, NUMBER_TYPE *type) {
+        ASSERTIF(name != NULL, "nullptr in name", 0);
+        ASSERTIF(type != NULL, "nullptr in type", 0);
+
+        if (strcmp(name, "float") == 0) {
+            *type = NT_FLOAT;
+        } else if (strcmp(name, "double") == 0) {
+            *type = NT_DOUBLE;
+        } else if (strcmp(name, "long") == 0) {
+            *type = NT_LONG_DOUBLE;
+        } else if (strcmp(name, "quad") == 0) {
+            *type = NT_FLOAT128;
+        } else if (strcmp(name, "adaptive") == 0) {
+            *type = NT_ADAPTIVE;
+        } else {
+            return 0;
+        }
+        return 1;
+    }
+
+    const char *number_type_name(NUMBER_TYPE type) {
+        switch (type) {
+        case NT_FLOAT:
+            return "float";
+        case NT_DOUBLE:
+            return "double";
+        case NT_LONG_DOUBLE:
+            return "long double";
+        case NT_FLOAT128:
+            return "__float128";
+        case NT_ADAPTIVE:
+            return "adaptive";
+        default:
+            return "unknown";
+        }
+    }
+
+    size_t solve_range_as(NUMBER_TYPE type, Equation *equations, size_t begin, size_t end) {
+        ASSERTIF(equations != NULL || begin == end, "nullptr in equations", 0);
+
+        switch (type) {
+        case NT_FLOAT:
+            return solve_range_as<float>(equations, begin, end);
+        case NT_DOUBLE:
+            return solve_range_as<double>(equations, begin, end);
+        case NT_FLOAT128:
+            return solve_range_as<__float128>(equations, begin, end);
+        case NT_ADAPTIVE:
+            return solve_adaptive(equations + begin, end - begin);
+        case NT_LONG_DOUBLE:
+            break;
+        default:
+            ASSERTIF(0, "default case", 0);
+        }
+
+        size_t solved = 0;
+        for (size_t i = begin; i < end; ++i) {
+            Equation *equation = equations + i;
+            solved += (equation->num_roots = store_roots(equation, solve_core_checked(equation->a, equation->b, equation->c))) != QE_QUAD_ERROR;
+        }
+        return solved;
+    }
+}
@@ -0,0 +1,113 @@
+#ifndef PRECISION_DEF
+#define PRECISION_DEF
+
+#include <stdio.h>
+#include <quadmath.h>
+
+#include "quadratic.h"
+#include "core.h"
+
+/**
+ * @brief   Solving equations in float, double, long double or __float128.
+ * @details Type and tolerance are template parameters of solve_equation<T, Tolerance>, so every instantiation has its own constexpr EPS
+ * and zero test. It is a wrapper over solve_core of core.h with the same tolerance policy. The program chooses instantiation by --type
+ * (look solve_range_as).
+ */
+namespace quadratic {
+    /// Enumerated type of data with types which solve_equations can use (look --type).
+    typedef enum {
+        NT_LONG_DOUBLE, ///< long double (default, same as solve_equation)
+        NT_FLOAT,       ///< float
+        NT_DOUBLE,      ///< double
+        NT_FLOAT128,    ///< __float128
+        NT_ADAPTIVE     ///< double, long double where double is not sure (look adaptive.h)
+    } NUMBER_TYPE;
+
+    /**
+     * @brief Parses name of number type.
+     * @param [in]  *name - "float", "double", "long", "quad" or "adaptive"
+     * @param [out] *type - Parsed type
+     * @return 1 if name is known and 0 otherwise
+     */
+    int parse_number_type(const char *name, NUMBER_TYPE *type);
+
+    /**
+     * @brief Returns name of number type in C++ ("long double" for NT_LONG_DOUBLE).
+     */
+    const char *number_type_name(NUMBER_TYPE type);
+
+    /// Machine epsilon of every type.
+    constexpr float       number_epsilon(float)       { return __FLT_EPSILON__;  }
+    constexpr double      number_epsilon(double)      { return __DBL_EPSILON__;  }
+    constexpr long double number_epsilon(long double) { return __LDBL_EPSILON__; }
+    constexpr __float128  number_epsilon(__float128)  { return FLT128_EPSILON;   }
+
+    /**
+     * @brief   Relative zero test: |val| <= EPS * scale (a tolerance policy like AbsoluteTolerance of core.h).
+     * @details Coefficients are compared with the largest of |a|, |b|, |c|, discriminant with the largest of b ^ 2 and |4 * a * c|, so
+     * result doesn't change if the whole equation is multiplied by a number. EPS is 64 machine epsilons of T.
+     */
+    template <typename T>
+    struct RelativeTolerance {
+        static constexpr T EPS = 64 * number_epsilon(T());
+
+        static constexpr int is_zero(T val, T scale) noexcept { return core_abs(val) <= EPS * scale; }
+    };
+
+    /// Tolerance used by solve_equation<T> by default: relative for float, because 1e-7 is about precision of float itself, absolute otherwise.
+    template <typename T> struct DefaultTolerance        : AbsoluteTolerance<T>     {};
+    template <>           struct DefaultTolerance<float> : RelativeTolerance<float> {};
+
+    /**
+     * @brief Solves a quadratic equation in type T.
+     * @details Same as store_roots(solve_core_checked<T, Tolerance>(...)): branches of solve_equation with zero tests made by
+     * Tolerance::is_zero. Writes roots to x1 and x2 if they exist, otherwise doesn't change them. Doesn't print anything.
+     * @param [in] *equation - A pointer to equation.
+     * @return number of roots (look ROOT_NUMBER) or QE_QUAD_ERROR if a coefficient is not finite
+     */
+    template <typename T, typename Tolerance = DefaultTolerance<T>>
+    int solve_equation(BasicEquation<T> *equation) {
+        if (equation == NULL)
+            return QE_QUAD_ERROR;
+        return store_roots(equation, solve_core_checked<T, Tolerance>(equation->a, equation->b, equation->c));
+    }
+
+    /**
+     * @brief Solves equations [begin, end) in type T and writes results back into long double equations.
+     * @param [in, out] *equations - Array of equations
+     * @param [in]      begin      - First equation
+     * @param [in]      end        - Index after the last equation
+     * @return number of equations which were solved without QE_QUAD_ERROR
+     */
+    template <typename T>
+    size_t solve_range_as(Equation *equations, size_t begin, size_t end) {
+        const size_t BLOCK = 64;
+        BasicEquation<T> block[BLOCK];
+
+        size_t solved = 0;
+        for (; begin < end; begin += BLOCK) {
+            size_t size = (end - begin < BLOCK) ? end - begin : BLOCK;
+            for (size_t i = 0; i < size; ++i) {
+                const Equation *equation = equations + begin + i;
+                block[i] = {(T)equation->a, (T)equation->b, (T)equation->c, (T)equation->x1, (T)equation->x2, equation->num_roots};
+            }
+            for (size_t i = 0; i < size; ++i) {
+                Equation *equation = equations + begin + i;
+                solved += (equation->num_roots = solve_equation<T>(&block[i])) != QE_QUAD_ERROR;
+                equation->x1 = (long double)block[i].x1;
+                equation->x2 = (long double)block[i].x2;
+            }
+        }
+        return solved;
+    }
+
+    /**
+     * @brief Solves equations [begin, end) in type chosen at run time.
+     * @details NT_LONG_DOUBLE uses solve_core_checked inlined into the loop (same roots as solve_equation), NT_ADAPTIVE uses
+     * solve_adaptive, other types use solve_range_as<T>.
+     * @return number of equations which were solved without QE_QUAD_ERROR
+     */
+    size_t solve_range_as(NUMBER_TYPE type, Equation *equations, size_t begin, size_t end);
+}
+
+#endif
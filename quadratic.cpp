@@ -1,19 +1,102 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 
 #include "common.h"
 #include "test.h"
 #include "quadratic.h"
+#include "core.h"
+#include "arena.h"
+#include "parser.h"
+#include "options.h"
+#include "binary.h"
+#include "stats.h"
+#include "pool.h"
+#include "compressed.h"
 
 namespace quadratic {
     /**
-     * @brief Solving linear equation
-     * @param b  - Coefficient of x
-     * @param c  - Free coefficient
-     * @param x1 - Root
-     * @return number of roots to num_roots (look ROOT_NUMBER)
+     * @brief Reads one Equation from *stream without allocating it
+     * @param [out] *equation - Where to write read equation
+     * @param [in]  *stream   - Stream with input data
+     * @param [in]  test      - Mode of input (look equation_stream_input)
+     * @return 1 if equation was read successfully and 0 otherwise
      */
-    static int solve_linear(long double b, long double c, long double *x1);
+    static int read_equation(Equation *equation, FILE *stream, QUADRATIC_DEBUG test);
+
+    /**
+     * @brief Appends copies of arena's records to an array of pointers made by make_equation.
+     * @param [in, out] ***equations - Array of pointers to reallocate
+     * @param [in]      start_index  - Current size of equations
+     * @param [in]      *arena       - Records to copy
+     * @return number of copied records
+     */
+    static int copy_arena(Equation ***equations, int start_index, const EquationArena *arena);
+
+    /// Maximal number of threads which read text files given by -f and -t flags at once.
+    static const int MAX_READERS = 16;
+
+    /**
+     * @brief   A file given by -f, -t or -b flag.
+     * @details Text files are parsed by parse_file, concurrently if there are several of them, but results are taken in the order of
+     * command line (look terminal_input).
+     * @param flag      - Letter of flag
+     * @param name      - Name of file
+     * @param equations - Equations of text file if it was parsed concurrently
+     * @param stats     - Statistics of parser
+     * @param read      - Number of equations that was read successfully
+     * @param opened    - 1 if file was opened and 0 otherwise
+     * @param error     - Reason why compressed file wasn't opened or wasn't read to the end (look compressed.h), NULL otherwise
+     */
+    typedef struct {
+        char flag;
+        const char *name;
+        EquationArena equations;
+        parser::ParseStats stats;
+        int read, opened;
+        const char *error;
+    } InputFile;
+
+    /**
+     * @brief Context of read_task.
+     * @param files    - Files from command line
+     * @param *options - Options of the program (may be NULL)
+     */
+    typedef struct {
+        InputFile *files;
+        const options::Options *options;
+    } ReadContext;
+
+    /**
+     * @brief Opens text file given by -f or -t flag and reads a plenty of Equation from it.
+     * @details Only opens the file and reads it, doesn't print anything (look report_file), so it can be run on any thread.
+     * @param [in, out] *file      - File
+     * @param [out]     *equations - Arena to append equations
+     * @param [in]      *options   - Options of the program (may be NULL)
+     * @return void
+     */
+    static void parse_file(InputFile *file, EquationArena *equations, const options::Options *options);
+
+    /**
+     * @brief Task of thread pool: parses text files [begin, end) into their own arenas.
+     */
+    static void read_task(void *context, size_t begin, size_t end, int worker);
+
+    /**
+     * @brief Parses all text files concurrently on a pool of readers, each into its own arena.
+     * @param [in, out] *files   - Files from command line
+     * @param [in]      size     - Number of files
+     * @param [in]      readers  - Number of threads
+     * @param [in]      *options - Options of the program (may be NULL)
+     * @return void
+     */
+    static void read_files(InputFile *files, int size, int readers, const options::Options *options);
+
+    /**
+     * @brief Prints errors and statistics of parsed file like it was read right now.
+     * @return 1 if equations of file must be taken and 0 otherwise
+     */
+    static int report_file(const InputFile *file, const options::Options *options);
 
     /**
      * @brief Check if Equation is valid without errors
@@ -56,19 +139,17 @@ namespace quadratic {
         free(equations);
     }
 
-    int equation_stream_input(Equation **equation, void *param, QUADRATIC_DEBUG test) {
-        ASSERTIF(param   != NULL, "nullptr in stream",   0);
+    static int read_equation(Equation *equation, FILE *stream, QUADRATIC_DEBUG test) {
+        ASSERTIF(stream   != NULL, "nullptr in stream",   0);
         ASSERTIF(equation != NULL, "nullptr in equation", 0);
 
-        FILE *stream = (FILE *)param;
-
         if(test == QD_NDEBUG) {
             long double a = NAN, b = NAN, c = NAN;
             if (fscanf(stream, "%Lf %Lf %Lf", &a, &b, &c) != 3) {
                 return 0;
             }
 
-            *equation = make_equation(a, b, c);
+            *equation = {a, b, c, 0, 0, RN_DEFAULT};
         } else if (test == QD_DEBUG) {
             long double a = NAN, b = NAN, c = NAN, x1 = NAN, x2 = NAN;
             int num_roots = quadratic::RN_DEFAULT;
@@ -76,15 +157,36 @@ namespace quadratic {
                 return 0;
             }
 
-            *equation = make_equation(a, b, c, num_roots, x1, x2);
+            *equation = {a, b, c, x1, x2, num_roots};
         } else {
             printf("Unknown input mode\n");
             return 0;
         }
-        
+
+        return 1;
+    }
+
+    int equation_stream_input(Equation **equation, void *param, QUADRATIC_DEBUG test) {
+        ASSERTIF(param   != NULL, "nullptr in stream",   0);
+        ASSERTIF(equation != NULL, "nullptr in equation", 0);
+
+        Equation read = {};
+        if (!read_equation(&read, (FILE *)param, test)) {
+            return 0;
+        }
+
+        *equation = make_equation(read.a, read.b, read.c, read.num_roots, read.x1, read.x2);
         return 1;
     }
 
+    int equation_stream_input(EquationArena *equations, FILE *stream, QUADRATIC_DEBUG test) {
+        ASSERTIF(stream    != NULL, "nullptr in stream",    0);
+        ASSERTIF(equations != NULL, "nullptr in equations", 0);
+
+        Equation read = {};
+        return read_equation(&read, stream, test) && arena_push(equations, &read) != NULL;
+    }
+
     int equation_terminal_input(Equation **equation, const char **input) {
         ASSERTIF(input    != NULL, "nullptr in argv",     0);
         ASSERTIF(equation != NULL, "nullptr in equation", 0);
@@ -98,80 +200,212 @@ namespace quadratic {
         return 1;
     }
 
+    int equation_terminal_input(EquationArena *equations, const char **input) {
+        ASSERTIF(input     != NULL, "nullptr in argv",      0);
+        ASSERTIF(equations != NULL, "nullptr in equations", 0);
+
+        long double a = NAN, b = NAN, c = NAN;
+        if (sscanf(*input, "%Lf", &a) + sscanf(*(input + 1), "%Lf", &b) + sscanf(*(input + 2), "%Lf", &c) != 3) {
+            return 0;
+        }
+
+        Equation read = {a, b, c, 0, 0, RN_DEFAULT};
+        return arena_push(equations, &read) != NULL;
+    }
+
+    static int copy_arena(Equation ***equations, int start_index, const EquationArena *arena) {
+        int size = (int)arena->size;
+        *equations = realloc_equations(*equations, (size_t)(start_index + size + 1));
+
+        for (int i = 0; i < size; ++i) {
+            const Equation *record = arena->records + i;
+            (*equations)[start_index + i] = make_equation(record->a, record->b, record->c, record->num_roots, record->x1, record->x2);
+        }
+        return size;
+    }
+
     int stream_input(Equation ***equations, FILE *stream, int start_index, QUADRATIC_DEBUG test) {
         ASSERTIF(stream    != NULL, "nullptr in stream",    0);
         ASSERTIF(equations != NULL, "nullptr in equations", 0);
 
-        size_t size = (size_t)start_index + 1;
-        *equations = realloc_equations(*equations, size);
+        EquationArena read = {};
+        stream_input(&read, stream, test);
+
+        int size = copy_arena(equations, start_index, &read);
+        free_arena(&read);
+        return size;
+    }
+
+    int stream_input(EquationArena *equations, FILE *stream, QUADRATIC_DEBUG test) {
+        ASSERTIF(stream    != NULL, "nullptr in stream",    0);
+        ASSERTIF(equations != NULL, "nullptr in equations", 0);
 
-        Equation *equation = NULL;
         int read = 0;
-        for (; equation_stream_input(&equation, (void *)stream, test) == 1; ++read) {
-            if (read + start_index == (int)size) {
-                *equations = realloc_equations(*equations, (size *= 2));
-            }
-            (*equations)[read + start_index] = equation;
-        }
-        *equations = realloc_equations(*equations, (size_t)(read + 1));
+        for (; equation_stream_input(equations, stream, test) == 1; ++read);
 
-        return read;    
+        return read;
     }
 
     int terminal_input(Equation ***equations, int argc, const char **argv) {
         ASSERTIF(argv      != NULL, "nullptr in argv",      0);
         ASSERTIF(equations != NULL, "nullptr in equations", 0);
 
-        Equation **tests = NULL;
+        EquationArena read = {};
+        terminal_input(&read, argc, argv);
 
-        int file_flag = 1, num_equations = 0, num_tests = 0;
-        for (; file_flag < argc - 1; file_flag += 2) {
-            if (argv[file_flag][0] != '-') {
-                break;
+        int size = copy_arena(equations, 0, &read);
+        free_arena(&read);
+        return size;
+    }
+
+    static void parse_file(InputFile *file, EquationArena *equations, const options::Options *options) {
+        compressed::Input source = {};
+        int opened = compressed::open_input(&source, file->name);
+        FILE *input = opened ? compressed::input_stream(&source) : NULL;
+        if (input == NULL) {
+            file->error = source.error;
+            if (opened) {
+                compressed::close_input(&source);
             }
+            return;
+        }
 
-            FILE *input = fopen(argv[file_flag + 1], "r");
-            if (input == NULL) {
-                printf("Wrong name filename %s\n", argv[file_flag + 1]);
-            } else {                    
-                switch (argv[file_flag][1])
-                {
-                case 't':
-                    num_tests += stream_input(&tests, input, num_tests, QD_DEBUG);
-                    break;
-                case 'f':
-                    num_equations += stream_input(equations, input, num_equations, QD_NDEBUG);
-                    break;             
-                default:
-                    printf("Unknown flag %c", argv[file_flag][1]);
-                    break;
-                }
-                fclose(input);
+        file->opened = 1;
+        if (file->flag == 't' || file->flag == 'f') {
+            QUADRATIC_DEBUG test = (file->flag == 't') ? QD_DEBUG : QD_NDEBUG;
+            file->read = (options != NULL && options->fscanf) ? parser::scan_stream (equations, input, test, &file->stats)
+                                                              : parser::parse_stream(equations, input, test, &file->stats);
+        }
+        if (!compressed::close_input(&source, input)) {
+            file->error = "compressed data is damaged or truncated";
+        }
+    }
+
+    static void read_task(void *context, size_t begin, size_t end, int) {
+        ReadContext *read = (ReadContext *)context;
+        for (; begin < end; ++begin) {
+            InputFile *file = read->files + begin;
+            if (file->flag != 'b') {
+                parse_file(file, &file->equations, read->options);
             }
         }
+    }
 
-        if (tests != NULL) {
-            unit_tests::test_quadratic(tests, num_tests);
+    static void read_files(InputFile *files, int size, int readers, const options::Options *options) {
+        ReadContext context = {files, options};
+        parallel::ThreadPool *pool = parallel::make_pool(readers);
+        if (pool == NULL) {
+            read_task(&context, 0, (size_t)size, 0);
+            return;
         }
 
-        size_t size = (size_t)num_equations + 1;
-        *equations = realloc_equations(*equations, size);
+        parallel::pool_for(pool, (size_t)size, 1, read_task, &context);
+        parallel::free_pool(pool);
+    }
 
-        Equation *equation = NULL;
-        int read = 0;
-        for (; file_flag + 2 < argc && equation_terminal_input(&equation, argv + file_flag) == 1; ++read, file_flag += 3) {
-            if (read + num_equations == (int)size) {
-                *equations = realloc_equations(*equations, (size *= 2));
+    static int report_file(const InputFile *file, const options::Options *options) {
+        if (!file->opened) {
+            if (file->error != NULL) {
+                printf("Unable to read %s: %s\n", file->name, file->error);
+            } else {
+                printf("Wrong name filename %s\n", file->name);
+            }
+            return 0;
+        }
+        if (file->error != NULL) {
+            printf("Only %d equations of %s were read: %s\n", file->read, file->name, file->error);
+        }
+        if (file->flag != 't' && file->flag != 'f') {
+            printf("Unknown flag %c", file->flag);
+            return 0;
+        }
+
+        if (options != NULL && options->parse_rate) {
+            parser::print_stats(file->name, &file->stats);
+        }
+        stats::stats_stage(stats::SS_PARSE, (uint64_t)(file->stats.seconds * 1e9), (size_t)file->read);
+        return 1;
+    }
+
+    int terminal_input(EquationArena *equations, int argc, const char **argv, const options::Options *options, int *failed) {
+        ASSERTIF(argv      != NULL, "nullptr in argv",      0);
+        ASSERTIF(equations != NULL, "nullptr in equations", 0);
+
+        InputFile *files = (InputFile *)calloc((size_t)argc / 2 + 1, sizeof(InputFile));
+        ASSERTIF(files != NULL, "unable to alloc", 0);
+
+        int file_flag = 1, num_files = 0, num_text = 0;
+        for (; file_flag < argc - 1 && argv[file_flag][0] == '-'; file_flag += 2, ++num_files) {
+            files[num_files].flag = argv[file_flag][1];
+            files[num_files].name = argv[file_flag + 1];
+            num_text += files[num_files].flag != 'b';
+        }
+
+        // Several text files are read at once, one file is read right into its arena.
+        int concurrent = num_text > 1;
+        if (concurrent) {
+            read_files(files, num_files, (num_text < MAX_READERS) ? num_text : MAX_READERS, options);
+        }
+
+        EquationArena tests = {};
+        int num_equations = 0, has_tests = 0;
+        for (int i = 0; i < num_files; ++i) {
+            InputFile *file = files + i;
+            if (file->flag == 'b') {
+                binary::BinaryFile binary = {};
+                if (binary::open_binary(&binary, file->name)) {
+                    if (binary.header->flags & binary::BF_ROOTS) {
+                        binary::binary_input(&tests, &binary);
+                        has_tests = 1;
+                    } else {
+                        num_equations += binary::binary_input(equations, &binary);
+                    }
+                    binary::close_binary(&binary);
+                } else if (failed != NULL) {
+                    ++*failed;
+                }
+                continue;
             }
-            (*equations)[read + num_equations] = equation;
+
+            EquationArena *target = (file->flag == 't') ? &tests : equations;
+            if (!concurrent) {
+                parse_file(file, target, options);
+            }
+
+            int taken = report_file(file, options);
+            if (failed != NULL && (!taken || file->error != NULL)) {
+                ++*failed;
+            }
+            if (taken) {
+                if (concurrent && !arena_append(target, &file->equations)) {
+                    printf("Unable to alloc memory for equations of %s\n", file->name);
+                } else if (file->flag == 't') {
+                    has_tests = 1;
+                } else {
+                    num_equations += file->read;
+                }
+            }
+            free_arena(&file->equations);
         }
-       *equations = realloc_equations(*equations, (size_t)(read + num_equations + 1));
+        free(files);
+
+        if (has_tests && options != NULL && options->bulk_tests) {
+            unit_tests::test_bulk(&tests, options);
+        } else if (has_tests) {
+            unit_tests::test_quadratic(&tests);
+        }
+        free_arena(&tests);
+
+        int read = 0;
+        for (; file_flag + 2 < argc && equation_terminal_input(equations, argv + file_flag) == 1; ++read, file_flag += 3);
+
         return read + num_equations;
     }
 
-    int print_roots(const Equation *equation) {
+    int print_roots(const Equation *equation, format::NUMBER_FORMAT numbers) {
         ASSERTIF(!equation_valid(equation), "QUAD_ERROR in equation", QE_QUAD_ERROR);
 
+        char first[format::NUMBER_LENGTH] = "", second[format::NUMBER_LENGTH] = "";
         switch (equation->num_roots) {
         case RN_INF:
             printf("infinity of roots");
@@ -180,10 +414,13 @@ namespace quadratic {
             printf("zero roots");
             break;
         case RN_ONE:
-            printf("one  root:  %+-10.5Lg", equation->x1);
+            format::format_number(first, equation->x1, numbers);
+            printf("one  root:  %s", first);
             break;
         case RN_TWO:
-            printf("two  roots: %+-10.5Lg %+-10.5Lg", equation->x1, equation->x2);
+            format::format_number(first, equation->x1, numbers);
+            format::format_number(second, equation->x2, numbers);
+            printf("two  roots: %s %s", first, second);
             break;
         case RN_DEFAULT:
             printf("uninitialized");
@@ -195,38 +432,12 @@ namespace quadratic {
         return 0;
     }
 
-    static int solve_linear(long double b, long double c, long double *x1) {
-        ASSERTIF(x1 != NULL, "nullptr in x1", 1);
-
-        if (common::is_zero(b)) {
-            return (common::is_zero(c)) ? RN_INF : RN_ZERO;
-        }
-
-        *x1 = -c / b;
-        return RN_ONE;
-    }
+    static_assert(solve_core(1.0L, -3.0L, 2.0L).num_roots == RN_TWO && core_is_zero(solve_core(1.0L, -3.0L, 2.0L).x1 - 2), "solve_core is not constexpr");
+    static_assert(solve_core(0.0L, 2.0L, -1.0L).num_roots == RN_ONE && solve_core(0.0L, 0.0L, 0.0L).num_roots == RN_INF, "solve_core is not constexpr");
 
     int solve_equation(Equation *equation) {
         ASSERTIF(!equation_valid(equation), "QUAD_ERROR in equation", QE_QUAD_ERROR);
 
-        long double a = equation->a, b = equation->b, c = equation->c;
-
-        if (common::is_zero(a)) {
-            return solve_linear(b, c, &equation->x1);
-        }
-
-        long double discriminant = b * b - 4 * a * c;
-        if (discriminant < 0)
-            return RN_ZERO;
-
-        if (common::is_zero(discriminant)) {
-            equation->x1 = -b / (2 * a);
-            return RN_ONE;
-        }
-
-        discriminant = sqrtl(discriminant);
-        equation->x1 = (-b + discriminant) / (2 * a);
-        equation->x2 = (-b - discriminant) / (2 * a);
-        return RN_TWO;
+        return store_roots(equation, solve_core(equation->a, equation->b, equation->c));
     }
 }
@@ -1,13 +1,20 @@
 ﻿#ifndef QUADR_DEF
 #define QUADR_DEF
 
+#include "format.h"
+
+namespace options {
+    struct Options;
+}
+
 /**
  * @brief This namespace includes tools to process and solve quadratic equation.
  */
 namespace quadratic {
     /**
      * @brief   A struct with coefficients and roots of quadratic equation
-     * @details Includes all information about equation, whole processing is made with Equation's values.
+     * @details Includes all information about equation, whole processing is made with Equation's values. T is type of numbers,
+     * Equation is BasicEquation<long double>, other types are solved by solve_equation<T> (look precision.h).
      * @param a        - Coefficient of x ^ 2
      * @param b        - Coefficient of x
      * @param c        - Free coefficient
@@ -15,11 +22,17 @@ namespace quadratic {
      * @param x1       - First equation's root.
      * @param x2       - Second equation's root.
      */
-    typedef struct {
-        long double a, b, c;
-        long double x1, x2;
+    template <typename T>
+    struct BasicEquation {
+        T a, b, c;
+        T x1, x2;
         int num_roots;
-    } Equation;
+    };
+
+    typedef BasicEquation<long double> Equation;
+
+    /// Contiguous storage of Equation records (look arena.h).
+    struct EquationArena;
 
     /// Enumerated type of data consists of all different quantities of quadratic equation's roots. Type RM_DEFAULT is not a quantity. It is used for initialization.
     typedef enum {
@@ -83,6 +96,16 @@ namespace quadratic {
      */
     int equation_stream_input (Equation **equations, void *stream = (void *)stdin, QUADRATIC_DEBUG test = QD_NDEBUG);
 
+    /**
+     * @brief Function reads an Equation from *stream and appends it to arena.
+     * @details Same as equation_stream_input with Equation **, but doesn't allocate memory for each equation.
+     * @param [out] *equations - Arena to append equation
+     * @param [in]  *stream    - A pointer to FILE. It is a pointer to stream with input data
+     * @param [in]  test       - Mode of input
+     * @return 1 if equation was read successfully ant 0 otherwise (in case of any errors)
+     */
+    int equation_stream_input (EquationArena *equations, FILE *stream = stdin, QUADRATIC_DEBUG test = QD_NDEBUG);
+
     /**
      * @brief Function reads an Equation from array of strings.
      * @details First argument must have type Equation ** because stream_input dynamically allocates memory for equation and writes a pointer to result into first argument. 
@@ -93,6 +116,14 @@ namespace quadratic {
      */
     int equation_terminal_input(Equation **equation, const char **input);
 
+    /**
+     * @brief Function reads an Equation from array of strings and appends it to arena.
+     * @param [out] *equations - Arena to append equation
+     * @param [in]  *argv      - Pointer to first string (where get a)
+     * @return 1 if equation was read successfully ant 0 otherwise (in case of any errors)
+     */
+    int equation_terminal_input(EquationArena *equations, const char **input);
+
     /**
      * @brief Function reads a plenty of Equation from *stream.
      * @details By default *stream is equal to stdin, but you can change it by giving this function secaon argument. First must have type Equation *** because full_stream_input dynamically
@@ -107,11 +138,22 @@ namespace quadratic {
      */
     int stream_input(Equation *** equations, FILE *stream = stdin, int start_index = 0, QUADRATIC_DEBUG test = QD_NDEBUG);
 
+    /**
+     * @brief Function reads a plenty of Equation from *stream and appends them to arena.
+     * @details Same as stream_input with Equation ***, but records are stored contiguously in arena.
+     * @param [out] *equations - Arena to append equations
+     * @param [in]  *stream    - A pointer to FILE. It is a pointer to stream with input data
+     * @param [in]  test       - Mode of input
+     * @return number of equations that was read successfully
+     */
+    int stream_input(EquationArena *equations, FILE *stream = stdin, QUADRATIC_DEBUG test = QD_NDEBUG);
+
     /**
      * @brief Function reads a plenty of Equation from command line arguments (it can be a file)
      * @details First must have type Equation *** because full_stream_input dynamically allocates memory for array of Equation and writes a pointer to result into first argument. 
      * Function reads data from terminal arguments that was given to program. Function follows this algotihm: if element of argv is a flag -f, terminal_input tries to get plenty of Equation 
-     * from file which name is in next element of argv using stream_input; if element of argv is a flag -t, terminal_input do same thing but assumes given equations in file as tests (6 numbers).
+     * from file which name is in next element of argv using stream_input; if element of argv is a flag -t, terminal_input do same thing but assumes given equations in file as tests (6 numbers);
+     * if element of argv is a flag -b, file is a binary file (look binary.h), it is read as tests if it has roots and as equations otherwise.
      * Same with each even index. If it is not possible, function reads data, each by 3 long double numbers in a row, one element from one element of argv, while new 
      * 3 numbers exists, last < 3 it throws away (it's not important how numbers located on lines): a, b and c. Starts from argv[1]. Parses by each 3 and makes an Equation.
      * @param [out] ***equation - A pointer to pointer to pointer to equation. &equation will have a pointer to an array of read equations
@@ -121,10 +163,23 @@ namespace quadratic {
      */
     int terminal_input (Equation *** equations, int argc, const char **argv);
 
+    /**
+     * @brief Function reads a plenty of Equation from command line arguments (it can be a file) and appends them to arena.
+     * @details Same as terminal_input with Equation ***, but equations and tests are stored in arenas. Files are parsed by parser
+     * (or by fscanf if options->fscanf is set).
+     * @param [out] *equations - Arena to append equations
+     * @param [in]  argc       - Number of terminal arguments
+     * @param [in]  **argv     - Pointer to array with strings of terminal arguments
+     * @param [in]  *options   - Options of the program (may be NULL)
+     * @param [out] *failed    - Number of files which could not be read completely (missing, damaged or truncated) is added to it (may be NULL)
+     * @return number of equations that was read successfully
+     */
+    int terminal_input (EquationArena *equations, int argc, const char **argv, const options::Options *options = NULL, int *failed = NULL);
+
     /**
      * @brief Solves a quadratic equation.
      * @details Writes long double roots to x1 and x2 (if they exists, otherwise 0), members of equation which pointer was given as first 
-     * argument.
+     * argument. It is a checked wrapper over solve_core (look core.h): equation is validated by ASSERTIF, roots are the same.
      * @param [in] *equation - A pointer to equation.
      * @return number of roots to num_roots (look ROOT_NUMBER), you must make equation->num_roots equal to this value
      */
@@ -134,9 +189,10 @@ namespace quadratic {
      * @brief Prints roots of Equation
      * @details writes to stdout number of roots, then roots if they exists. Examples: infinity of roots, zero roots, one root: 'x1', two roots: 'x1', 'x2'
      * @param [in] *equation - A pointer to equation.
+     * @param [in] numbers   - Format of roots (look format_number)
      * @return 0 if equation was written successfully ant 0 otherwise (in case of any errors)
      */
-    int print_roots(const Equation *equation);
+    int print_roots(const Equation *equation, format::NUMBER_FORMAT numbers = format::NF_FIXED);
 }
 
 #endif
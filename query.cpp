@@ -0,0 +1,183 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "common.h"
+#include "query.h"
+#include "options.h"
+
+namespace query {
+    /**
+     * @brief Compares two RootEntry by root, then by index, for qsort.
+     */
+    static int compare_roots(const void *first, const void *second);
+
+    /**
+     * @brief Returns the first root which is not less than value (or greater than value if strict is set).
+     */
+    static size_t lower_root(const RootIndex *index, long double value, int strict);
+
+    static int compare_roots(const void *first, const void *second) {
+        const RootEntry *a = (const RootEntry *)first, *b = (const RootEntry *)second;
+        if (a->root < b->root)
+            return -1;
+        if (a->root > b->root)
+            return 1;
+        return (a->index > b->index) - (a->index < b->index);
+    }
+
+    static size_t lower_root(const RootIndex *index, long double value, int strict) {
+        size_t left = 0, right = index->num_roots;
+        while (left < right) {
+            size_t middle = left + (right - left) / 2;
+            long double root = index->roots[middle].root;
+            if (root < value || (strict && !(root > value))) {
+                left = middle + 1;
+            } else {
+                right = middle;
+            }
+        }
+        return left;
+    }
+
+    int make_index(RootIndex *index, const quadratic::Equation *equations, size_t size) {
+        ASSERTIF(index != NULL, "nullptr in index", 0);
+        ASSERTIF(equations != NULL || size == 0, "nullptr in equations", 0);
+
+        *index = {};
+        index->roots   = (RootEntry *)calloc(2 * size + 1, sizeof(RootEntry));
+        index->members = (size_t *)calloc(size + 1, sizeof(size_t));
+        if (index->roots == NULL || index->members == NULL) {
+            free_index(index);
+            return 0;
+        }
+
+        size_t count[QUERY_CLASSES] = {};
+        for (size_t i = 0; i < size; ++i) {
+            const quadratic::Equation *equation = equations + i;
+            int num_roots = equation->num_roots;
+            if (num_roots < quadratic::QE_QUAD_ERROR || num_roots > quadratic::RN_INF)
+                continue;
+
+            count[num_roots + 1]++;
+            if ((num_roots == quadratic::RN_ONE || num_roots == quadratic::RN_TWO) && !isnan(equation->x1)) {
+                index->roots[index->num_roots++] = {equation->x1, i};
+            }
+            if (num_roots == quadratic::RN_TWO && !isnan(equation->x2)) {
+                index->roots[index->num_roots++] = {equation->x2, i};
+            }
+        }
+        qsort(index->roots, index->num_roots, sizeof(RootEntry), compare_roots);
+
+        size_t next[QUERY_CLASSES] = {};
+        for (int i = 0; i < QUERY_CLASSES; ++i) {
+            index->class_begin[i + 1] = index->class_begin[i] + count[i];
+            next[i] = index->class_begin[i];
+        }
+        for (size_t i = 0; i < size; ++i) {
+            int num_roots = equations[i].num_roots;
+            if (num_roots >= quadratic::QE_QUAD_ERROR && num_roots <= quadratic::RN_INF) {
+                index->members[next[num_roots + 1]++] = i;
+            }
+        }
+        return 1;
+    }
+
+    void free_index(RootIndex *index) {
+        if (index == NULL)
+            return;
+
+        free(index->roots);
+        free(index->members);
+        *index = {};
+    }
+
+    size_t roots_in(const RootIndex *index, long double lo, long double hi, const RootEntry **first) {
+        ASSERTIF(index != NULL, "nullptr in index", 0);
+        ASSERTIF(first != NULL, "nullptr in first", 0);
+
+        size_t begin = lower_root(index, lo, 0), end = lower_root(index, hi, 1);
+        *first = index->roots + begin;
+        return (begin < end) ? end - begin : 0;
+    }
+
+    size_t class_members(const RootIndex *index, int num_roots, const size_t **members) {
+        ASSERTIF(index   != NULL, "nullptr in index",   0);
+        ASSERTIF(members != NULL, "nullptr in members", 0);
+
+        if (num_roots < quadratic::QE_QUAD_ERROR || num_roots > quadratic::RN_INF) {
+            *members = index->members;
+            return 0;
+        }
+
+        *members = index->members + index->class_begin[num_roots + 1];
+        return index->class_begin[num_roots + 2] - index->class_begin[num_roots + 1];
+    }
+
+    size_t top_k(const RootIndex *index, size_t k, const RootEntry **first) {
+        ASSERTIF(index != NULL, "nullptr in index", 0);
+        ASSERTIF(first != NULL, "nullptr in first", 0);
+
+        size_t begin = lower_root(index, 0, 1);
+        *first = index->roots + begin;
+        return (index->num_roots - begin < k) ? index->num_roots - begin : k;
+    }
+
+    int parse_class(const char *name, int *num_roots) {
+        ASSERTIF(name      != NULL, "nullptr in name",      0);
+        ASSERTIF(num_roots != NULL, "nullptr in num_roots", 0);
+
+        if (strcmp(name, "zero") == 0) {
+            *num_roots = quadratic::RN_ZERO;
+        } else if (strcmp(name, "one") == 0) {
+            *num_roots = quadratic::RN_ONE;
+        } else if (strcmp(name, "two") == 0) {
+            *num_roots = quadratic::RN_TWO;
+        } else if (strcmp(name, "inf") == 0) {
+            *num_roots = quadratic::RN_INF;
+        } else if (strcmp(name, "error") == 0) {
+            *num_roots = quadratic::QE_QUAD_ERROR;
+        } else {
+            return 0;
+        }
+        return 1;
+    }
+
+    int write_queries(output::OutputBuffer *out, const quadratic::Equation *equations, size_t size, const options::Options *options) {
+        ASSERTIF(options != NULL, "nullptr in options", 0);
+
+        RootIndex index = {};
+        if (!make_index(&index, equations, size))
+            return 0;
+
+        const RootEntry *roots = NULL;
+        if (options->roots_in) {
+            size_t found = roots_in(&index, options->roots_lo, options->roots_hi, &roots);
+            output::write_root_header(out, options->format);
+            for (size_t i = 0; i < found; ++i) {
+                output::write_root(out, roots[i].index + 1, roots[i].root, options->format);
+            }
+        }
+
+        if (options->query_class) {
+            const size_t *members = NULL;
+            size_t found = class_members(&index, options->num_roots, &members);
+            output::write_header(out, options->format);
+            for (size_t i = 0; i < found; ++i) {
+                output::write_equation(out, members[i] + 1, equations + members[i], options->format);
+            }
+        }
+
+        if (options->top_k != 0) {
+            size_t found = top_k(&index, options->top_k, &roots);
+            output::write_root_header(out, options->format);
+            for (size_t i = 0; i < found; ++i) {
+                output::write_root(out, roots[i].index + 1, roots[i].root, options->format);
+            }
+        }
+
+        free_index(&index);
+        return 1;
+    }
+}
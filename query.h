@@ -0,0 +1,107 @@
+#ifndef QUERY_DEF
+#define QUERY_DEF
+
+#include <stddef.h>
+
+#include "quadratic.h"
+#include "output.h"
+
+/**
+ * @brief   This namespace includes an index over solved equations and queries to it (--roots-in, --class, --top-k).
+ * @details Index has all real roots sorted by value, so a range of roots is found by binary search, and indices of equations grouped by
+ * class of roots. A query costs O(log n + number of results) instead of a scan of all equations.
+ */
+namespace query {
+    /// Number of classes of equations: QE_QUAD_ERROR and ROOT_NUMBER (index of class is num_roots + 1).
+    const int QUERY_CLASSES = quadratic::RN_INF + 2;
+
+    /**
+     * @brief One real root of an equation.
+     * @param root  - Root
+     * @param index - Index of equation in the solved array
+     */
+    typedef struct {
+        long double root;
+        size_t index;
+    } RootEntry;
+
+    /**
+     * @brief   Index over a solved array of equations.
+     * @details Equations of one class are contiguous in members, from class_begin[num_roots + 1] to class_begin[num_roots + 2],
+     * in ascending order.
+     * @param roots       - Roots x1 and x2 of equations with one or two roots sorted by value (then by index), NaN roots are skipped
+     * @param num_roots   - Number of roots
+     * @param members     - Indices of equations grouped by class
+     * @param class_begin - Offsets of classes in members
+     */
+    typedef struct {
+        RootEntry *roots;
+        size_t num_roots;
+        size_t *members;
+        size_t class_begin[QUERY_CLASSES + 1];
+    } RootIndex;
+
+    /**
+     * @brief Builds an index over solved equations.
+     * @param [out] *index     - Index
+     * @param [in]  *equations - Array of solved equations
+     * @param [in]  size       - Number of equations
+     * @return 1 if index was built and 0 otherwise
+     */
+    int make_index(RootIndex *index, const quadratic::Equation *equations, size_t size);
+
+    /**
+     * @brief Frees memory of index.
+     * @return void
+     */
+    void free_index(RootIndex *index);
+
+    /**
+     * @brief Finds all roots in [lo, hi].
+     * @param [in]  *index - Index
+     * @param [in]  lo, hi - Bounds of range
+     * @param [out] **first - First found root, the rest follow it in ascending order
+     * @return number of found roots
+     */
+    size_t roots_in(const RootIndex *index, long double lo, long double hi, const RootEntry **first);
+
+    /**
+     * @brief Finds all equations of a class.
+     * @param [in]  *index     - Index
+     * @param [in]  num_roots  - Class (ROOT_NUMBER or QE_QUAD_ERROR)
+     * @param [out] **members  - Indices of equations in ascending order
+     * @return number of found equations
+     */
+    size_t class_members(const RootIndex *index, int num_roots, const size_t **members);
+
+    /**
+     * @brief Finds k smallest positive roots.
+     * @param [in]  *index - Index
+     * @param [in]  k      - Maximal number of roots
+     * @param [out] **first - Smallest positive root, the rest follow it in ascending order
+     * @return number of found roots (less than k if there are less positive roots)
+     */
+    size_t top_k(const RootIndex *index, size_t k, const RootEntry **first);
+
+    /**
+     * @brief Parses name of class of equations.
+     * @param [in]  *name      - "zero", "one", "two", "inf" or "error"
+     * @param [out] *num_roots - Class
+     * @return 1 if name is known and 0 otherwise
+     */
+    int parse_class(const char *name, int *num_roots);
+
+    /**
+     * @brief Builds an index over solved equations and writes answers to queries of options instead of all equations.
+     * @details Answers are written in order --roots-in, --class, --top-k. Roots are written by write_root, equations of a class by
+     * write_equation, numbers of equations start from 1.
+     * @param [in] *out       - Output buffer
+     * @param [in] *equations - Array of solved equations
+     * @param [in] size       - Number of equations
+     * @param [in] *options   - Options of the program with queries
+     * @return 1 if index was built and 0 otherwise
+     */
+    int write_queries(output::OutputBuffer *out, const quadratic::Equation *equations, size_t size, const options::Options *options);
+}
+
+#endif
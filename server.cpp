@@ -0,0 +1,563 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "common.h"
+#include "server.h"
+#include "arena.h"
+#include "batch.h"
+#include "parser.h"
+#include "options.h"
+#include "output.h"
+#include "precision.h"
+#include "cache.h"
+#include "stats.h"
+
+namespace server {
+    /// Size of one recv(2) from a connection.
+    static const size_t READ_CHUNK = 1 << 16;
+
+    /// A connection is not read while it has more bytes of answers than this which were not sent.
+    static const size_t ANSWERS_LIMIT = 1 << 24;
+
+    /// Number of equations in EquationBatch of --type double.
+    static const size_t COLUMNS_CAPACITY = 4096;
+
+    /**
+     * @brief State of one connection.
+     * @param fd         - Socket (-1 if slot is free)
+     * @param number     - Number of connection since start of daemon (from 1)
+     * @param input      - Received bytes which are not taken as requests yet (input[size] is free for '\0')
+     * @param size, capacity - Size of input
+     * @param answers    - Answers which are not sent yet (in memory)
+     * @param sent       - Number of sent bytes of answers
+     * @param closing    - Nothing is read anymore (end of input or a wrong request), connection is closed when answers are sent
+     * @param opened     - Time of accept
+     * @param requests, equations - Number of answered requests and equations
+     * @param bytes_in, bytes_out - Number of received and sent bytes
+     * @param latency, latency_max - Total and maximal latency of requests in ns
+     */
+    typedef struct {
+        int fd;
+        int number;
+        char *input;
+        size_t size, capacity;
+        output::OutputBuffer answers;
+        size_t sent;
+        int closing;
+        uint64_t opened;
+        uint64_t requests, equations;
+        uint64_t bytes_in, bytes_out;
+        uint64_t latency, latency_max;
+    } Connection;
+
+    /**
+     * @brief A request taken in current round.
+     * @param connection - Index of connection
+     * @param header     - Header of request
+     * @param first      - Index of its first equation in Server::equations
+     * @param count      - Number of its equations
+     * @param received   - Time when request was taken
+     */
+    typedef struct {
+        int connection;
+        FrameHeader header;
+        size_t first, count;
+        uint64_t received;
+    } Request;
+
+    /**
+     * @brief State of daemon.
+     * @param options     - Options of the program (may be NULL)
+     * @param type        - Type of numbers used to solve
+     * @param format      - Layout of text answers
+     * @param connections - All connections
+     * @param accepted    - Number of accepted connections
+     * @param equations   - Equations of all requests of current round
+     * @param requests    - Requests of current round
+     * @param size, capacity - Number of requests
+     * @param columns     - Batch for --type double
+     * @param cache       - Cache for --cache
+     * @param cached      - Cache is used
+     */
+    typedef struct {
+        const options::Options *options;
+        quadratic::NUMBER_TYPE type;
+        output::OUTPUT_FORMAT format;
+        Connection connections[SERVE_CONNECTIONS];
+        int accepted;
+        quadratic::EquationArena equations;
+        Request *requests;
+        size_t size, capacity;
+        quadratic::EquationBatch columns;
+        quadratic::SolveCache cache;
+        int cached;
+    } Server;
+
+    /// Set by SIGINT and SIGTERM.
+    static volatile sig_atomic_t stopped = 0;
+
+    /**
+     * @brief Handler of SIGINT and SIGTERM.
+     */
+    static void on_signal(int signal);
+
+    /**
+     * @brief Makes a non-blocking listening socket at path.
+     * @return Socket or -1
+     */
+    static int listen_socket(const char *path);
+
+    /**
+     * @brief Accepts all waiting connections.
+     */
+    static void accept_connections(Server *server, int listener);
+
+    /**
+     * @brief Receives everything which is available from connection, but no more than one frame of the largest size.
+     * @details The rest stays in the socket till take_requests consumes the buffer, so a client can't make it grow without limit.
+     * @return 0 if connection was closed by client or failed and 1 otherwise
+     */
+    static int receive(Connection *connection);
+
+    /**
+     * @brief Takes all complete requests of connection: appends their equations to server->equations and remembers them.
+     * @details A wrong request gets SK_ERROR answer and the connection is closed after it.
+     */
+    static void take_requests(Server *server, int index);
+
+    /**
+     * @brief Appends equations of payload of request to server->equations.
+     * @return 1 if payload is right and 0 otherwise
+     */
+    static int take_payload(Server *server, const FrameHeader *header, char *payload);
+
+    /**
+     * @brief Queues SK_ERROR answer and stops reading connection.
+     */
+    static void refuse(Connection *connection, const FrameHeader *header, const char *message);
+
+    /**
+     * @brief Solves equations of current round.
+     */
+    static void solve_round(Server *server);
+
+    /**
+     * @brief Queues answers of current round and updates counters of connections.
+     */
+    static void answer_round(Server *server);
+
+    /**
+     * @brief Sends as much of answers as socket takes now.
+     * @return 0 if connection failed and 1 otherwise
+     */
+    static int send_answers(Connection *connection);
+
+    /**
+     * @brief Prints counters of connection to stderr, closes it and frees its slot.
+     */
+    static void close_connection(Connection *connection);
+
+    /**
+     * @brief Returns number of bytes of answers which are not sent yet.
+     */
+    static size_t pending(const Connection *connection);
+
+    static size_t pending(const Connection *connection) {
+        return connection->answers.size - connection->sent;
+    }
+
+    static void on_signal(int signal) {
+        (void)signal;
+        stopped = 1;
+    }
+
+    static int listen_socket(const char *path) {
+        struct sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (strlen(path) >= sizeof(address.sun_path)) {
+            fprintf(stderr, "Path of socket %s is too long\n", path);
+            return -1;
+        }
+        strcpy(address.sun_path, path);
+
+        // Only an old socket is removed, never a regular file.
+        struct stat status = {};
+        if (stat(path, &status) == 0) {
+            if (!S_ISSOCK(status.st_mode)) {
+                fprintf(stderr, "%s exists and is not a socket\n", path);
+                return -1;
+            }
+            unlink(path);
+        }
+
+        int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listener < 0 || bind(listener, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0) {
+            fprintf(stderr, "Unable to listen on %s: %s\n", path, strerror(errno));
+            if (listener >= 0) {
+                close(listener);
+            }
+            return -1;
+        }
+        return listener;
+    }
+
+    static void accept_connections(Server *server, int listener) {
+        for (int index = 0; index < SERVE_CONNECTIONS; ++index) {
+            Connection *connection = server->connections + index;
+            if (connection->fd >= 0)
+                continue;
+
+            int fd = accept4(listener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0)
+                return;
+
+            *connection = {};
+            connection->fd = fd;
+            connection->number = ++server->accepted;
+            connection->opened = stats::stats_now();
+            if (!output::make_output(&connection->answers, output::OUTPUT_MEMORY, READ_CHUNK)) {
+                fprintf(stderr, "Unable to alloc memory for connection %d\n", connection->number);
+                close_connection(connection);
+            } else if (server->options != NULL) {
+                connection->answers.numbers = server->options->numbers;
+            }
+        }
+    }
+
+    static int receive(Connection *connection) {
+        while (connection->size <= sizeof(FrameHeader) + SERVE_MAX_PAYLOAD) {
+            if (connection->capacity - connection->size < READ_CHUNK) {
+                size_t capacity = (connection->capacity == 0) ? READ_CHUNK * 2 : connection->capacity * 2;
+                char *grown = (char *)realloc(connection->input, capacity + 1);
+                if (grown == NULL)
+                    return 0;
+                connection->input = grown;
+                connection->capacity = capacity;
+            }
+
+            ssize_t got = recv(connection->fd, connection->input + connection->size, connection->capacity - connection->size, 0);
+            if (got < 0 && errno == EINTR)
+                continue;
+            if (got < 0)
+                return errno == EAGAIN;
+            if (got == 0)
+                return 0;
+
+            connection->size += (size_t)got;
+            connection->bytes_in += (uint64_t)got;
+        }
+        return 1;
+    }
+
+    static int take_payload(Server *server, const FrameHeader *header, char *payload) {
+        quadratic::EquationArena *equations = &server->equations;
+
+        if (header->kind == SK_TEXT) {
+            char last = payload[header->size];
+            payload[header->size] = '\0';
+            parser::parse_text(equations, payload, header->size, quadratic::QD_NDEBUG);
+            payload[header->size] = last;
+            return 1;
+        }
+
+        size_t number = (header->kind == SK_DOUBLE) ? sizeof(double) : sizeof(long double);
+        if (header->size % (3 * number) != 0)
+            return 0;
+
+        for (size_t offset = 0; offset < header->size; offset += 3 * number) {
+            quadratic::Equation equation = {0, 0, 0, 0, 0, quadratic::RN_DEFAULT};
+            if (header->kind == SK_DOUBLE) {
+                double coefficients[3] = {};
+                memcpy(coefficients, payload + offset, sizeof(coefficients));
+                equation.a = coefficients[0];
+                equation.b = coefficients[1];
+                equation.c = coefficients[2];
+            } else {
+                memcpy(&equation.a, payload + offset,              number);
+                memcpy(&equation.b, payload + offset + number,     number);
+                memcpy(&equation.c, payload + offset + 2 * number, number);
+            }
+            if (quadratic::arena_push(equations, &equation) == NULL)
+                return 0;
+        }
+        return 1;
+    }
+
+    static void refuse(Connection *connection, const FrameHeader *header, const char *message) {
+        FrameHeader answer = {SERVE_MAGIC, SK_ERROR, header->id, strlen(message)};
+        output::output_write(&connection->answers, (const char *)&answer, sizeof(answer));
+        output::output_write(&connection->answers, message, answer.size);
+        connection->closing = 1;
+    }
+
+    static void take_requests(Server *server, int index) {
+        Connection *connection = server->connections + index;
+        size_t pos = 0;
+
+        while (connection->size - pos >= sizeof(FrameHeader)) {
+            FrameHeader header = {};
+            memcpy(&header, connection->input + pos, sizeof(header));
+
+            if (header.magic != SERVE_MAGIC || (header.kind != SK_TEXT && header.kind != SK_DOUBLE && header.kind != SK_LONG_DOUBLE)) {
+                refuse(connection, &header, "wrong header");
+                break;
+            }
+            if (header.size > SERVE_MAX_PAYLOAD) {
+                refuse(connection, &header, "payload is too large");
+                break;
+            }
+            if (connection->size - pos - sizeof(header) < header.size)
+                break;
+
+            if (server->size == server->capacity) {
+                size_t capacity = (server->capacity == 0) ? 64 : server->capacity * 2;
+                Request *grown = (Request *)realloc(server->requests, capacity * sizeof(Request));
+                if (grown == NULL) {
+                    refuse(connection, &header, "out of memory");
+                    break;
+                }
+                server->requests = grown;
+                server->capacity = capacity;
+            }
+
+            size_t first = server->equations.size;
+            if (!take_payload(server, &header, connection->input + pos + sizeof(header))) {
+                server->equations.size = first;
+                refuse(connection, &header, "wrong size of payload");
+                break;
+            }
+
+            server->requests[server->size++] = {index, header, first, server->equations.size - first, stats::stats_now()};
+            pos += sizeof(header) + header.size;
+        }
+
+        memmove(connection->input, connection->input + pos, connection->size - pos);
+        connection->size -= pos;
+    }
+
+    static void solve_round(Server *server) {
+        quadratic::Equation *equations = server->equations.records;
+        size_t size = server->equations.size;
+        if (size == 0)
+            return;
+
+        uint64_t start = stats::stats_now();
+        if (server->type == quadratic::NT_DOUBLE && server->columns.capacity != 0) {
+            quadratic::EquationBatch *columns = &server->columns;
+            for (size_t begin = 0; begin < size; begin += columns->capacity) {
+                columns->size = 0;
+                for (size_t i = begin; i < size && quadratic::batch_push(columns, equations + i); ++i);
+
+                quadratic::solve_batch(columns);
+                for (size_t i = 0; i < columns->size; ++i) {
+                    equations[begin + i].num_roots = columns->num_roots[i];
+                    equations[begin + i].x1 = columns->x1[i];
+                    equations[begin + i].x2 = columns->x2[i];
+                }
+            }
+        } else if (server->cached) {
+            for (size_t i = 0; i < size; ++i) {
+                equations[i].num_roots = quadratic::cached_solve(&server->cache, &equations[i]);
+            }
+        } else {
+            quadratic::solve_range_as(server->type, equations, 0, size);
+        }
+        stats::stats_stage(stats::SS_SOLVE, stats::stats_now() - start, size);
+    }
+
+    static void answer_round(Server *server) {
+        uint64_t start = stats::stats_now();
+        for (size_t i = 0; i < server->size; ++i) {
+            const Request *request = server->requests + i;
+            Connection *connection = server->connections + request->connection;
+            output::OutputBuffer *answers = &connection->answers;
+            const quadratic::Equation *equations = server->equations.records + request->first;
+
+            FrameHeader header = {SERVE_MAGIC, request->header.kind, request->header.id, 0};
+            size_t header_at = answers->size;
+            output::output_write(answers, (const char *)&header, sizeof(header));
+
+            if (request->header.kind == SK_TEXT) {
+                // Requests of a connection are answered in order: numbers go on through frames, header is only in the first.
+                if (connection->requests == 0) {
+                    output::write_header(answers, server->format);
+                }
+                for (size_t j = 0; j < request->count; ++j) {
+                    output::write_equation(answers, connection->equations + j + 1, equations + j, server->format);
+                }
+            } else if (request->header.kind == SK_DOUBLE) {
+                for (size_t j = 0; j < request->count; ++j) {
+                    AnswerDouble answer = {equations[j].num_roots, 0, (double)equations[j].x1, (double)equations[j].x2};
+                    output::output_write(answers, (const char *)&answer, sizeof(answer));
+                }
+            } else {
+                for (size_t j = 0; j < request->count; ++j) {
+                    AnswerLong answer = {equations[j].num_roots, {}, equations[j].x1, equations[j].x2};
+                    output::output_write(answers, (const char *)&answer, sizeof(answer));
+                }
+            }
+
+            // Size of text answer is known only now.
+            if (!answers->failed) {
+                header.size = answers->size - header_at - sizeof(header);
+                memcpy(answers->data + header_at, &header, sizeof(header));
+            }
+
+            uint64_t latency = stats::stats_now() - request->received;
+            connection->requests++;
+            connection->equations += request->count;
+            connection->latency += latency;
+            connection->latency_max = (latency > connection->latency_max) ? latency : connection->latency_max;
+        }
+        stats::stats_stage(stats::SS_OUTPUT, stats::stats_now() - start, server->equations.size);
+
+        server->size = 0;
+        server->equations.size = 0;
+    }
+
+    static int send_answers(Connection *connection) {
+        output::OutputBuffer *answers = &connection->answers;
+        if (answers->failed)
+            return 0;
+
+        while (connection->sent < answers->size) {
+            ssize_t result = send(connection->fd, answers->data + connection->sent, answers->size - connection->sent, MSG_NOSIGNAL);
+            if (result < 0 && errno == EINTR)
+                continue;
+            if (result < 0)
+                return errno == EAGAIN;
+
+            connection->sent += (size_t)result;
+            connection->bytes_out += (uint64_t)result;
+        }
+
+        answers->size = connection->sent = 0;
+        return 1;
+    }
+
+    static void close_connection(Connection *connection) {
+        double seconds = (double)(stats::stats_now() - connection->opened) * 1e-9;
+        double mean = (connection->requests != 0) ? (double)connection->latency / (double)connection->requests : 0.0;
+        fprintf(stderr, "Connection %d: %llu requests, %llu equations, %llu bytes in, %llu bytes out, latency mean %.3f ms max %.3f ms, "
+                "%.0f equations/s\n", connection->number, (unsigned long long)connection->requests, (unsigned long long)connection->equations,
+                (unsigned long long)connection->bytes_in, (unsigned long long)connection->bytes_out, mean * 1e-6,
+                (double)connection->latency_max * 1e-6, (seconds > 0) ? (double)connection->equations / seconds : 0.0);
+
+        close(connection->fd);
+        free(connection->input);
+        output::free_output(&connection->answers);
+        *connection = {};
+        connection->fd = -1;
+    }
+
+    int run_server(const char *path, const options::Options *options) {
+        ASSERTIF(path != NULL, "nullptr in path", 0);
+
+        int listener = listen_socket(path);
+        if (listener < 0)
+            return 0;
+
+        Server *server = new Server();
+        server->options = options;
+        server->type = (options != NULL) ? options->type : quadratic::NT_LONG_DOUBLE;
+        server->format = (options != NULL) ? options->format : output::OF_PLAIN;
+        for (int index = 0; index < SERVE_CONNECTIONS; ++index) {
+            server->connections[index].fd = -1;
+        }
+
+        int allocated = quadratic::make_arena(&server->equations);
+        if (server->type == quadratic::NT_DOUBLE) {
+            allocated &= quadratic::make_batch(&server->columns, COLUMNS_CAPACITY);
+        }
+        if (options != NULL && options->cache && server->type == quadratic::NT_LONG_DOUBLE) {
+            server->cached = quadratic::make_cache(&server->cache);
+            allocated &= server->cached;
+        }
+
+        struct sigaction action = {};
+        action.sa_handler = on_signal;
+        sigaction(SIGINT, &action, NULL);
+        sigaction(SIGTERM, &action, NULL);
+
+        if (allocated) {
+            fprintf(stderr, "Solving equations on %s\n", path);
+        } else {
+            fprintf(stderr, "Unable to alloc memory for daemon\n");
+        }
+
+        struct pollfd fds[SERVE_CONNECTIONS + 1] = {};
+        while (allocated && !stopped) {
+            int polled[SERVE_CONNECTIONS] = {}, count = 1;
+            for (int index = 0; index < SERVE_CONNECTIONS; ++index) {
+                const Connection *connection = server->connections + index;
+                if (connection->fd < 0)
+                    continue;
+
+                short events = (short)(((connection->closing || pending(connection) > ANSWERS_LIMIT) ? 0 : POLLIN) |
+                                       ((pending(connection) != 0) ? POLLOUT : 0));
+                polled[count - 1] = index;
+                fds[count++] = {connection->fd, events, 0};
+            }
+            // The listener is left out (poll skips a negative fd) while all slots are taken, else it would be ready all the time.
+            fds[0] = {(count <= SERVE_CONNECTIONS) ? listener : -1, POLLIN, 0};
+
+            if (poll(fds, (nfds_t)count, -1) < 0) {
+                if (errno == EINTR)
+                    continue;
+                fprintf(stderr, "poll failed: %s\n", strerror(errno));
+                break;
+            }
+
+            for (int i = 1; i < count; ++i) {
+                Connection *connection = server->connections + polled[i - 1];
+                if ((fds[i].revents & (POLLIN | POLLHUP | POLLERR)) == 0 || connection->closing)
+                    continue;
+
+                connection->closing = !receive(connection);
+                take_requests(server, polled[i - 1]);
+            }
+
+            solve_round(server);
+            answer_round(server);
+
+            for (int i = 1; i < count; ++i) {
+                Connection *connection = server->connections + polled[i - 1];
+                int alive = send_answers(connection);
+                if (!alive || (connection->closing && pending(connection) == 0)) {
+                    close_connection(connection);
+                }
+            }
+
+            if (fds[0].revents & POLLIN) {
+                accept_connections(server, listener);
+            }
+        }
+
+        for (int index = 0; index < SERVE_CONNECTIONS; ++index) {
+            if (server->connections[index].fd >= 0) {
+                close_connection(server->connections + index);
+            }
+        }
+        close(listener);
+        unlink(path);
+
+        if (server->cached) {
+            fprintf(stderr, "Solve cache: %zu hits, %zu misses, %zu bypassed\n", server->cache.hits, server->cache.misses,
+                    server->cache.bypasses);
+        }
+        quadratic::free_cache(&server->cache);
+        quadratic::free_batch(&server->columns);
+        quadratic::free_arena(&server->equations);
+        free(server->requests);
+        delete server;
+        return allocated && stopped;
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef SERVER_DEF
+#define SERVER_DEF
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "quadratic.h"
+
+/**
+ * @brief   This namespace includes the solver daemon (--serve socket) and its protocol.
+ * @details Daemon listens on a Unix domain socket. A client sends requests and gets one answer for every request, in the same order.
+ * Request and answer are frames: FrameHeader and size bytes of payload. Payload of a request is text with groups of 3 numbers a b c
+ * (SK_TEXT) or records of 3 numbers in double or long double (SK_DOUBLE, SK_LONG_DOUBLE, same precision tags as binary files).
+ * Answer of a text request is text of results in --format of daemon, numbered through all requests of the connection (header of
+ * csv/tsv is in the first answer only), answers of binary requests are records AnswerDouble or AnswerLong.
+ * Requests of all connections which came during one poll(2) are solved together, as one batch.
+ */
+namespace server {
+    /// Magic number of every frame ("QSRV" in little endian).
+    const uint32_t SERVE_MAGIC = 0x56525351;
+
+    /// Maximal size of payload of a request.
+    const uint64_t SERVE_MAX_PAYLOAD = 1 << 26;
+
+    /// Maximal number of connections at once.
+    const int SERVE_CONNECTIONS = 256;
+
+    /// Enumerated type of data with kinds of frames.
+    typedef enum {
+        SK_TEXT        = 0,  ///< Text: "a b c" groups in request, lines of results in answer
+        SK_DOUBLE      = 8,  ///< Records of 3 double in request, AnswerDouble in answer
+        SK_LONG_DOUBLE = 16, ///< Records of 3 x87 long double in 16 bytes in request, AnswerLong in answer
+        SK_ERROR       = 255 ///< Answer to a wrong request, payload is a message; connection is closed after it
+    } SERVE_KIND;
+
+    /**
+     * @brief Header of a frame.
+     * @param magic - SERVE_MAGIC
+     * @param kind  - SERVE_KIND
+     * @param id    - Number of request chosen by client, answer has the same id
+     * @param size  - Size of payload in bytes
+     */
+    typedef struct {
+        uint32_t magic;
+        uint32_t kind;
+        uint64_t id;
+        uint64_t size;
+    } FrameHeader;
+
+    /**
+     * @brief Answer to one equation of SK_DOUBLE request.
+     * @param num_roots - Number of roots (look ROOT_NUMBER) or QE_QUAD_ERROR
+     * @param x1, x2    - Roots, 0 if they don't exist
+     */
+    typedef struct {
+        int32_t num_roots, reserved;
+        double x1, x2;
+    } AnswerDouble;
+
+    /**
+     * @brief Answer to one equation of SK_LONG_DOUBLE request.
+     */
+    typedef struct {
+        int32_t num_roots, reserved[3];
+        long double x1, x2;
+    } AnswerLong;
+
+    /**
+     * @brief Runs daemon until SIGINT or SIGTERM.
+     * @details Equations are solved in options->type, through a SolveCache if options->cache is set; batches of --type double go to
+     * solve_columns (SIMD kernels). When a connection is closed, its counters are printed to stderr: requests, equations, bytes,
+     * latency of requests (from the moment request is received to the moment its answer is queued) and throughput.
+     * @param [in] *path    - Path of socket, an old socket there is removed
+     * @param [in] *options - Options of the program (may be NULL)
+     * @return 1 if daemon was stopped by a signal and 0 if it can't listen on socket
+     */
+    int run_server(const char *path, const options::Options *options);
+}
+
+#endif
@@ -0,0 +1,185 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "common.h"
+#include "shard.h"
+#include "arena.h"
+#include "parser.h"
+#include "compressed.h"
+#include "output.h"
+
+namespace shard {
+    /// Size of pieces read while looking for the end of a line.
+    static const size_t LINE_CHUNK = 4096;
+
+    /**
+     * @brief Finds the beginning of the first line which starts at pos or after it.
+     * @param [in]  fd     - File descriptor
+     * @param [in]  size   - Size of file
+     * @param [in]  pos    - Position in file
+     * @param [out] *start - Beginning of line or size if there is no such line
+     * @return 1 if file was read and 0 otherwise
+     */
+    static int line_start(int fd, size_t size, size_t pos, size_t *start);
+
+    /// Beginning of a line of plain output.
+    static const char PLAIN_PREFIX[] = "Equation ";
+
+    /**
+     * @brief Writes a line of output of a shard with number index instead of number of the shard.
+     * @param [out] *out   - Output
+     * @param [in]  *line  - Line with '\n'
+     * @param [in]  index  - Number of equation in the whole file
+     * @return 1 if line is an equation and 0 otherwise
+     */
+    static int merge_line(output::OutputBuffer *out, const char *line, size_t index);
+
+    static int line_start(int fd, size_t size, size_t pos, size_t *start) {
+        char chunk[LINE_CHUNK] = {};
+        if (pos == 0 || pos >= size) {
+            *start = (pos == 0) ? 0 : size;
+            return 1;
+        }
+
+        // pos starts a line if the byte before it is a line break, so the search starts from pos - 1.
+        for (size_t offset = pos - 1; offset < size; offset += LINE_CHUNK) {
+            ssize_t bytes = pread(fd, chunk, LINE_CHUNK, (off_t)offset);
+            if (bytes <= 0)
+                return 0;
+
+            const char *newline = (const char *)memchr(chunk, '\n', (size_t)bytes);
+            if (newline != NULL) {
+                *start = offset + (size_t)(newline - chunk) + 1;
+                return 1;
+            }
+        }
+        *start = size;
+        return 1;
+    }
+
+    int parse_shard(Shard *shard, const char *spec) {
+        ASSERTIF(shard != NULL, "nullptr in shard", 0);
+        ASSERTIF(spec  != NULL, "nullptr in spec",  0);
+
+        char *end = NULL;
+        unsigned long long index = strtoull(spec, &end, 10);
+        if (end == spec || *end != '/' || spec[0] == '-')
+            return 0;
+
+        const char *count_text = end + 1;
+        unsigned long long count = strtoull(count_text, &end, 10);
+        if (end == count_text || *end != '\0' || count_text[0] == '-' || count == 0 || count > MAX_SHARDS || index >= count)
+            return 0;
+
+        *shard = {1, (size_t)index, (size_t)count};
+        return 1;
+    }
+
+    void shard_range(const Shard *shard, size_t size, size_t *begin, size_t *end) {
+        ASSERTIF(shard != NULL, "nullptr in shard", );
+        ASSERTIF(begin != NULL, "nullptr in begin", );
+        ASSERTIF(end   != NULL, "nullptr in end",   );
+
+        // size * index / count without overflow: index * (size % count) < count ^ 2.
+        size_t part = size / shard->count, rest = size % shard->count;
+        *begin = shard->index * part + shard->index * rest / shard->count;
+        *end   = (shard->index + 1) * part + (shard->index + 1) * rest / shard->count;
+    }
+
+    int shard_input(quadratic::EquationArena *equations, const char *name, const Shard *shard) {
+        ASSERTIF(equations != NULL, "nullptr in equations", -1);
+        ASSERTIF(name      != NULL, "nullptr in name",      -1);
+        ASSERTIF(shard     != NULL, "nullptr in shard",     -1);
+
+        int fd = open(name, O_RDONLY);
+        struct stat info = {};
+        if (fd < 0 || fstat(fd, &info) != 0) {
+            printf("Wrong name filename %s\n", name);
+            if (fd >= 0) {
+                close(fd);
+            }
+            return -1;
+        }
+
+        compressed::COMPRESSION compression = compressed::detect_compression(fd);
+        if (compression != compressed::CF_NONE) {
+            printf("Shard mode needs a text file, %s is compressed by %s\n", name, compressed::compression_name(compression));
+            close(fd);
+            return -1;
+        }
+
+        size_t size = (size_t)info.st_size, begin = 0, end = 0;
+        shard_range(shard, size, &begin, &end);
+        char *text = NULL;
+        int read_all = line_start(fd, size, begin, &begin) && line_start(fd, size, end, &end);
+        if (read_all && begin < end) {
+            // One more byte for '\0' after the text, parse_text needs a character which ends the last number.
+            text = (char *)calloc(end - begin + 1, 1);
+            read_all = text != NULL;
+            for (size_t done = 0; read_all && done < end - begin;) {
+                ssize_t bytes = pread(fd, text + done, end - begin - done, (off_t)(begin + done));
+                read_all = bytes > 0;
+                done += read_all ? (size_t)bytes : 0;
+            }
+        }
+        close(fd);
+
+        int appended = -1;
+        if (!read_all) {
+            printf("Unable to read shard %zu/%zu of %s\n", shard->index, shard->count, name);
+        } else {
+            appended = (text != NULL) ? (int)parser::parse_text(equations, text, end - begin, quadratic::QD_NDEBUG) : 0;
+        }
+        free(text);
+        return appended;
+    }
+
+    static int merge_line(output::OutputBuffer *out, const char *line, size_t index) {
+        const size_t prefix = sizeof(PLAIN_PREFIX) - 1;
+        int plain = strncmp(line, PLAIN_PREFIX, prefix) == 0;
+        const char *number = plain ? line + prefix : line;
+        for (; plain && *number == ' '; number++);
+
+        const char *rest = number;
+        for (; isdigit((unsigned char)*rest); rest++);
+        if (rest == number) {
+            output::output_write(out, line, strlen(line));
+            return 0;
+        }
+
+        output::output_printf(out, plain ? "Equation %3zu" : "%zu", index);
+        output::output_write(out, rest, strlen(rest));
+        return 1;
+    }
+
+    int merge_outputs(FILE **files, int count, int fd, size_t *merged) {
+        ASSERTIF(files  != NULL, "nullptr in files",  0);
+        ASSERTIF(merged != NULL, "nullptr in merged", 0);
+
+        *merged = 0;
+        output::OutputBuffer out = {};
+        if (!output::make_output(&out, fd)) {
+            printf("Unable to alloc output buffer\n");
+            return 0;
+        }
+
+        char *line = NULL;
+        size_t capacity = 0;
+        for (int shard = 0; shard < count; shard++) {
+            for (int first = 1; getline(&line, &capacity, files[shard]) > 0; first = 0) {
+                if (first && shard != 0 && strncmp(line, "index", 5) == 0) {
+                    continue;
+                }
+                *merged += (size_t)merge_line(&out, line, *merged + 1);
+            }
+        }
+        free(line);
+
+        return output::free_output(&out);
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef SHARD_DEF
+#define SHARD_DEF
+
+#include <stddef.h>
+
+#include "quadratic.h"
+
+/**
+ * @brief   This namespace includes the shard mode of the program (--shard i/N).
+ * @details A text file with one equation in a line is split into N byte ranges of equal size, shard i solves only the lines which
+ * start in its range: the range start is moved to the beginning of the next line, and the range end to the end of the line where it
+ * falls. So every line goes to exactly one shard and shards 0..N-1 together read the file in order. Equations of a shard are
+ * numbered from 1, build/merge stitches outputs of shards back with numbers of the whole file and runs shards as local processes.
+ */
+namespace shard {
+    /// Maximal number of shards.
+    const size_t MAX_SHARDS = 1 << 16;
+
+    /**
+     * @brief A shard given by --shard option.
+     * @param enabled - Shard mode is on
+     * @param index   - Number of the shard, from 0
+     * @param count   - Number of shards
+     */
+    typedef struct {
+        int enabled;
+        size_t index, count;
+    } Shard;
+
+    /**
+     * @brief Parses "i/N" with 0 <= i < N <= MAX_SHARDS.
+     * @param [out] *shard - Shard
+     * @param [in]  *spec  - Text of option
+     * @return 1 if spec is right and 0 otherwise
+     */
+    int parse_shard(Shard *shard, const char *spec);
+
+    /**
+     * @brief Returns byte range of the shard in a file of size bytes before it is moved to whole lines.
+     * @param [in]  *shard - Shard
+     * @param [in]  size   - Size of file
+     * @param [out] *begin - First byte
+     * @param [out] *end   - Byte after the last one
+     * @return void
+     */
+    void shard_range(const Shard *shard, size_t size, size_t *begin, size_t *end);
+
+    /**
+     * @brief Appends equations of the lines of file which belong to the shard to arena.
+     * @details Only the bytes of the shard and of the lines on its borders are read, so the file can't be compressed.
+     * @param [out] *equations - Arena to append equations
+     * @param [in]  *name      - Name of text file with equations
+     * @param [in]  *shard     - Shard
+     * @return number of appended equations or -1 if file can't be read
+     */
+    int shard_input(quadratic::EquationArena *equations, const char *name, const Shard *shard);
+
+    /**
+     * @brief Writes outputs of shards to fd in order, equations are numbered through all of them (build/merge).
+     * @details Plain lines "Equation N ..." and csv/tsv lines "N,..." are renumbered, other lines are copied as is. Header of csv/tsv
+     * is written once, from the first shard.
+     * @param [in]  **files  - Outputs of shards 0..count-1
+     * @param [in]  count    - Number of shards
+     * @param [in]  fd       - File descriptor of merged output
+     * @param [out] *merged  - Number of merged equations
+     * @return 1 if everything was written and 0 otherwise
+     */
+    int merge_outputs(FILE **files, int count, int fd, size_t *merged);
+}
+
+#endif
@@ -0,0 +1,141 @@
+#include <stdio.h>
+#include <atomic>
+
+#include "common.h"
+#include "options.h"
+#include "pool.h"
+#include "precision.h"
+#include "stats.h"
+#include "cache.h"
+#include "adaptive.h"
+#include "solver.h"
+
+namespace quadratic {
+    /// Number of equations in one chunk of thread pool's job.
+    static const size_t SOLVE_CHUNK = 4096;
+
+    /**
+     * @brief Context of solve_chunk.
+     * @param equations - Array of equations
+     * @param type      - Type of numbers used to solve
+     * @param caches    - Solve cache of each worker (NULL if --cache is off)
+     * @param solved    - Number of equations solved without QE_QUAD_ERROR
+     * @param escalated - Number of equations solved in long double by NT_ADAPTIVE
+     */
+    typedef struct {
+        Equation *equations;
+        NUMBER_TYPE type;
+        SolveCache *caches;
+        std::atomic<size_t> solved;
+        std::atomic<size_t> escalated;
+    } SolveContext;
+
+    /**
+     * @brief Solves equations [begin, end) of SolveContext (look parallel::TASK).
+     */
+    static void solve_chunk(void *context, size_t begin, size_t end, int worker);
+
+    /**
+     * @brief Solves equations [begin, end) like solve_range_as, through cache if it is given, measuring every equation if statistics are
+     * on (look stats.h). Number of equations escalated by NT_ADAPTIVE is added to *escalated.
+     * @return number of equations which were solved without QE_QUAD_ERROR
+     */
+    static size_t solve_range(NUMBER_TYPE type, SolveCache *cache, Equation *equations, size_t begin, size_t end, size_t *escalated);
+
+    /**
+     * @brief Prints hit and miss counts of caches to stderr.
+     */
+    static void print_cache(const SolveCache *caches, int count);
+
+    static size_t solve_range(NUMBER_TYPE type, SolveCache *cache, Equation *equations, size_t begin, size_t end, size_t *escalated) {
+        int measure = stats::stats_enabled();
+        if (!measure && cache == NULL) {
+            return (type == NT_ADAPTIVE) ? solve_adaptive(equations + begin, end - begin, escalated) : solve_range_as(type, equations, begin, end);
+        }
+
+        stats::StatsBlock block = {};
+        size_t solved = 0;
+        for (size_t i = begin; i < end; ++i) {
+            uint64_t start = measure ? stats::stats_now() : 0;
+            if (cache != NULL) {
+                solved += (equations[i].num_roots = cached_solve(cache, &equations[i])) != QE_QUAD_ERROR;
+            } else if (type == NT_ADAPTIVE) {
+                solved += solve_adaptive(equations + i, 1, escalated);
+            } else {
+                solved += solve_range_as(type, equations, i, i + 1);
+            }
+            if (measure) {
+                stats::stats_solved(&block, equations[i].num_roots, stats::stats_now() - start);
+            }
+        }
+        if (measure) {
+            stats::stats_merge(&block);
+        }
+        return solved;
+    }
+
+    static void solve_chunk(void *context, size_t begin, size_t end, int worker) {
+        SolveContext *solve = (SolveContext *)context;
+        size_t escalated = 0;
+        solve->solved += solve_range(solve->type, (solve->caches != NULL) ? solve->caches + worker : NULL, solve->equations, begin, end, &escalated);
+        solve->escalated += escalated;
+    }
+
+    static void print_cache(const SolveCache *caches, int count) {
+        size_t hits = 0, misses = 0, bypasses = 0;
+        for (int i = 0; i < count; ++i) {
+            hits     += caches[i].hits;
+            misses   += caches[i].misses;
+            bypasses += caches[i].bypasses;
+        }
+        fprintf(stderr, "Solve cache: %zu hits, %zu misses, %zu bypassed\n", hits, misses, bypasses);
+    }
+
+    size_t solve_equations(Equation *equations, size_t size, const options::Options *options) {
+        ASSERTIF(equations != NULL || size == 0, "nullptr in equations", 0);
+
+        NUMBER_TYPE type = (options != NULL) ? options->type : NT_LONG_DOUBLE;
+        int threaded = options != NULL && options->threads > 1 && size > SOLVE_CHUNK;
+
+        parallel::ThreadPool *pool = threaded ? parallel::make_pool(options->threads) : NULL;
+        ASSERTIF(pool != NULL || !threaded, "unable to start threads", 0);
+
+        int workers = threaded ? parallel::pool_size(pool) : 1;
+        SolveCache *caches = NULL;
+        if (options != NULL && options->cache && type == NT_LONG_DOUBLE) {
+            caches = new SolveCache[(size_t)workers]();
+            int allocated = 1;
+            for (int worker = 0; worker < workers; ++worker) {
+                allocated &= make_cache(caches + worker);
+            }
+            if (!allocated) {
+                fprintf(stderr, "Unable to alloc solve cache, equations are solved without it\n");
+                for (int worker = 0; worker < workers; ++worker) {
+                    free_cache(caches + worker);
+                }
+                delete[] caches;
+                caches = NULL;
+            }
+        }
+
+        SolveContext context = {equations, type, caches, {0}, {0}};
+        if (threaded) {
+            parallel::pool_for(pool, size, SOLVE_CHUNK, solve_chunk, &context);
+            parallel::free_pool(pool);
+        } else {
+            solve_chunk(&context, 0, size, 0);
+        }
+
+        if (caches != NULL) {
+            print_cache(caches, workers);
+            for (int worker = 0; worker < workers; ++worker) {
+                free_cache(caches + worker);
+            }
+            delete[] caches;
+        }
+        if (type == NT_ADAPTIVE) {
+            fprintf(stderr, "Adaptive precision: %zu of %zu equations escalated to long double\n", context.escalated.load(), size);
+        }
+        return context.solved;
+    }
+}
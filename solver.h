@@ -0,0 +1,25 @@
+#ifndef SOLVER_DEF
+#define SOLVER_DEF
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "quadratic.h"
+
+namespace quadratic {
+    /**
+     * @brief Solves a plenty of equations.
+     * @details Writes number of roots and roots into every equation like main's loop: equation->num_roots = solve_equation(equation).
+     * If options->threads > 1, equations are cut into chunks which are solved by a work-stealing thread pool. Every equation is solved by
+     * solve_equation, so results don't depend on number of threads. If options->type is not NT_LONG_DOUBLE, equations are solved by
+     * solve_equation<T> of that type (look precision.h) and roots are converted back to long double. If options->cache is set (and type is
+     * long double), every thread solves through its own SolveCache (look cache.h) and hit and miss counts are printed to stderr.
+     * @param [in, out] *equations - Array of equations
+     * @param [in]      size       - Number of equations
+     * @param [in]      *options   - Options of the program (may be NULL)
+     * @return number of equations which were solved without QE_QUAD_ERROR
+     */
+    size_t solve_equations(Equation *equations, size_t size, const options::Options *options = NULL);
+}
+
+#endif
@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+
+#include "common.h"
+#include "stats.h"
+
+#ifndef _NSTATS
+namespace stats {
+    /**
+     * @brief Global counters of one stage.
+     * @param calls - Number of measured intervals
+     * @param items - Number of processed equations
+     * @param ns    - Total time
+     */
+    typedef struct {
+        std::atomic<uint64_t> calls, items, ns;
+    } StageCounters;
+
+    /// Names of stages in report.
+    static const char *const STAGE_NAMES[SS_COUNT] = {"input", "parse", "solve", "output"};
+
+    /// Names of root classes in report (index is num_roots + 1).
+    static const char *const CLASS_NAMES[STATS_CLASSES] = {"error", "default", "zero", "one", "two", "inf"};
+
+    static int enabled = 0;
+    static STATS_FORMAT report_format = SF_TABLE;
+    static StageCounters stages[SS_COUNT];
+    static std::atomic<uint64_t> roots[STATS_CLASSES];
+    static std::atomic<uint64_t> latency[STATS_BUCKETS];
+
+    /**
+     * @brief Returns upper bound of latency of given share of solved equations (from histogram).
+     * @param [in] counts - Histogram
+     * @param [in] total  - Number of equations in histogram
+     * @param [in] share  - 0.5 for p50, 0.99 for p99
+     * @return Upper bound of bucket in ns or 0 if histogram is empty
+     */
+    static uint64_t percentile(const uint64_t *counts, uint64_t total, double share);
+
+    /**
+     * @brief Prints report as a table.
+     */
+    static void report_table(const uint64_t *counts, uint64_t total);
+
+    /**
+     * @brief Prints report as JSON.
+     */
+    static void report_json(const uint64_t *counts, uint64_t total);
+
+    int stats_enable(STATS_FORMAT format) {
+        if (!enabled) {
+            atexit(stats_report);
+        }
+        enabled = 1;
+        report_format = format;
+        return 1;
+    }
+
+    int stats_enabled() {
+        return enabled;
+    }
+
+    void stats_stage(STATS_STAGE stage, uint64_t ns, size_t items) {
+        ASSERTIF(stage >= 0 && stage < SS_COUNT, "wrong stage", );
+
+        stages[stage].calls.fetch_add(1, std::memory_order_relaxed);
+        stages[stage].items.fetch_add(items, std::memory_order_relaxed);
+        stages[stage].ns.fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    void stats_merge(const StatsBlock *block) {
+        ASSERTIF(block != NULL, "nullptr in block", );
+
+        uint64_t solved = 0;
+        for (int i = 0; i < STATS_CLASSES; ++i) {
+            roots[i].fetch_add(block->roots[i], std::memory_order_relaxed);
+            solved += block->roots[i];
+        }
+        for (int i = 0; i < STATS_BUCKETS; ++i) {
+            latency[i].fetch_add(block->latency[i], std::memory_order_relaxed);
+        }
+        if (solved != 0) {
+            stats_stage(SS_SOLVE, block->ns, solved);
+        }
+    }
+
+    static uint64_t percentile(const uint64_t *counts, uint64_t total, double share) {
+        uint64_t seen = 0;
+        for (int i = 0; i < STATS_BUCKETS; ++i) {
+            seen += counts[i];
+            if (total != 0 && (double)seen >= share * (double)total)
+                return 1ULL << i;
+        }
+        return 0;
+    }
+
+    static void report_table(const uint64_t *counts, uint64_t total) {
+        fprintf(stderr, "\nStatistics:\n%-8s %8s %12s %12s %10s\n", "stage", "calls", "equations", "total ms", "ns/eq");
+        for (int stage = 0; stage < SS_COUNT; ++stage) {
+            uint64_t items = stages[stage].items, ns = stages[stage].ns;
+            fprintf(stderr, "%-8s %8llu %12llu %12.3f %10.1f\n", STAGE_NAMES[stage], (unsigned long long)stages[stage].calls.load(),
+                    (unsigned long long)items, (double)ns / 1e6, (items != 0) ? (double)ns / (double)items : 0.0);
+        }
+
+        fprintf(stderr, "Root classes:");
+        for (int i = 0; i < STATS_CLASSES; ++i) {
+            fprintf(stderr, " %s %llu%s", CLASS_NAMES[i], (unsigned long long)roots[i].load(), (i + 1 < STATS_CLASSES) ? "," : "\n");
+        }
+
+        fprintf(stderr, "Solve latency: p50 < %llu ns, p99 < %llu ns\n", (unsigned long long)percentile(counts, total, 0.5),
+                (unsigned long long)percentile(counts, total, 0.99));
+        for (int i = 0; i < STATS_BUCKETS; ++i) {
+            if (counts[i] == 0)
+                continue;
+            unsigned long long lower = (i == 0) ? 0ULL : 1ULL << (i - 1);
+            if (i + 1 < STATS_BUCKETS) {
+                fprintf(stderr, "  [%8llu, %8llu) ns %12llu\n", lower, 1ULL << i, (unsigned long long)counts[i]);
+            } else {
+                fprintf(stderr, "  [%8llu,      inf) ns %12llu\n", lower, (unsigned long long)counts[i]);
+            }
+        }
+    }
+
+    static void report_json(const uint64_t *counts, uint64_t total) {
+        fprintf(stderr, "{\"stages\": {");
+        for (int stage = 0; stage < SS_COUNT; ++stage) {
+            fprintf(stderr, "\"%s\": {\"calls\": %llu, \"equations\": %llu, \"ns\": %llu}%s", STAGE_NAMES[stage],
+                    (unsigned long long)stages[stage].calls.load(), (unsigned long long)stages[stage].items.load(),
+                    (unsigned long long)stages[stage].ns.load(), (stage + 1 < SS_COUNT) ? ", " : "}, ");
+        }
+
+        fprintf(stderr, "\"roots\": {");
+        for (int i = 0; i < STATS_CLASSES; ++i) {
+            fprintf(stderr, "\"%s\": %llu%s", CLASS_NAMES[i], (unsigned long long)roots[i].load(), (i + 1 < STATS_CLASSES) ? ", " : "}, ");
+        }
+
+        fprintf(stderr, "\"latency_ns\": {\"p50\": %llu, \"p99\": %llu, \"buckets\": [", (unsigned long long)percentile(counts, total, 0.5),
+                (unsigned long long)percentile(counts, total, 0.99));
+        for (int i = 0; i < STATS_BUCKETS; ++i) {
+            fprintf(stderr, "%llu%s", (unsigned long long)counts[i], (i + 1 < STATS_BUCKETS) ? ", " : "]}}\n");
+        }
+    }
+
+    void stats_report() {
+        if (!enabled)
+            return;
+
+        uint64_t counts[STATS_BUCKETS] = {}, total = 0;
+        for (int i = 0; i < STATS_BUCKETS; ++i) {
+            total += counts[i] = latency[i];
+        }
+
+        fflush(stdout);
+        if (report_format == SF_JSON) {
+            report_json(counts, total);
+        } else {
+            report_table(counts, total);
+        }
+    }
+}
+#endif
@@ -0,0 +1,111 @@
+#ifndef STATS_DEF
+#define STATS_DEF
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * @brief   This namespace includes instrumentation of the program (--stats).
+ * @details Stages (input, parsing of files, solving, output) have timers and counters of processed equations, solving also has
+ * counters of root classes and a histogram of latency of one solve_equation. Nothing is measured until stats_enable is called,
+ * the report is printed to stderr at exit. If _NSTATS is defined, all functions are empty inline ones and stats.cpp is empty.
+ */
+namespace stats {
+    /// Enumerated type of data with measured stages.
+    typedef enum {
+        SS_INPUT,  ///< terminal_input or reading of stdin in batch mode
+        SS_PARSE,  ///< Parsing of -f/-t files (part of SS_INPUT)
+        SS_SOLVE,  ///< solve_equation
+        SS_OUTPUT, ///< Output loop
+        SS_COUNT   ///< Number of stages
+    } STATS_STAGE;
+
+    /// Layout of report.
+    typedef enum {
+        SF_TABLE, ///< Human readable table
+        SF_JSON   ///< One JSON object
+    } STATS_FORMAT;
+
+    /// Number of root classes: QE_QUAD_ERROR, RN_DEFAULT, RN_ZERO, RN_ONE, RN_TWO, RN_INF.
+    const int STATS_CLASSES = 6;
+
+    /// Number of latency buckets: bucket i counts latencies in [2 ^ (i - 1), 2 ^ i) ns, the last one counts all longer ones.
+    const int STATS_BUCKETS = 24;
+
+    /**
+     * @brief   Counters of solved equations collected by one thread.
+     * @details Threads count equations in their own block and add it to global counters by stats_merge, so solving doesn't share cache lines.
+     * @param roots   - Number of equations of each class (index is num_roots + 1)
+     * @param latency - Histogram of latency of solve_equation
+     * @param ns      - Total time of solving
+     */
+    typedef struct {
+        uint64_t roots[STATS_CLASSES];
+        uint64_t latency[STATS_BUCKETS];
+        uint64_t ns;
+    } StatsBlock;
+
+    /**
+     * @brief Returns monotonic time in ns.
+     */
+    inline uint64_t stats_now() {
+        struct timespec time = {};
+        clock_gettime(CLOCK_MONOTONIC, &time);
+        return (uint64_t)time.tv_sec * 1000000000ULL + (uint64_t)time.tv_nsec;
+    }
+
+#ifndef _NSTATS
+    /**
+     * @brief Turns on measuring and registers printing of report at exit.
+     * @return 1 if statistics are compiled in and 0 otherwise
+     */
+    int stats_enable(STATS_FORMAT format);
+
+    /**
+     * @brief Returns 1 if measuring is on.
+     */
+    int stats_enabled();
+
+    /**
+     * @brief Adds time of a stage.
+     * @param [in] stage - Stage
+     * @param [in] ns    - Time in ns
+     * @param [in] items - Number of processed equations
+     */
+    void stats_stage(STATS_STAGE stage, uint64_t ns, size_t items);
+
+    /**
+     * @brief Counts one solved equation in block.
+     * @param [in, out] *block    - Block of current thread
+     * @param [in]      num_roots - Result of solve_equation
+     * @param [in]      ns        - Latency of solve_equation
+     */
+    inline void stats_solved(StatsBlock *block, int num_roots, uint64_t ns) {
+        int bucket = (ns == 0) ? 0 : 64 - __builtin_clzll(ns);
+        block->roots[(num_roots + 1 >= 0 && num_roots + 1 < STATS_CLASSES) ? num_roots + 1 : 0]++;
+        block->latency[(bucket < STATS_BUCKETS) ? bucket : STATS_BUCKETS - 1]++;
+        block->ns += ns;
+    }
+
+    /**
+     * @brief Adds block to global counters (thread-safe), also adds SS_SOLVE time.
+     */
+    void stats_merge(const StatsBlock *block);
+
+    /**
+     * @brief Prints report to stderr.
+     * @return void
+     */
+    void stats_report();
+#else
+    inline int  stats_enable(STATS_FORMAT) { return 0; }
+    inline int  stats_enabled() { return 0; }
+    inline void stats_stage(STATS_STAGE, uint64_t, size_t) {}
+    inline void stats_solved(StatsBlock *, int, uint64_t) {}
+    inline void stats_merge(const StatsBlock *) {}
+    inline void stats_report() {}
+#endif
+}
+
+#endif
@@ -0,0 +1,263 @@
+#include <stdio.h>
+#include <sched.h>
+#include <unistd.h>
+#include <thread>
+
+#include "common.h"
+#include "stream.h"
+#include "parser.h"
+#include "options.h"
+#include "output.h"
+#include "precision.h"
+#include "cache.h"
+#include "stats.h"
+
+namespace stream {
+    /// Number of empty polls of a ring before thread starts to yield, and then to sleep until producer wakes it.
+    static const int SPIN_POLLS  = 256;
+    static const int YIELD_POLLS = 64;
+
+    /**
+     * @brief Context of stages.
+     * @param fds     - File descriptors of inputs
+     * @param count   - Number of inputs
+     * @param options - Options of the program (may be NULL)
+     * @param blocks  - All blocks
+     * @param free_blocks - Blocks given by writer to reader
+     * @param parsed  - Blocks given by reader to solver
+     * @param solved  - Blocks given by solver to writer
+     * @param out     - Output buffer of writer
+     */
+    struct StreamContext {
+        const int *fds;
+        int count;
+        const options::Options *options;
+        output::OutputBuffer out;
+        StreamBlock blocks[STREAM_BLOCKS];
+        BlockRing free_blocks, parsed, solved;
+
+        StreamContext(): fds(NULL), count(0), options(NULL), out(), blocks(), free_blocks(), parsed(), solved() {}
+        StreamContext(const StreamContext &) = delete;
+        StreamContext &operator=(const StreamContext &) = delete;
+    };
+
+    /**
+     * @brief Takes a block from ring, waiting until it is there: spins, then yields, then sleeps on BlockRing::filled.
+     */
+    static StreamBlock *wait_pop(BlockRing *ring);
+
+    /**
+     * @brief Reader stage: parses inputs one after another into free blocks and gives them to solver.
+     */
+    static void read_stage(StreamContext *context);
+
+    /**
+     * @brief Solver stage: solves equations of parsed blocks and gives them to writer.
+     */
+    static void solve_stage(StreamContext *context);
+
+    /**
+     * @brief Writer stage: writes results of solved blocks and returns blocks to reader.
+     * @return number of solved equations
+     */
+    static size_t write_stage(StreamContext *context);
+
+    int ring_push(BlockRing *ring, StreamBlock *block) {
+        ASSERTIF(ring != NULL, "nullptr in ring", 0);
+
+        size_t tail = ring->tail.load(std::memory_order_relaxed);
+        if (tail - ring->head.load(std::memory_order_acquire) == STREAM_BLOCKS)
+            return 0;
+
+        ring->slots[tail % STREAM_BLOCKS] = block;
+        ring->tail.store(tail + 1, std::memory_order_release);
+
+        // Store of tail is ordered before load of sleeping, so either consumer sees the block or producer sees that it sleeps.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (ring->sleeping.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> guard(ring->lock);
+            ring->filled.notify_one();
+        }
+        return 1;
+    }
+
+    StreamBlock *ring_pop(BlockRing *ring) {
+        ASSERTIF(ring != NULL, "nullptr in ring", NULL);
+
+        size_t head = ring->head.load(std::memory_order_relaxed);
+        if (head == ring->tail.load(std::memory_order_acquire))
+            return NULL;
+
+        StreamBlock *block = ring->slots[head % STREAM_BLOCKS];
+        ring->head.store(head + 1, std::memory_order_release);
+        return block;
+    }
+
+    static StreamBlock *wait_pop(BlockRing *ring) {
+        for (int poll = 0;; ++poll) {
+            StreamBlock *block = ring_pop(ring);
+            if (block != NULL)
+                return block;
+
+            if (poll < SPIN_POLLS) {
+                __builtin_ia32_pause();
+            } else if (poll < SPIN_POLLS + YIELD_POLLS) {
+                sched_yield();
+            } else {
+                std::unique_lock<std::mutex> guard(ring->lock);
+                ring->sleeping.store(1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                ring->filled.wait(guard, [ring] {
+                    return ring->head.load(std::memory_order_relaxed) != ring->tail.load(std::memory_order_acquire);
+                });
+                ring->sleeping.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    static void read_stage(StreamContext *context) {
+        quadratic::QUADRATIC_DEBUG test = quadratic::QD_NDEBUG;
+        StreamBlock *block = NULL;
+        size_t index = 0;
+
+        for (int input = 0; input < context->count; ++input) {
+            parser::FdParser parser = {};
+            if (!parser::make_parser(&parser, context->fds[input], test)) {
+                printf("Unable to alloc parser\n");
+                parser::free_parser(&parser);
+                continue;
+            }
+
+            while (1) {
+                if (block == NULL) {
+                    block = wait_pop(&context->free_blocks);
+                    block->equations.size = 0;
+                    block->first = index;
+                    block->last = 0;
+                }
+
+                uint64_t start = stats::stats_now();
+                size_t read = parser::parser_next(&parser, &block->equations, STREAM_BLOCK - block->equations.size);
+                if (read == 0)
+                    break;
+                stats::stats_stage(stats::SS_PARSE, stats::stats_now() - start, read);
+
+                // Block is full or everything read from input is parsed: pass it on so results don't wait for the next read(2).
+                index += read;
+                ring_push(&context->parsed, block);
+                block = NULL;
+            }
+            parser::free_parser(&parser);
+        }
+
+        if (block == NULL) {
+            block = wait_pop(&context->free_blocks);
+            block->equations.size = 0;
+            block->first = index;
+        }
+        block->last = 1;
+        ring_push(&context->parsed, block);
+    }
+
+    static void solve_stage(StreamContext *context) {
+        const options::Options *options = context->options;
+        quadratic::NUMBER_TYPE type = (options != NULL) ? options->type : quadratic::NT_LONG_DOUBLE;
+
+        quadratic::SolveCache cache = {};
+        int cached = options != NULL && options->cache && type == quadratic::NT_LONG_DOUBLE && quadratic::make_cache(&cache);
+
+        int last = 0;
+        while (!last) {
+            StreamBlock *block = wait_pop(&context->parsed);
+            quadratic::Equation *equations = block->equations.records;
+            size_t size = block->equations.size;
+            last = block->last;
+
+            uint64_t start = stats::stats_now();
+            if (cached) {
+                for (size_t i = 0; i < size; ++i) {
+                    equations[i].num_roots = quadratic::cached_solve(&cache, &equations[i]);
+                }
+            } else {
+                quadratic::solve_range_as(type, equations, 0, size);
+            }
+            stats::stats_stage(stats::SS_SOLVE, stats::stats_now() - start, size);
+
+            ring_push(&context->solved, block);
+        }
+
+        if (cached) {
+            fprintf(stderr, "Solve cache: %zu hits, %zu misses, %zu bypassed\n", cache.hits, cache.misses, cache.bypasses);
+        }
+        quadratic::free_cache(&cache);
+    }
+
+    static size_t write_stage(StreamContext *context) {
+        output::OUTPUT_FORMAT format = (context->options != NULL) ? context->options->format : output::OF_PLAIN;
+        output::OutputBuffer *out = &context->out;
+        output::write_header(out, format);
+
+        size_t solved = 0;
+        int last = 0;
+        while (!last) {
+            StreamBlock *block = ring_pop(&context->solved);
+            if (block == NULL) {
+                // Nothing to write right now: flush what was written, so results of a slow pipe are not held in buffer.
+                if (out->size != 0) {
+                    output::output_flush(out);
+                }
+                block = wait_pop(&context->solved);
+            }
+
+            uint64_t start = stats::stats_now();
+            const quadratic::Equation *equations = block->equations.records;
+            for (size_t i = 0; i < block->equations.size; ++i) {
+                output::write_equation(out, block->first + i + 1, equations + i, format);
+                solved += equations[i].num_roots != quadratic::QE_QUAD_ERROR;
+            }
+            stats::stats_stage(stats::SS_OUTPUT, stats::stats_now() - start, block->equations.size);
+
+            last = block->last;
+            ring_push(&context->free_blocks, block);
+        }
+
+        return solved;
+    }
+
+    size_t run_stream(const int *fds, int count, const options::Options *options) {
+        ASSERTIF(fds != NULL || count == 0, "nullptr in fds", 0);
+
+        StreamContext *context = new StreamContext();
+        context->fds = fds;
+        context->count = count;
+        context->options = options;
+
+        int allocated = output::make_output(&context->out, STDOUT_FILENO);
+        context->out.numbers = (options != NULL) ? options->numbers : format::NF_FIXED;
+        for (size_t i = 0; i < STREAM_BLOCKS; ++i) {
+            allocated &= quadratic::make_arena(&context->blocks[i].equations, STREAM_BLOCK);
+            ring_push(&context->free_blocks, context->blocks + i);
+        }
+        if (!allocated) {
+            printf("Unable to alloc memory for stream\n");
+            for (size_t i = 0; i < STREAM_BLOCKS; ++i) {
+                quadratic::free_arena(&context->blocks[i].equations);
+            }
+            output::free_output(&context->out);
+            delete context;
+            return 0;
+        }
+
+        std::thread reader(read_stage, context), solver(solve_stage, context);
+        size_t solved = write_stage(context);
+        reader.join();
+        solver.join();
+
+        output::free_output(&context->out);
+        for (size_t i = 0; i < STREAM_BLOCKS; ++i) {
+            quadratic::free_arena(&context->blocks[i].equations);
+        }
+        delete context;
+        return solved;
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef STREAM_DEF
+#define STREAM_DEF
+
+#include <stddef.h>
+#include <stdio.h>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+#include "quadratic.h"
+#include "arena.h"
+
+/**
+ * @brief   This namespace includes the streaming mode of the program (--stream).
+ * @details Reader, solver and writer are separate threads connected by single-producer single-consumer lock-free rings of blocks.
+ * There is a fixed number of blocks (STREAM_BLOCKS of STREAM_BLOCK equations): reader takes a free block, fills it by parser_next
+ * and gives it to solver, solver gives it to writer, writer returns it to reader. So memory doesn't depend on size of input, and
+ * a block is passed on as soon as it is full or all data already read from input is parsed, so the first results of a pipe come out
+ * right away.
+ */
+namespace stream {
+    /// Number of equations in one block.
+    const size_t STREAM_BLOCK = 4096;
+
+    /// Number of blocks (power of 2, it is also capacity of every ring, so a ring is never full).
+    const size_t STREAM_BLOCKS = 8;
+
+    /**
+     * @brief A block of equations passed between stages.
+     * @param equations - Equations of block (arena with capacity STREAM_BLOCK, size is reset when block is reused)
+     * @param first     - Index of the first equation in the whole stream
+     * @param last      - This block is the end of stream (it may be empty)
+     */
+    typedef struct {
+        quadratic::EquationArena equations;
+        size_t first;
+        int last;
+    } StreamBlock;
+
+    /**
+     * @brief   Bounded single-producer single-consumer lock-free ring of blocks.
+     * @details Producer writes slot and then publishes it by tail, consumer reads slot and then frees it by head. Head and tail are on
+     * separate cache lines. A consumer which has waited too long sets sleeping and sleeps on filled, producer takes lock and wakes it
+     * only if sleeping is set, so pushes and pops of a busy ring stay lock-free.
+     */
+    struct BlockRing {
+        StreamBlock *slots[STREAM_BLOCKS];
+        alignas(64) std::atomic<size_t> head;
+        alignas(64) std::atomic<size_t> tail;
+        alignas(64) std::atomic<int> sleeping;
+        std::mutex lock;
+        std::condition_variable filled;
+
+        BlockRing(): slots(), head(0), tail(0), sleeping(0), lock(), filled() {}
+        BlockRing(const BlockRing &) = delete;
+        BlockRing &operator=(const BlockRing &) = delete;
+    };
+
+    /**
+     * @brief Appends block to ring.
+     * @return 1 if block was appended and 0 if ring is full
+     */
+    int ring_push(BlockRing *ring, StreamBlock *block);
+
+    /**
+     * @brief Takes the oldest block from ring.
+     * @return Block or NULL if ring is empty
+     */
+    StreamBlock *ring_pop(BlockRing *ring);
+
+    /**
+     * @brief Solves equations of given file descriptors one after another (as one stream) and writes results to stdout.
+     * @details Results are written like in batch mode, in options->format, with numbering through all inputs. Equations are solved in
+     * options->type, through a SolveCache if options->cache is set.
+     * @param [in] *fds     - File descriptors of inputs
+     * @param [in] count    - Number of inputs
+     * @param [in] *options - Options of the program (may be NULL)
+     * @return number of solved equations
+     */
+    size_t run_stream(const int *fds, int count, const options::Options *options);
+}
+
+#endif
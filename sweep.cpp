@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "common.h"
+#include "sweep.h"
+#include "options.h"
+#include "solver.h"
+#include "output.h"
+#include "stats.h"
+
+namespace sweep {
+    /// Part of step by which stop may be missed because of rounding and still be included.
+    static const long double STEP_TOLERANCE = 1e-9L;
+
+    /// Maximal number of values of one coefficient.
+    static const long double MAX_COUNT = 1e18L;
+
+    /**
+     * @brief Parses a number like strtold and moves *text after it.
+     * @return 1 if there is a finite number and 0 otherwise
+     */
+    static int parse_value(const char **text, long double *value);
+
+    static int parse_value(const char **text, long double *value) {
+        char *end = NULL;
+        *value = strtold(*text, &end);
+        if (end == *text || !isfinite(*value))
+            return 0;
+
+        *text = end;
+        return 1;
+    }
+
+    int parse_axis(Sweep *sweep, const char *spec) {
+        ASSERTIF(sweep != NULL, "nullptr in sweep", 0);
+        ASSERTIF(spec  != NULL, "nullptr in spec",  0);
+
+        if (spec[0] < 'a' || spec[0] > 'c' || spec[1] != '=')
+            return 0;
+
+        SweepAxis axis = {0, 0, 1};
+        const char *text = spec + 2;
+        if (!parse_value(&text, &axis.start))
+            return 0;
+
+        if (*text == ':') {
+            long double stop = 0;
+            text++;
+            if (!parse_value(&text, &stop) || *text++ != ':' || !parse_value(&text, &axis.step) || fpclassify(axis.step) == FP_ZERO)
+                return 0;
+
+            long double steps = (stop - axis.start) / axis.step;
+            if (!(steps > -STEP_TOLERANCE) || !(steps < MAX_COUNT))
+                return 0;
+            axis.count = (size_t)floorl(steps + STEP_TOLERANCE) + 1;
+        }
+        if (*text != '\0')
+            return 0;
+
+        sweep->axes[spec[0] - 'a'] = axis;
+        sweep->enabled = 1;
+        return 1;
+    }
+
+    size_t sweep_size(const Sweep *sweep) {
+        ASSERTIF(sweep != NULL, "nullptr in sweep", 0);
+
+        size_t size = 1;
+        for (int axis = 0; axis < SWEEP_AXES; ++axis) {
+            size_t count = (sweep->axes[axis].count == 0) ? 1 : sweep->axes[axis].count;
+            if (size > SIZE_MAX / count)
+                return 0;
+            size *= count;
+        }
+        return size;
+    }
+
+    void make_points(const Sweep *sweep, size_t first, size_t size, quadratic::Equation *equations) {
+        ASSERTIF(sweep     != NULL, "nullptr in sweep",     );
+        ASSERTIF(equations != NULL, "nullptr in equations", );
+
+        size_t count[SWEEP_AXES] = {}, position[SWEEP_AXES] = {};
+        for (int axis = SWEEP_AXES - 1; axis >= 0; --axis) {
+            count[axis] = (sweep->axes[axis].count == 0) ? 1 : sweep->axes[axis].count;
+            position[axis] = first % count[axis];
+            first /= count[axis];
+        }
+
+        const SweepAxis *a = sweep->axes, *b = sweep->axes + 1, *c = sweep->axes + 2;
+        long double value_a = a->start + (long double)position[0] * a->step, value_b = b->start + (long double)position[1] * b->step;
+        for (size_t i = 0; i < size; ++i) {
+            equations[i] = {value_a, value_b, c->start + (long double)position[2] * c->step, 0, 0, quadratic::RN_DEFAULT};
+
+            if (++position[2] < count[2])
+                continue;
+            position[2] = 0;
+            if (++position[1] == count[1]) {
+                position[1] = 0;
+                position[0]++;
+                value_a = a->start + (long double)position[0] * a->step;
+            }
+            value_b = b->start + (long double)position[1] * b->step;
+        }
+    }
+
+    int run_sweep(const options::Options *options, int fd) {
+        ASSERTIF(options != NULL, "nullptr in options", 1);
+
+        size_t total = sweep_size(&options->sweep);
+        if (total == 0) {
+            printf("Sweep has too many points\n");
+            return 1;
+        }
+
+        size_t capacity = (total < SWEEP_BLOCK) ? total : SWEEP_BLOCK;
+        quadratic::Equation *block = (quadratic::Equation *)calloc(capacity, sizeof(quadratic::Equation));
+        output::OutputBuffer out = {};
+        if (block == NULL || !output::make_output(&out, fd)) {
+            printf("Unable to alloc memory for sweep\n");
+            free(block);
+            return 1;
+        }
+        out.numbers = options->numbers;
+
+        options::Options solve = *options;
+        solve.cache = 0;
+
+        uint64_t made = 0, written = 0;
+        int previous = quadratic::QE_QUAD_ERROR - 1;
+        output::write_header(&out, options->format);
+        for (size_t first = 0; first < total; first += capacity) {
+            size_t size = (total - first < capacity) ? total - first : capacity;
+            uint64_t start = stats::stats_now();
+            make_points(&options->sweep, first, size, block);
+            made += stats::stats_now() - start;
+
+            quadratic::solve_equations(block, size, &solve);
+
+            start = stats::stats_now();
+            for (size_t i = 0; i < size; ++i) {
+                if (!options->sweep.changes || block[i].num_roots != previous) {
+                    output::write_equation(&out, first + i + 1, block + i, options->format);
+                }
+                previous = block[i].num_roots;
+            }
+            written += stats::stats_now() - start;
+        }
+
+        int flushed = output::free_output(&out);
+        stats::stats_stage(stats::SS_INPUT,  made,    total);
+        stats::stats_stage(stats::SS_OUTPUT, written, total);
+        free(block);
+        return flushed ? 0 : 1;
+    }
+}
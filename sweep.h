@@ -0,0 +1,80 @@
+#ifndef SWEEP_DEF
+#define SWEEP_DEF
+
+#include <stddef.h>
+
+#include "quadratic.h"
+
+/**
+ * @brief   This namespace includes the sweep mode of the program (--sweep).
+ * @details Equations of a sweep are a grid over coefficients: every coefficient is a fixed value or a range start:stop:step. Equations
+ * are made lazily in blocks of SWEEP_BLOCK, solved by solve_equations and written right away, so memory doesn't depend on number of
+ * points and nothing is read from disk. Points go in order of a, then b, then c (c changes the fastest).
+ */
+namespace sweep {
+    /// Number of equations in one block.
+    const size_t SWEEP_BLOCK = 1 << 16;
+
+    /// Number of coefficients: a, b and c.
+    const int SWEEP_AXES = 3;
+
+    /**
+     * @brief   Values of one coefficient.
+     * @details Value number i is start + i * step (not a sum of steps, so values don't drift), a fixed value has count 1.
+     * @param start - First value
+     * @param step  - Step between values
+     * @param count - Number of values
+     */
+    typedef struct {
+        long double start, step;
+        size_t count;
+    } SweepAxis;
+
+    /**
+     * @brief A sweep given by --sweep options.
+     * @param enabled - Sweep mode is on
+     * @param changes - Write only equations where number of roots differs from the previous point (--sweep-changes)
+     * @param axes    - Values of a, b and c (0 if coefficient is not given)
+     */
+    typedef struct {
+        int enabled;
+        int changes;
+        SweepAxis axes[SWEEP_AXES];
+    } Sweep;
+
+    /**
+     * @brief Parses one coefficient of a sweep: "name=value" or "name=start:stop:step", name is a, b or c.
+     * @details stop is included if it is start plus a whole number of steps (up to rounding).
+     * @param [in, out] *sweep - Sweep
+     * @param [in]      *spec  - Text of option
+     * @return 1 if spec is right and 0 otherwise
+     */
+    int parse_axis(Sweep *sweep, const char *spec);
+
+    /**
+     * @brief Returns number of points of sweep or 0 if it doesn't fit into size_t.
+     */
+    size_t sweep_size(const Sweep *sweep);
+
+    /**
+     * @brief Makes equations [first, first + size) of sweep.
+     * @param [in]  *sweep     - Sweep
+     * @param [in]  first      - Number of the first point
+     * @param [in]  size       - Number of equations
+     * @param [out] *equations - Array of size equations
+     * @return void
+     */
+    void make_points(const Sweep *sweep, size_t first, size_t size, quadratic::Equation *equations);
+
+    /**
+     * @brief Solves all equations of options->sweep and writes results to fd in options->format.
+     * @details Equations are solved by solve_equations with options (in --type, on -j threads, without --cache because points of a
+     * sweep don't repeat). With options->sweep.changes only the first point and points where num_roots changes are written.
+     * @param [in] *options - Options of the program
+     * @param [in] fd       - File descriptor of output (STDOUT_FILENO in the program)
+     * @return Exit code of the program
+     */
+    int run_sweep(const options::Options *options, int fd);
+}
+
+#endif
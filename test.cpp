@@ -1,8 +1,30 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <zlib.h>
 
 #include "common.h"
 #include "test.h"
+#include "batch.h"
+#include "arena.h"
+#include "precision.h"
+#include "options.h"
+#include "output.h"
+#include "pool.h"
+#include "libquadratic.h"
+#include "format.h"
+#include "compressed.h"
+#include "parser.h"
+#include "cache.h"
+#include "query.h"
+#include "sweep.h"
+#include "shard.h"
+#include "adaptive.h"
 
 namespace unit_tests {
     /**
@@ -13,6 +35,158 @@ namespace unit_tests {
      */
     static int is_equal_roots(const quadratic::Equation *a, const quadratic::Equation* b);
 
+    /**
+     * @brief Runs tests and prints verdict for each of them
+     * @param [in] **tests   - Array of tests
+     * @param [in] num_tests - Number of tests
+     * @return 0 if all tests were run and QE_QUAD_ERROR if one of them is invalid
+     */
+    static int run_tests(quadratic::Equation **tests, int num_tests);
+
+    /// Number of tests in one chunk of thread pool's job in test_bulk.
+    static const size_t BULK_CHUNK = 1 << 14;
+
+    /// Number of classes of num_roots in mismatch table: QE_QUAD_ERROR, RN_DEFAULT, RN_ZERO, RN_ONE, RN_TWO, RN_INF.
+    static const int BULK_CLASSES = 6;
+
+    /**
+     * @brief Results of tests collected by one worker of test_bulk.
+     * @param passed     - Number of passed tests
+     * @param roots      - Number of compared roots (tests with one or two roots where numbers of roots are equal)
+     * @param ulp_roots  - Number of compared nonzero expected roots (ULP of zero is the smallest denormal, so zero roots are not counted in ULP)
+     * @param max_abs    - Maximal absolute error of root
+     * @param sum_abs    - Sum of absolute errors
+     * @param max_ulp    - Maximal error of root in units in the last place of expected root
+     * @param sum_ulp    - Sum of errors in ULP
+     * @param mismatches - Number of tests with expected number of roots (first index) and given one (second index), index is num_roots + 1
+     */
+    typedef struct {
+        size_t passed, roots, ulp_roots;
+        long double max_abs, sum_abs;
+        long double max_ulp, sum_ulp;
+        size_t mismatches[BULK_CLASSES][BULK_CLASSES];
+    } BulkSummary;
+
+    /**
+     * @brief Context of bulk_chunk.
+     * @param tests     - Tests
+     * @param type      - Type of numbers used to solve
+     * @param failed    - Flags of failed tests
+     * @param summaries - Summary of each worker
+     */
+    typedef struct {
+        const quadratic::Equation *tests;
+        quadratic::NUMBER_TYPE type;
+        unsigned char *failed;
+        BulkSummary *summaries;
+    } BulkContext;
+
+    /// Roots of polynomials are equal if they differ less than this part of expected root's modulus plus 1.
+    static const long double POLY_TOLERANCE = 1e-6L;
+
+    /**
+     * @brief Checks if numbers of roots and roots of polynomials are equal (look POLY_TOLERANCE).
+     * @return 1 if they are equal and 0 if not
+     */
+    static int is_equal_polynomial(const quadratic::Polynomial *given, const quadratic::Polynomial *expected);
+
+    /**
+     * @brief Returns index of num_roots in mismatch table.
+     */
+    static int class_index(int num_roots);
+
+    /**
+     * @brief Adds error of given root to summary.
+     */
+    static void add_error(BulkSummary *summary, long double given, long double expected);
+
+    /**
+     * @brief Runs tests [begin, end) of BulkContext (look parallel::TASK).
+     */
+    static void bulk_chunk(void *context, size_t begin, size_t end, int worker);
+
+    /// Strings which parse_number must read like scanf: signs, exponents without digits, long mantissas, hex floats, huge exponents.
+    static const char *const PARSER_STRINGS[] = {
+        "0", "-0", "+.5", "5.", ".", "-", "1e", "1e+", "2E-3x", "1e27", "1e-27", "1e28", "12345678901234567890123",
+        "0.000000000000000000001234", "9999999999999999999", "1e4933", "1e-4960", "0x1p-3", "0x", "-0x1.8p+1", "inf", "-nan", "7,5"
+    };
+
+    /**
+     * @brief Checks if numbers are the same: equal with equal signs, or both NaN.
+     * @return 1 if they are the same and 0 if not
+     */
+    static int is_same_number(long double a, long double b);
+
+    /**
+     * @brief Compares parse_number with sscanf "%Lf" on text: number and end of number must be the same.
+     * @return 1 if they agree and 0 if not
+     */
+    static int is_parsed_like_scanf(const char *text);
+
+    /// Number of copies of every test with changed coefficients in test_adaptive.
+    static const int ADAPTIVE_COPIES = 16;
+
+    /// Roots of NT_ADAPTIVE may differ from solve_equation's ones by this part of the largest root modulus (double gives about 1e-15).
+    static const long double ADAPTIVE_ROOT_TOLERANCE = 1e-16L;
+
+    /// Exact factors of coefficients in test_cache: copies of an equation which share an entry of cache, are told apart by EPS or by sign.
+    static const long double CACHE_FACTORS[] = {1, -1, 0x1p-3L, -0x1p7L, 0x1p40L, -0x1p-40L};
+
+    /// Number of entries of SolveCache in test_cache, small enough to make equations collide and fill the table.
+    static const size_t TEST_CACHE_CAPACITY = 16;
+
+    /// Maximal number of roots and of values of k used as queries in test_query, so it runs in linear time on bulk tests.
+    static const size_t QUERY_TESTS = 256;
+
+    /**
+     * @brief Compares two long double for qsort.
+     */
+    static int compare_numbers(const void *first, const void *second);
+
+    /**
+     * @brief Checks that found roots are the roots of sorted in [lo, hi] (found by a scan) in the same order.
+     * @param [in] *found  - Roots found by index
+     * @param [in] count   - Number of found roots
+     * @param [in] *sorted - All roots sorted by value
+     * @param [in] size    - Number of all roots
+     * @param [in] lo, hi  - Range
+     * @return 1 if roots are the same and 0 if not
+     */
+    static int is_same_range(const query::RootEntry *found, size_t count, const long double *sorted, size_t size, long double lo, long double hi);
+
+    /// Number of sweeps in test_sweep.
+    static const int SWEEP_TESTS = 2;
+
+    /// Arguments of sweeps in test_sweep: every point in csv, and changes of class in a sweep longer than SWEEP_BLOCK.
+    static const char *const SWEEP_ARGS[SWEEP_TESTS][10] = {
+        {"task", "--format", "csv", "--sweep", "a=-1:1:0.5", "--sweep", "b=-2:2:0.25", "--sweep", "c=-1:1:0.125", NULL},
+        {"task", "--sweep-changes", "--sweep", "a=-1:1:1", "--sweep", "b=-1:1:0.5", "--sweep", "c=-1:1:0.0001", NULL}
+    };
+
+    /// Numbers of points of sweeps in test_sweep.
+    static const size_t SWEEP_POINTS[SWEEP_TESTS] = {5 * 17 * 17, 3 * 5 * 20001};
+
+    /**
+     * @brief Writes what run_sweep must write for options: points of the grid are made one by one and solved by solve_equation.
+     * @return number of points
+     */
+    static size_t write_grid(output::OutputBuffer *out, const options::Options *options);
+
+    /**
+     * @brief Checks that file has the same size bytes as data.
+     * @return 1 if they are the same and 0 if not
+     */
+    static int is_same_file(int fd, const char *data, size_t size);
+
+    /// Numbers of shards in test_shard, the last one is more than lines of small files of tests, so some of its shards are empty.
+    static const size_t SHARD_COUNTS[] = {1, 2, 3, 7, 64};
+
+    /**
+     * @brief Solves equations of arena and writes them in format to out, numbered from 1.
+     * @return void
+     */
+    static void write_solved(output::OutputBuffer *out, quadratic::EquationArena *equations, output::OUTPUT_FORMAT format);
+
     static int is_equal_roots(const quadratic::Equation *a, const quadratic::Equation* b) {
         ASSERTIF(a != NULL, "nullptr in a", quadratic::QE_QUAD_ERROR);
         ASSERTIF(b != NULL, "nullptr in b", quadratic::QE_QUAD_ERROR);
@@ -28,9 +202,7 @@ namespace unit_tests {
                (common::is_zero(a->x1 - b->x2) && common::is_zero(a->x2 - b->x1));
     }
 
-    int test_quadratic(quadratic::Equation **tests, int num_tests) {
-        ASSERTIF(tests != NULL, "error in filename", 0);
-        
+    static int run_tests(quadratic::Equation **tests, int num_tests) {
         printf("%s%sTesting proram...\n", COLORS::T_WHITE, COLORS::T_ARTICLE);
 
         printf("\n%sNumber of tests: %3d", COLORS::T_WHITE, num_tests);
@@ -43,8 +215,7 @@ namespace unit_tests {
 
             switch (is_equal_roots(&cur_equation, tests[curtest])) {
             case quadratic::QE_QUAD_ERROR:
-                free_equations(tests, num_tests);
-                return 0;
+                return quadratic::QE_QUAD_ERROR;
             case 0:
                 printf("%s%sWA!%s\n" "  %sEquation: ", COLORS::T_RED, COLORS::T_ARTICLE, COLORS::T_WHITE, COLORS::T_RED);
                 printf(                       "a = %+.8Lg%s\n", tests[curtest]->a, COLORS::T_WHITE);
@@ -63,8 +234,849 @@ namespace unit_tests {
             }
         }
 
-        free_equations(tests, num_tests);
         printf("\n");
         return 0;
     }
+
+    int test_quadratic(quadratic::Equation **tests, int num_tests) {
+        ASSERTIF(tests != NULL, "error in filename", 0);
+
+        run_tests(tests, num_tests);
+        free_equations(tests, num_tests);
+        return 0;
+    }
+
+    int test_quadratic(quadratic::EquationArena *tests) {
+        ASSERTIF(tests != NULL, "nullptr in tests", 0);
+
+        run_tests(quadratic::arena_view(tests), (int)tests->size);
+        return 0;
+    }
+
+    int test_batch(quadratic::Equation **tests, int num_tests) {
+        ASSERTIF(tests != NULL, "nullptr in tests", 1);
+
+        quadratic::EquationBatch batch = {};
+        if (!quadratic::make_batch(&batch, (size_t)num_tests)) {
+            printf("Unable to alloc batch\n");
+            return 1;
+        }
+
+        int failed = 0;
+        for (int kernel = quadratic::BK_SCALAR; kernel <= quadratic::batch_kernel(); ++kernel) {
+            batch.size = 0;
+            for (int curtest = 0; curtest < num_tests; ++curtest) {
+                quadratic::batch_push(&batch, tests[curtest]);
+            }
+            quadratic::solve_batch(&batch, (quadratic::BATCH_KERNEL)kernel);
+
+            // Kernels are compared with solve_equation of the same coefficients, rounded to double by batch_push.
+            int agreed = 0;
+            for (int curtest = 0; curtest < num_tests; ++curtest) {
+                quadratic::Equation expected = {batch.a[curtest], batch.b[curtest], batch.c[curtest], 0, 0, quadratic::RN_DEFAULT};
+                expected.num_roots = quadratic::solve_equation(&expected);
+
+                quadratic::Equation given = expected;
+                given.num_roots = batch.num_roots[curtest];
+                given.x1 = batch.x1[curtest];
+                given.x2 = batch.x2[curtest];
+
+                agreed += is_equal_roots(&given, &expected) == 1;
+            }
+
+            printf("%sBatch kernel %-6s: %3d of %3d agree with solve_equation\n", COLORS::T_WHITE,
+                   quadratic::batch_kernel_name((quadratic::BATCH_KERNEL)kernel), agreed, num_tests);
+            failed += agreed != num_tests;
+        }
+
+        quadratic::free_batch(&batch);
+        return failed;
+    }
+
+    int test_types(quadratic::Equation **tests, int num_tests) {
+        ASSERTIF(tests != NULL, "nullptr in tests", 1);
+
+        const quadratic::NUMBER_TYPE types[] = {quadratic::NT_FLOAT, quadratic::NT_DOUBLE, quadratic::NT_FLOAT128, quadratic::NT_ADAPTIVE};
+
+        int failed = 0;
+        for (size_t type = 0; type < sizeof(types) / sizeof(types[0]); ++type) {
+            int agreed = 0;
+            for (int curtest = 0; curtest < num_tests; ++curtest) {
+                quadratic::Equation expected = *tests[curtest];
+                expected.x1 = expected.x2 = 0;
+                expected.num_roots = quadratic::solve_equation(&expected);
+
+                quadratic::Equation given = expected;
+                given.x1 = given.x2 = 0;
+                quadratic::solve_range_as(types[type], &given, 0, 1);
+
+                agreed += is_equal_roots(&given, &expected) == 1;
+            }
+
+            printf("%sType %-12s: %3d of %3d agree with solve_equation\n", COLORS::T_WHITE, quadratic::number_type_name(types[type]),
+                   agreed, num_tests);
+            failed += agreed != num_tests;
+        }
+
+        return failed;
+    }
+
+    int test_adaptive(quadratic::Equation **tests, int num_tests) {
+        ASSERTIF(tests != NULL, "nullptr in tests", 1);
+
+        // Copies have coefficients which are not exact in double, so roots found in double alone would miss the tolerance.
+        const size_t size = (size_t)num_tests * ADAPTIVE_COPIES;
+        quadratic::Equation *equations = (quadratic::Equation *)calloc(size + 1, sizeof(quadratic::Equation));
+        if (equations == NULL) {
+            printf("Unable to alloc equations for adaptive precision\n");
+            return 1;
+        }
+        for (size_t i = 0; i < size; ++i) {
+            const quadratic::Equation *test = tests[i / ADAPTIVE_COPIES];
+            long double k = (long double)(i % ADAPTIVE_COPIES);
+            equations[i] = {test->a * (1 + k / 7), test->b * (1 - k / 11) + k / 3, test->c * (1 + k / 13) - k / 5, 0, 0, quadratic::RN_DEFAULT};
+        }
+        size_t escalated = 0;
+        quadratic::solve_adaptive(equations, size, &escalated);
+
+        int agreed = 0;
+        for (size_t i = 0; i < size; ++i) {
+            quadratic::Equation expected = equations[i];
+            expected.x1 = expected.x2 = 0;
+            expected.num_roots = quadratic::solve_equation(&expected);
+
+            long double scale = fmaxl(fabsl(expected.x1), fabsl(expected.x2)) * ADAPTIVE_ROOT_TOLERANCE;
+            agreed += equations[i].num_roots == expected.num_roots && !(fabsl(equations[i].x1 - expected.x1) > scale) &&
+                      !(fabsl(equations[i].x2 - expected.x2) > scale);
+        }
+
+        printf("%sAdaptive roots   : %3d of %3zu agree with solve_equation within %.0Lg (%zu escalated)\n", COLORS::T_WHITE, agreed, size,
+               ADAPTIVE_ROOT_TOLERANCE, escalated);
+        free(equations);
+        return agreed != (int)size;
+    }
+
+    int test_capi(quadratic::Equation **tests, int num_tests) {
+        ASSERTIF(tests != NULL, "nullptr in tests", 1);
+
+        quadratic::EquationBatch batch = {};
+        qe_equation *records = (qe_equation *)calloc((size_t)num_tests + 1, sizeof(qe_equation));
+        if (records == NULL || !quadratic::make_batch(&batch, (size_t)num_tests)) {
+            printf("Unable to alloc equations for C ABI\n");
+            free(records);
+            return 1;
+        }
+
+        for (int curtest = 0; curtest < num_tests; ++curtest) {
+            quadratic::batch_push(&batch, tests[curtest]);
+            records[curtest] = {batch.a[curtest], batch.b[curtest], batch.c[curtest], 0, 0, 0};
+        }
+        qe_layout layout = qe_equation_layout();
+        qe_solve_columns(batch.a, batch.b, batch.c, batch.x1, batch.x2, batch.num_roots, batch.size);
+        qe_solve_records(records, (size_t)num_tests, &layout);
+
+        int agreed_columns = 0, agreed_records = 0;
+        for (int curtest = 0; curtest < num_tests; ++curtest) {
+            quadratic::Equation expected = {batch.a[curtest], batch.b[curtest], batch.c[curtest], 0, 0, quadratic::RN_DEFAULT};
+            expected.num_roots = quadratic::solve_equation(&expected);
+
+            quadratic::Equation given = expected;
+            given.num_roots = batch.num_roots[curtest];
+            given.x1 = batch.x1[curtest];
+            given.x2 = batch.x2[curtest];
+            agreed_columns += is_equal_roots(&given, &expected) == 1;
+
+            given.num_roots = records[curtest].num_roots;
+            given.x1 = records[curtest].x1;
+            given.x2 = records[curtest].x2;
+            agreed_records += is_equal_roots(&given, &expected) == 1;
+        }
+
+        printf("%sC ABI columns    : %3d of %3d agree with solve_equation\n", COLORS::T_WHITE, agreed_columns, num_tests);
+        printf("%sC ABI records    : %3d of %3d agree with solve_equation\n", COLORS::T_WHITE, agreed_records, num_tests);
+
+        quadratic::free_batch(&batch);
+        free(records);
+        return (agreed_columns != num_tests) + (agreed_records != num_tests);
+    }
+
+    int test_format(quadratic::Equation **tests, int num_tests) {
+        ASSERTIF(tests != NULL, "nullptr in tests", 1);
+
+        int agreed = 0, total = 0;
+        for (int curtest = 0; curtest < num_tests; ++curtest) {
+            quadratic::Equation equation = *tests[curtest];
+            equation.x1 = equation.x2 = 0;
+            equation.num_roots = quadratic::solve_equation(&equation);
+
+            const long double numbers[] = {equation.a, equation.b, equation.c, equation.x1, equation.x2};
+            for (size_t i = 0; i < sizeof(numbers) / sizeof(numbers[0]); ++i) {
+                const long double values[] = {numbers[i], nextafterl(numbers[i], -INFINITY), nextafterl(numbers[i], INFINITY)};
+                for (size_t j = 0; j < sizeof(values) / sizeof(values[0]); ++j) {
+                    char given[format::NUMBER_LENGTH] = "", expected[format::NUMBER_LENGTH] = "";
+                    int same = 1;
+
+                    format::format_number(given, values[j], format::NF_FIXED);
+                    snprintf(expected, sizeof(expected), "%+-10.5Lg", values[j]);
+                    same &= strcmp(given, expected) == 0;
+
+                    format::format_number(given, values[j], format::NF_SHORTEST);
+                    snprintf(expected, sizeof(expected), "%+-10.*Lg", format::shortest_precision(values[j]), values[j]);
+                    same &= strcmp(given, expected) == 0;
+
+                    format::format_number(given, values[j], format::NF_HEX);
+                    snprintf(expected, sizeof(expected), "%+-10La", values[j]);
+                    same &= strcmp(given, expected) == 0;
+
+                    agreed += same;
+                    total++;
+                }
+            }
+        }
+
+        printf("%sNumber formats   : %3d of %3d numbers agree with printf\n", COLORS::T_WHITE, agreed, total);
+        return agreed != total;
+    }
+
+    int test_compressed(quadratic::Equation **tests, int num_tests) {
+        ASSERTIF(tests != NULL, "nullptr in tests", 1);
+
+        char name[] = "/tmp/quadratic_testXXXXXX";
+        int fd = mkstemp(name);
+        gzFile gzip = (fd >= 0) ? gzdopen(dup(fd), "wb") : NULL;
+        if (gzip == NULL) {
+            printf("Unable to create compressed file\n");
+            if (fd >= 0) {
+                close(fd);
+                unlink(name);
+            }
+            return 1;
+        }
+        int written = 1;
+        for (int curtest = 0; curtest < num_tests; ++curtest) {
+            written &= gzprintf(gzip, "%.21Lg %.21Lg %.21Lg\n", tests[curtest]->a, tests[curtest]->b, tests[curtest]->c) > 0;
+        }
+        written &= gzclose(gzip) == Z_OK;
+
+        // The file is unlinked after the loop, whichever way the loop ends.
+        int agreed = 0, truncated = 0;
+        for (int cut = 0; cut < 2 && written; ++cut) {
+            struct stat info = {};
+            if (cut && (fstat(fd, &info) != 0 || ftruncate(fd, info.st_size / 2) != 0)) {
+                printf("Unable to cut compressed file: %s\n", strerror(errno));
+                break;
+            }
+
+            quadratic::EquationArena equations = {};
+            compressed::Input input = {};
+            if (!quadratic::make_arena(&equations, (size_t)num_tests + 1) || !compressed::open_input(&input, name)) {
+                quadratic::free_arena(&equations);
+                break;
+            }
+            parser::parse_fd(&equations, input.fd, quadratic::QD_NDEBUG);
+            int complete = compressed::close_input(&input);
+
+            for (size_t i = 0; !cut && complete && i < equations.size && i < (size_t)num_tests; ++i) {
+                const quadratic::Equation *equation = quadratic::arena_view(&equations)[i];
+                agreed += !(equation->a < tests[i]->a || equation->a > tests[i]->a) && !(equation->b < tests[i]->b || equation->b > tests[i]->b) &&
+                          !(equation->c < tests[i]->c || equation->c > tests[i]->c);
+            }
+            truncated = cut && !complete;
+            quadratic::free_arena(&equations);
+        }
+        close(fd);
+        unlink(name);
+
+        if (!written) {
+            printf("Unable to write compressed file\n");
+        }
+        printf("%sGzip input       : %3d of %3d equations agree with tests\n", COLORS::T_WHITE, agreed, num_tests);
+        printf("%sGzip cut in half : %s\n", COLORS::T_WHITE, truncated ? "detected" : "NOT detected");
+        return (agreed != num_tests) + !truncated;
+    }
+
+    int self_test(quadratic::EquationArena *tests) {
+        ASSERTIF(tests != NULL, "nullptr in tests", 1);
+
+        quadratic::Equation **view = quadratic::arena_view(tests);
+        int num_tests = (int)tests->size;
+        if (view == NULL) {
+            printf("Unable to alloc tests\n");
+            return 1;
+        }
+
+        int failed = 0;
+        failed += test_batch(view, num_tests);
+        failed += test_types(view, num_tests);
+        failed += test_adaptive(view, num_tests);
+        failed += test_capi(view, num_tests);
+        failed += test_format(view, num_tests);
+        failed += test_compressed(view, num_tests);
+        failed += test_parser(view, num_tests);
+        failed += test_cache(view, num_tests);
+        failed += test_query(view, num_tests);
+        failed += test_sweep();
+        failed += test_shard(view, num_tests);
+
+        printf("%sSelf-tests       : %s\n", COLORS::T_WHITE, (failed == 0) ? "passed" : "FAILED");
+        return failed;
+    }
+
+    static int is_same_number(long double a, long double b) {
+        return (isnan(a) && isnan(b)) || (!(a < b || a > b) && !signbit(a) == !signbit(b));
+    }
+
+    static int is_parsed_like_scanf(const char *text) {
+        long double expected = 0;
+        int length = 0;
+        const char *end = NULL, *expected_end = (sscanf(text, "%Lf%n", &expected, &length) == 1) ? text + length : text;
+
+        long double given = parser::parse_number(text, &end);
+        return end == expected_end && (end == text || is_same_number(given, expected));
+    }
+
+    int test_parser(quadratic::Equation **tests, int num_tests) {
+        ASSERTIF(tests != NULL, "nullptr in tests", 1);
+
+        int agreed = 0, total = 0;
+        for (size_t i = 0; i < sizeof(PARSER_STRINGS) / sizeof(PARSER_STRINGS[0]); ++i, ++total) {
+            agreed += is_parsed_like_scanf(PARSER_STRINGS[i]);
+        }
+        for (int curtest = 0; curtest < num_tests; ++curtest) {
+            const quadratic::Equation *test = tests[curtest];
+            const long double numbers[] = {test->a, test->b, test->c, test->x1, test->x2};
+            for (size_t i = 0; i < sizeof(numbers) / sizeof(numbers[0]); ++i) {
+                const long double values[] = {numbers[i], nextafterl(numbers[i], -INFINITY), nextafterl(numbers[i], INFINITY)};
+                for (size_t j = 0; j < sizeof(values) / sizeof(values[0]); ++j) {
+                    char text[format::NUMBER_LENGTH * 8] = "";
+                    snprintf(text, sizeof(text), "%.21Lg %.5Lg %.3Le %La", values[j], values[j], values[j], values[j]);
+                    for (const char *number = text; number != NULL; number = strchr(number, ' '), number += (number != NULL), ++total) {
+                        agreed += is_parsed_like_scanf(number);
+                    }
+                }
+            }
+        }
+        printf("%sNumber parser    : %3d of %3d numbers agree with scanf\n", COLORS::T_WHITE, agreed, total);
+
+        // Tests are written with different spaces and an incomplete group at the end, then read by parse_text and by fscanf.
+        const size_t line = 6 * format::NUMBER_LENGTH * 4;
+        char *text = (char *)calloc((size_t)num_tests * line + sizeof(" 1 2"), 1);
+        quadratic::EquationArena parsed = {}, scanned = {};
+        if (text == NULL || !quadratic::make_arena(&parsed) || !quadratic::make_arena(&scanned)) {
+            printf("Unable to alloc text of tests\n");
+            free(text);
+            quadratic::free_arena(&parsed);
+            quadratic::free_arena(&scanned);
+            return 1;
+        }
+        size_t size = 0;
+        for (int curtest = 0; curtest < num_tests; ++curtest) {
+            const quadratic::Equation *test = tests[curtest];
+            size += (size_t)snprintf(text + size, line, (curtest % 2) ? "%.21Lg\t%.5Lg  %La\r\n%d %.21Lg %.17Lg\n" : "%La %.17Lg %.21Lg %d\n%La %.5Le ",
+                                     test->a, test->b, test->c, test->num_roots, test->x1, test->x2);
+        }
+        memcpy(text + size, " 1 2", sizeof(" 1 2"));
+        size += sizeof(" 1 2") - 1;
+
+        parser::parse_text(&parsed, text, size, quadratic::QD_DEBUG);
+        FILE *stream = fmemopen(text, size, "r");
+        if (stream != NULL) {
+            parser::scan_stream(&scanned, stream, quadratic::QD_DEBUG);
+            fclose(stream);
+        }
+
+        int same = 0;
+        for (size_t i = 0; i < parsed.size && parsed.size == scanned.size; ++i) {
+            const quadratic::Equation *given = quadratic::arena_view(&parsed)[i], *expected = quadratic::arena_view(&scanned)[i];
+            same += is_same_number(given->a, expected->a) && is_same_number(given->b, expected->b) && is_same_number(given->c, expected->c) &&
+                    given->num_roots == expected->num_roots && is_same_number(given->x1, expected->x1) && is_same_number(given->x2, expected->x2);
+        }
+        printf("%sText parser      : %3d of %3d equations agree with scanf\n", COLORS::T_WHITE, same, num_tests);
+        same -= parsed.size != (size_t)num_tests;
+
+        free(text);
+        quadratic::free_arena(&parsed);
+        quadratic::free_arena(&scanned);
+        return (agreed != total) + (same != num_tests);
+    }
+
+    int test_cache(quadratic::Equation **tests, int num_tests) {
+        ASSERTIF(tests != NULL, "nullptr in tests", 1);
+
+        quadratic::SolveCache cache = {};
+        if (!quadratic::make_cache(&cache, TEST_CACHE_CAPACITY)) {
+            printf("Unable to alloc cache\n");
+            return 1;
+        }
+
+        // Every copy is solved twice, so the second solve of each one is a lookup unless the entry was overwritten.
+        int agreed = 0, total = 0;
+        for (int pass = 0; pass < 2; ++pass) {
+            for (int curtest = 0; curtest < num_tests; ++curtest) {
+                for (size_t factor = 0; factor < sizeof(CACHE_FACTORS) / sizeof(CACHE_FACTORS[0]); ++factor, ++total) {
+                    const long double k = CACHE_FACTORS[factor];
+                    quadratic::Equation expected = {k * tests[curtest]->a, k * tests[curtest]->b, k * tests[curtest]->c, -7.25, 3.5,
+                                                    quadratic::RN_DEFAULT};
+                    quadratic::Equation given = expected;
+                    expected.num_roots = quadratic::solve_equation(&expected);
+                    given.num_roots = quadratic::cached_solve(&cache, &given);
+
+                    agreed += given.num_roots == expected.num_roots && is_same_number(given.x1, expected.x1) &&
+                              is_same_number(given.x2, expected.x2);
+                }
+            }
+        }
+
+        printf("%sCache            : %3d of %3d equations agree with solve_equation (%zu hits)\n", COLORS::T_WHITE, agreed, total,
+               cache.hits);
+        int failed = agreed != total || cache.hits == 0;
+        quadratic::free_cache(&cache);
+        return failed;
+    }
+
+    static int compare_numbers(const void *first, const void *second) {
+        long double a = *(const long double *)first, b = *(const long double *)second;
+        return (a > b) - (a < b);
+    }
+
+    static int is_same_range(const query::RootEntry *found, size_t count, const long double *sorted, size_t size, long double lo, long double hi) {
+        size_t begin = 0;
+        for (; begin < size && sorted[begin] < lo; ++begin);
+        size_t expected = 0;
+        for (; begin + expected < size && !(sorted[begin + expected] > hi); ++expected);
+
+        int same = count == expected;
+        for (size_t i = 0; same && i < count; ++i) {
+            same = is_same_number(found[i].root, sorted[begin + i]);
+        }
+        return same;
+    }
+
+    int test_query(quadratic::Equation **tests, int num_tests) {
+        ASSERTIF(tests != NULL, "nullptr in tests", 1);
+
+        // Every test is solved twice, so equal roots of different equations are in the index too.
+        size_t size = 2 * (size_t)num_tests, num_roots = 0;
+        quadratic::Equation *equations = (quadratic::Equation *)calloc(size + 1, sizeof(quadratic::Equation));
+        long double *sorted = (long double *)calloc(2 * size + 1, sizeof(long double));
+        query::RootIndex index = {};
+        if (equations == NULL || sorted == NULL) {
+            printf("Unable to alloc equations for root index\n");
+            free(equations);
+            free(sorted);
+            return 1;
+        }
+
+        for (size_t i = 0; i < size; ++i) {
+            quadratic::Equation *equation = equations + i;
+            *equation = {tests[i % (size_t)num_tests]->a, tests[i % (size_t)num_tests]->b, tests[i % (size_t)num_tests]->c, 0, 0,
+                         quadratic::RN_DEFAULT};
+            equation->num_roots = quadratic::solve_equation(equation);
+            if (equation->num_roots == quadratic::RN_ONE || equation->num_roots == quadratic::RN_TWO) {
+                sorted[num_roots++] = equation->x1;
+            }
+            if (equation->num_roots == quadratic::RN_TWO) {
+                sorted[num_roots++] = equation->x2;
+            }
+        }
+        qsort(sorted, num_roots, sizeof(long double), compare_numbers);
+
+        int agreed = 0, total = 0;
+        const size_t step = num_roots / QUERY_TESTS + 1;
+        size_t positive = 0;
+        for (; positive < num_roots && !(sorted[positive] > 0); ++positive);
+        if (query::make_index(&index, equations, size)) {
+            const query::RootEntry *found = NULL;
+            for (size_t i = 0; i <= num_roots; i += step, total += 3) {
+                long double root = (i < num_roots) ? sorted[i] : 0;
+                size_t count = query::roots_in(&index, root, root, &found);
+                agreed += is_same_range(found, count, sorted, num_roots, root, root);
+                count = query::roots_in(&index, root - 1, root + 1, &found);
+                agreed += is_same_range(found, count, sorted, num_roots, root - 1, root + 1);
+                count = query::roots_in(&index, root + 1, root - 1, &found);
+                agreed += count == 0;
+            }
+
+            for (size_t k = 0; k <= num_roots + 1; k += step, ++total) {
+                size_t count = query::top_k(&index, k, &found);
+                agreed += count == ((num_roots - positive < k) ? num_roots - positive : k) &&
+                          is_same_range(found, count, sorted + positive, count, 0, INFINITY);
+            }
+
+            for (int num_roots_class = quadratic::QE_QUAD_ERROR; num_roots_class <= quadratic::RN_INF; ++num_roots_class, ++total) {
+                const size_t *members = NULL;
+                size_t count = query::class_members(&index, num_roots_class, &members), member = 0;
+                int same = 1;
+                for (size_t i = 0; i < size; ++i) {
+                    if (equations[i].num_roots == num_roots_class) {
+                        same &= member < count && members[member++] == i;
+                    }
+                }
+                agreed += same && member == count;
+            }
+        }
+
+        printf("%sRoot index       : %3d of %3d queries agree with a scan\n", COLORS::T_WHITE, agreed, total);
+        query::free_index(&index);
+        free(equations);
+        free(sorted);
+        return agreed != total || total == 0;
+    }
+
+    static size_t write_grid(output::OutputBuffer *out, const options::Options *options) {
+        const sweep::SweepAxis *axes = options->sweep.axes;
+        size_t index = 0;
+        int previous = quadratic::QE_QUAD_ERROR - 1;
+        output::write_header(out, options->format);
+        for (size_t i = 0; i < axes[0].count; ++i) {
+            for (size_t j = 0; j < axes[1].count; ++j) {
+                for (size_t k = 0; k < axes[2].count; ++k) {
+                    quadratic::Equation equation = {axes[0].start + (long double)i * axes[0].step, axes[1].start + (long double)j * axes[1].step,
+                                                    axes[2].start + (long double)k * axes[2].step, 0, 0, quadratic::RN_DEFAULT};
+                    equation.num_roots = quadratic::solve_equation(&equation);
+                    if (!options->sweep.changes || equation.num_roots != previous) {
+                        output::write_equation(out, index + 1, &equation, options->format);
+                    }
+                    previous = equation.num_roots;
+                    index++;
+                }
+            }
+        }
+        return index;
+    }
+
+    static int is_same_file(int fd, const char *data, size_t size) {
+        char buffer[4096] = "";
+        size_t done = 0;
+        for (ssize_t bytes = 0; (bytes = pread(fd, buffer, sizeof(buffer), (off_t)done)) > 0; done += (size_t)bytes) {
+            if (done + (size_t)bytes > size || memcmp(buffer, data + done, (size_t)bytes) != 0)
+                return 0;
+        }
+        return done == size;
+    }
+
+    int test_sweep() {
+        int agreed = 0;
+        for (int test = 0; test < SWEEP_TESTS; ++test) {
+            const char *argv[sizeof(SWEEP_ARGS[0]) / sizeof(SWEEP_ARGS[0][0])] = {};
+            int argc = 0;
+            for (; SWEEP_ARGS[test][argc] != NULL; ++argc) {
+                argv[argc] = SWEEP_ARGS[test][argc];
+            }
+
+            options::Options options = {};
+            char name[] = "/tmp/quadratic_sweepXXXXXX";
+            output::OutputBuffer expected = {};
+            if (!options::parse_options(&options, &argc, argv) || !output::make_output(&expected, output::OUTPUT_MEMORY)) {
+                printf("Unable to make sweep %d\n", test);
+                continue;
+            }
+            expected.numbers = options.numbers;
+            size_t points = write_grid(&expected, &options);
+
+            int fd = mkstemp(name);
+            if (fd < 0) {
+                printf("Unable to create sweep file: %s\n", strerror(errno));
+                output::free_output(&expected);
+                continue;
+            }
+            int exit_code = sweep::run_sweep(&options, fd);
+            agreed += exit_code == 0 && points == SWEEP_POINTS[test] && sweep::sweep_size(&options.sweep) == points &&
+                      is_same_file(fd, expected.data, expected.size);
+
+            close(fd);
+            unlink(name);
+            output::free_output(&expected);
+        }
+
+        printf("%sSweep            : %3d of %3d sweeps agree with solve_equation of every point\n", COLORS::T_WHITE, agreed, SWEEP_TESTS);
+        return agreed != SWEEP_TESTS;
+    }
+
+    static void write_solved(output::OutputBuffer *out, quadratic::EquationArena *equations, output::OUTPUT_FORMAT format) {
+        quadratic::Equation **view = quadratic::arena_view(equations);
+        output::write_header(out, format);
+        for (size_t i = 0; view != NULL && i < equations->size; ++i) {
+            view[i]->num_roots = quadratic::solve_equation(view[i]);
+            output::write_equation(out, i + 1, view[i], format);
+        }
+    }
+
+    int test_shard(quadratic::Equation **tests, int num_tests) {
+        ASSERTIF(tests != NULL, "nullptr in tests", 1);
+
+        char name[] = "/tmp/quadratic_shardXXXXXX";
+        int fd = mkstemp(name);
+        FILE *input = (fd >= 0) ? fdopen(fd, "w") : NULL;
+        if (input == NULL) {
+            printf("Unable to create shard file: %s\n", strerror(errno));
+            if (fd >= 0) {
+                close(fd);
+                unlink(name);
+            }
+            return 1;
+        }
+        for (int curtest = 0; curtest < num_tests; ++curtest) {
+            fprintf(input, "%.21Lg %.21Lg %.21Lg\n", tests[curtest]->a, tests[curtest]->b, tests[curtest]->c);
+        }
+        int written = fclose(input) == 0;
+
+        // Output of the whole file is compared with merged outputs of its shards, in plain and csv formats.
+        const output::OUTPUT_FORMAT formats[] = {output::OF_PLAIN, output::OF_CSV};
+        const size_t counts = sizeof(SHARD_COUNTS) / sizeof(SHARD_COUNTS[0]);
+        int agreed = 0, total = 0;
+        for (size_t format = 0; format < sizeof(formats) / sizeof(formats[0]) && written; ++format) {
+            output::OutputBuffer expected = {};
+            quadratic::EquationArena whole = {};
+            shard::Shard single = {1, 0, 1};
+            if (!output::make_output(&expected, output::OUTPUT_MEMORY) || !quadratic::make_arena(&whole) ||
+                shard::shard_input(&whole, name, &single) != num_tests) {
+                output::free_output(&expected);
+                quadratic::free_arena(&whole);
+                break;
+            }
+            write_solved(&expected, &whole, formats[format]);
+
+            for (size_t count = 0; count < counts; ++count, ++total) {
+                shard::Shard shard = {1, 0, SHARD_COUNTS[count]};
+                FILE **files = (FILE **)calloc(shard.count, sizeof(FILE *));
+                FILE *merged = tmpfile();
+                int ready = files != NULL && merged != NULL;
+                for (; ready && shard.index < shard.count; ++shard.index) {
+                    quadratic::EquationArena equations = {};
+                    output::OutputBuffer out = {};
+                    files[shard.index] = tmpfile();
+                    ready = files[shard.index] != NULL && quadratic::make_arena(&equations) && shard::shard_input(&equations, name, &shard) >= 0 &&
+                            output::make_output(&out, fileno(files[shard.index]));
+                    if (ready) {
+                        write_solved(&out, &equations, formats[format]);
+                        ready = output::free_output(&out);
+                        rewind(files[shard.index]);
+                    }
+                    quadratic::free_arena(&equations);
+                }
+
+                size_t equations = 0;
+                agreed += ready && shard::merge_outputs(files, (int)shard.count, fileno(merged), &equations) &&
+                          equations == (size_t)num_tests && is_same_file(fileno(merged), expected.data, expected.size);
+
+                for (size_t i = 0; files != NULL && i < shard.count; ++i) {
+                    if (files[i] != NULL) {
+                        fclose(files[i]);
+                    }
+                }
+                if (merged != NULL) {
+                    fclose(merged);
+                }
+                free(files);
+            }
+
+            output::free_output(&expected);
+            quadratic::free_arena(&whole);
+        }
+        unlink(name);
+
+        printf("%sShards           : %3d of %3d merged outputs agree with the whole file\n", COLORS::T_WHITE, agreed,
+               (int)(2 * counts));
+        return agreed != (int)(2 * counts);
+    }
+
+    static int class_index(int num_roots) {
+        return (num_roots + 1 >= 0 && num_roots + 1 < BULK_CLASSES) ? num_roots + 1 : 0;
+    }
+
+    static void add_error(BulkSummary *summary, long double given, long double expected) {
+        long double error = fabsl(given - expected);
+        summary->roots++;
+        summary->sum_abs += error;
+        summary->max_abs = fmaxl(summary->max_abs, error);
+
+        if (fpclassify(expected) != FP_ZERO) {
+            long double ulps = error / (nextafterl(fabsl(expected), INFINITY) - fabsl(expected));
+            summary->ulp_roots++;
+            summary->sum_ulp += ulps;
+            summary->max_ulp = fmaxl(summary->max_ulp, ulps);
+        }
+    }
+
+    static void bulk_chunk(void *context, size_t begin, size_t end, int worker) {
+        BulkContext *bulk = (BulkContext *)context;
+        BulkSummary *summary = bulk->summaries + worker;
+
+        for (size_t curtest = begin; curtest < end; ++curtest) {
+            const quadratic::Equation *expected = bulk->tests + curtest;
+            quadratic::Equation given = *expected;
+            quadratic::solve_range_as(bulk->type, &given, 0, 1);
+
+            if (is_equal_roots(&given, expected) == 1) {
+                summary->passed++;
+            } else {
+                bulk->failed[curtest] = 1;
+            }
+
+            if (given.num_roots != expected->num_roots) {
+                summary->mismatches[class_index(expected->num_roots)][class_index(given.num_roots)]++;
+            } else if (given.num_roots == quadratic::RN_ONE) {
+                add_error(summary, given.x1, expected->x1);
+            } else if (given.num_roots == quadratic::RN_TWO) {
+                long double straight = fabsl(given.x1 - expected->x1) + fabsl(given.x2 - expected->x2);
+                long double swapped  = fabsl(given.x1 - expected->x2) + fabsl(given.x2 - expected->x1);
+                int swap = swapped < straight;
+                add_error(summary, swap ? given.x2 : given.x1, expected->x1);
+                add_error(summary, swap ? given.x1 : given.x2, expected->x2);
+            }
+        }
+    }
+
+    int test_bulk(const quadratic::EquationArena *tests, const options::Options *options) {
+        ASSERTIF(tests != NULL, "nullptr in tests", 1);
+
+        static const char *const CLASS_NAMES[BULK_CLASSES] = {"error", "default", "0", "1", "2", "inf"};
+        const size_t num_tests = tests->size;
+        struct timespec start = {}, finish = {};
+        clock_gettime(CLOCK_MONOTONIC, &start);
+
+        parallel::ThreadPool *pool = parallel::make_pool((options != NULL) ? options->threads : 0);
+        ASSERTIF(pool != NULL, "unable to start threads", 1);
+
+        const int workers = parallel::pool_size(pool);
+        BulkSummary *summaries = (BulkSummary *)calloc((size_t)workers, sizeof(BulkSummary));
+        unsigned char *failed = (unsigned char *)calloc(num_tests + 1, sizeof(unsigned char));
+        if (summaries == NULL || failed == NULL) {
+            printf("Unable to alloc memory for %zu tests\n", num_tests);
+            free(summaries);
+            free(failed);
+            parallel::free_pool(pool);
+            return 1;
+        }
+
+        BulkContext context = {tests->records, (options != NULL) ? options->type : quadratic::NT_LONG_DOUBLE, failed, summaries};
+        parallel::pool_for(pool, num_tests, BULK_CHUNK, bulk_chunk, &context);
+        parallel::free_pool(pool);
+
+        BulkSummary total = {};
+        for (int worker = 0; worker < workers; ++worker) {
+            total.passed  += summaries[worker].passed;
+            total.roots   += summaries[worker].roots;
+            total.ulp_roots += summaries[worker].ulp_roots;
+            total.sum_abs += summaries[worker].sum_abs;
+            total.sum_ulp += summaries[worker].sum_ulp;
+            total.max_abs = fmaxl(total.max_abs, summaries[worker].max_abs);
+            total.max_ulp = fmaxl(total.max_ulp, summaries[worker].max_ulp);
+            for (int i = 0; i < BULK_CLASSES; ++i) {
+                for (int j = 0; j < BULK_CLASSES; ++j) {
+                    total.mismatches[i][j] += summaries[worker].mismatches[i][j];
+                }
+            }
+        }
+        free(summaries);
+        clock_gettime(CLOCK_MONOTONIC, &finish);
+
+        fflush(stdout);
+        output::OutputBuffer out = {};
+        if (!output::make_output(&out, STDOUT_FILENO)) {
+            free(failed);
+            return 1;
+        }
+
+        for (size_t curtest = 0; curtest < num_tests; ++curtest) {
+            if (!failed[curtest])
+                continue;
+
+            const quadratic::Equation *expected = tests->records + curtest;
+            quadratic::Equation given = *expected;
+            quadratic::solve_range_as(context.type, &given, 0, 1);
+
+            output::output_printf(&out, "Test %zu WA: a = %.21Lg b = %.21Lg c = %.21Lg\n  Program answer: ", curtest + 1, expected->a, expected->b,
+                                  expected->c);
+            output::write_roots(&out, &given);
+            output::output_printf(&out, "\n  Correct answer: ");
+            output::write_roots(&out, expected);
+            output::output_write(&out, "\n", 1);
+        }
+        free(failed);
+
+        size_t failures = num_tests - total.passed;
+        output::output_printf(&out, "Tests: %zu, passed: %zu, failed: %zu, threads: %d, %.3f s\n", num_tests, total.passed, failures, workers,
+                              (double)(finish.tv_sec - start.tv_sec) + (double)(finish.tv_nsec - start.tv_nsec) / 1e9);
+        if (total.roots != 0) {
+            output::output_printf(&out, "Roots compared: %zu, absolute error: max %.6Lg mean %.6Lg\n", total.roots, total.max_abs,
+                                  total.sum_abs / (long double)total.roots);
+        }
+        if (total.ulp_roots != 0) {
+            output::output_printf(&out, "Nonzero roots compared: %zu, ULP error: max %.6Lg mean %.6Lg\n", total.ulp_roots, total.max_ulp,
+                                  total.sum_ulp / (long double)total.ulp_roots);
+        }
+        for (int i = 0; i < BULK_CLASSES; ++i) {
+            for (int j = 0; j < BULK_CLASSES; ++j) {
+                if (total.mismatches[i][j] != 0) {
+                    output::output_printf(&out, "Number of roots %s expected, %s given: %zu\n", CLASS_NAMES[i], CLASS_NAMES[j], total.mismatches[i][j]);
+                }
+            }
+        }
+
+        output::free_output(&out);
+        return failures != 0;
+    }
+
+    static int is_equal_polynomial(const quadratic::Polynomial *given, const quadratic::Polynomial *expected) {
+        if (given->num_roots != expected->num_roots)
+            return 0;
+
+        for (int i = 0; i < given->num_roots; ++i) {
+            if (!(fabsl(given->roots[i] - expected->roots[i]) <= POLY_TOLERANCE * (1 + fabsl(expected->roots[i]))))
+                return 0;
+        }
+        return 1;
+    }
+
+    int test_polynomials(const quadratic::PolynomialArray *tests) {
+        ASSERTIF(tests != NULL, "nullptr in tests", 1);
+
+        quadratic::PolynomialArray given = {};
+        for (size_t curtest = 0; curtest < tests->size; ++curtest) {
+            quadratic::Polynomial polynomial = tests->records[curtest];
+            polynomial.num_roots = 0;
+            if (quadratic::polynomial_push(&given, &polynomial) == NULL) {
+                printf("Unable to alloc polynomials\n");
+                quadratic::free_polynomials(&given);
+                return 1;
+            }
+        }
+        quadratic::solve_polynomials(given.records, given.size);
+
+        printf("%s%sTesting polynomials...\n", COLORS::T_WHITE, COLORS::T_ARTICLE);
+        printf("\n%sNumber of tests: %3zu", COLORS::T_WHITE, tests->size);
+
+        int failed = 0, agreed = 0;
+        for (size_t curtest = 0; curtest < tests->size; ++curtest) {
+            const quadratic::Polynomial *expected = tests->records + curtest, *result = given.records + curtest;
+            printf("%s\nTest %3zu...", COLORS::T_WHITE, curtest + 1);
+
+            if (is_equal_polynomial(result, expected)) {
+                printf("%s%sOK!%s", COLORS::T_RED, COLORS::T_ARTICLE, COLORS::T_WHITE);
+            } else {
+                printf("%s%sWA!%s\n" "  %sPolynomial of degree %d:", COLORS::T_RED, COLORS::T_ARTICLE, COLORS::T_WHITE, COLORS::T_RED,
+                       expected->degree);
+                for (int i = 0; i <= expected->degree; ++i) {
+                    printf(" %+.8Lg", expected->coefficients[i]);
+                }
+                printf("%s\n  \033[37;41mProgram answer: \033[30;46m", COLORS::T_WHITE);
+                quadratic::print_polynomial(result);
+                printf("\033[34;47m\n  \033[37;41mCorrect answer: \033[30;46m");
+                quadratic::print_polynomial(expected);
+                printf("\033[34;47m");
+                failed++;
+            }
+
+            quadratic::Polynomial single = *expected;
+            single.num_roots = 0;
+            quadratic::solve_polynomial(&single);
+            agreed += is_equal_polynomial(&single, result);
+        }
+
+        printf("\n%sBlocks of polynomials: %3d of %3zu agree with solve_polynomial\n", COLORS::T_WHITE, agreed, tests->size);
+        quadratic::free_polynomials(&given);
+        return failed + (agreed != (int)tests->size);
+    }
 }
@@ -2,6 +2,7 @@
 #define TEST_DEF
 
 #include "quadratic.h"
+#include "polynomial.h"
 
 /**
  * @brief   This namespace includes helpful objects for testing solver of quadratic equations.
@@ -17,6 +18,163 @@ namespace unit_tests {
      * @return 0 If no errors happend and non-zero number otherwise
      */
     int test_quadratic(quadratic::Equation **equation, int num_tests);
+
+    /**
+     * @brief   This function tests the solver of quadratic equations on tests stored in arena.
+     * @details Same as test_quadratic with Equation **, but doesn't free tests: arena's owner frees them.
+     * @param [in] *tests - Arena with tests
+     * @return 0 If no errors happend and non-zero number otherwise
+     */
+    int test_quadratic(quadratic::EquationArena *tests);
+
+    /**
+     * @brief   This function tests kernels of solve_batch against solve_equation.
+     * @details Solves coefficients of tests by every kernel supported by CPU and compares numbers of roots and roots with solve_equation's ones.
+     * Prints number of agreed equations for each kernel. Doesn't free tests.
+     * @param [in] **tests    - Array of tests
+     * @param [in] num_tests  - Number of tests
+     * @return 0 If all kernels agree and non-zero number otherwise
+     */
+    int test_batch(quadratic::Equation **tests, int num_tests);
+
+    /**
+     * @brief   This function tests solve_equation<T> of every type against solve_equation.
+     * @details Solves tests in float, double and __float128 (look precision.h) and compares numbers of roots and roots with long double ones.
+     * Prints number of agreed equations for each type. Float uses relative tolerance, so it may disagree near zero. Doesn't free tests.
+     * @param [in] **tests    - Array of tests
+     * @param [in] num_tests  - Number of tests
+     * @return 0 If all types agree and non-zero number otherwise
+     */
+    int test_types(quadratic::Equation **tests, int num_tests);
+
+    /**
+     * @brief   This function tests the C ABI of libquadratic.h against solve_equation.
+     * @details Solves tests by qe_solve_columns and by qe_solve_records in an array of qe_equation and prints number of agreed equations
+     * for each of them. Doesn't free tests.
+     * @param [in] **tests    - Array of tests
+     * @param [in] num_tests  - Number of tests
+     * @return 0 If both functions agree and non-zero number otherwise
+     */
+    int test_capi(quadratic::Equation **tests, int num_tests);
+
+    /**
+     * @brief   This function tests accuracy of roots of NT_ADAPTIVE (look adaptive.h) against solve_equation.
+     * @details Every test is copied ADAPTIVE_COPIES times with coefficients which are not exact in double, copies are solved by
+     * solve_adaptive. Numbers of roots must be the same as solve_equation's ones, roots must differ from its roots by no more than
+     * ADAPTIVE_ROOT_TOLERANCE of the largest root modulus, which is tighter than accuracy of double. Prints number of agreed equations.
+     * Doesn't free tests.
+     * @param [in] **tests    - Array of tests
+     * @param [in] num_tests  - Number of tests
+     * @return 0 If all equations agree and non-zero number otherwise
+     */
+    int test_adaptive(quadratic::Equation **tests, int num_tests);
+
+    /**
+     * @brief   This function tests format_number against printf.
+     * @details Coefficients and roots of tests and their neighbours (nextafterl) are written in every format of numbers and compared with
+     * "%+-10.5Lg", "%+-10.PLg" with P of shortest_precision and "%+-10La". Prints number of agreed numbers. Doesn't free tests.
+     * @param [in] **tests    - Array of tests
+     * @param [in] num_tests  - Number of tests
+     * @return 0 If all numbers agree and non-zero number otherwise
+     */
+    int test_format(quadratic::Equation **tests, int num_tests);
+
+    /**
+     * @brief   This function tests reading of gzip-compressed files (look compressed.h).
+     * @details Coefficients of tests are written to a temporary gzip file, read back through open_input and parser::parse_fd and
+     * compared with tests; then the file is cut in half and close_input must report it. Prints both results. Doesn't free tests.
+     * @param [in] **tests    - Array of tests
+     * @param [in] num_tests  - Number of tests
+     * @return 0 If all equations agree and truncation is detected and non-zero number otherwise
+     */
+    int test_compressed(quadratic::Equation **tests, int num_tests);
+
+    /**
+     * @brief   This function tests the fast parser of parser.h against scanf.
+     * @details parse_number must read the same number and stop at the same character as sscanf "%Lf" on tricky strings and on numbers of
+     * tests and their neighbours written in several formats. Then tests are written with mixed spaces and read by parse_text and by
+     * fscanf (scan_stream), equations must be the same. Prints both results. Doesn't free tests.
+     * @param [in] **tests    - Array of tests
+     * @param [in] num_tests  - Number of tests
+     * @return 0 If all numbers and equations agree and non-zero number otherwise
+     */
+    int test_parser(quadratic::Equation **tests, int num_tests);
+
+    /**
+     * @brief   This function tests cached_solve of cache.h against solve_equation.
+     * @details Coefficients of tests are multiplied by exact factors of both signs and every copy is solved twice through a small cache,
+     * so results come both from solve_equation and from entries of other copies. Numbers of roots and roots must be the same as
+     * solve_equation's ones bit by bit, roots which solve_equation doesn't write must stay unchanged. Prints number of agreed equations
+     * and hits. Doesn't free tests.
+     * @param [in] **tests    - Array of tests
+     * @param [in] num_tests  - Number of tests
+     * @return 0 If all equations agree and cache was hit and non-zero number otherwise
+     */
+    int test_cache(quadratic::Equation **tests, int num_tests);
+
+    /**
+     * @brief   This function tests the root index of query.h against a scan of all equations.
+     * @details Tests are solved twice into one array, then roots_in for every root and around it, top_k for every k and class_members
+     * for every class must give the same roots and equations as a scan of the array. Prints number of agreed queries. Doesn't free
+     * tests.
+     * @param [in] **tests    - Array of tests
+     * @param [in] num_tests  - Number of tests
+     * @return 0 If all queries agree and non-zero number otherwise
+     */
+    int test_query(quadratic::Equation **tests, int num_tests);
+
+    /**
+     * @brief   This function tests the sweep mode of sweep.h.
+     * @details Sweeps are parsed from arguments by parse_options and written by run_sweep to a temporary file, which must be the same
+     * bytes as points of the grid made one by one, solved by solve_equation and written by write_equation. One sweep writes every point
+     * in csv, the other one only changes of class over more than SWEEP_BLOCK points, so blocks are joined too. Prints number of agreed
+     * sweeps.
+     * @return 0 If all sweeps agree and non-zero number otherwise
+     */
+    int test_sweep();
+
+    /**
+     * @brief   This function tests the shard mode of shard.h and merge_outputs of build/merge.
+     * @details Coefficients of tests are written to a temporary file, one equation in a line. The file is split into 1, 2, 3, 7 and 64
+     * shards, equations of every shard are read by shard_input, solved and written numbered from 1, then merge_outputs joins
+     * outputs of shards. Merged output must be the same bytes as output of the whole file, in plain and csv formats. Prints number of
+     * agreed outputs. Doesn't free tests.
+     * @param [in] **tests    - Array of tests
+     * @param [in] num_tests  - Number of tests
+     * @return 0 If all merged outputs agree and non-zero number otherwise
+     */
+    int test_shard(quadratic::Equation **tests, int num_tests);
+
+    /**
+     * @brief   This function runs self-tests of the program (--self-test).
+     * @details Runs test_batch, test_types, test_adaptive, test_capi, test_format, test_compressed, test_parser, test_cache, test_query,
+     * test_sweep and test_shard, each of them prints its result. Doesn't free tests.
+     * @param [in] *tests - Arena with tests
+     * @return 0 If all checks passed and number of failed checks otherwise
+     */
+    int self_test(quadratic::EquationArena *tests);
+
+    /**
+     * @brief   This function runs a large number of tests on all threads and prints only failures and a summary (--bulk-tests).
+     * @details Tests are solved by a thread pool of options->threads threads (all hardware threads if it is 0) in options->type, verdicts
+     * are the same as test_quadratic's. After that failed tests are printed in order through OutputBuffer, then the summary: numbers of
+     * passed and failed tests, maximal and mean absolute and ULP error of roots when numbers of roots are equal, and numbers of mismatches
+     * of number of roots by class. Doesn't free tests.
+     * @param [in] *tests   - Arena with tests
+     * @param [in] *options - Options of the program (may be NULL)
+     * @return 0 If all tests passed and non-zero number otherwise
+     */
+    int test_bulk(const quadratic::EquationArena *tests, const options::Options *options);
+
+    /**
+     * @brief   This function tests the solver of polynomials (--poly with -t files).
+     * @details Tests are degree, coefficients, number of roots and roots (look polynomial_stream_input). Solves them by solve_polynomials
+     * and prints verdict for each test like test_quadratic: roots must be equal up to 1e-6 of their modulus plus 1. Then checks that
+     * solve_polynomial gives the same results one by one. Doesn't free tests.
+     * @param [in] *tests - Array of tests
+     * @return 0 If all tests passed and non-zero number otherwise
+     */
+    int test_polynomials(const quadratic::PolynomialArray *tests);
 }
 
 #endif